@@ -3,9 +3,7 @@ import FWCore.ParameterSet.Config as cms
 myana = cms.EDAnalyzer('BasicRecoDistrib',
         pileup       = cms.uint32(200),
         electrons    = cms.InputTag("ecalDrivenGsfElectrons"),
-        beamspot     = cms.InputTag("offlineBeamSpot"),
-        conversions  = cms.InputTag("particleFlowEGamma"),
-        trackIsoValueMap = cms.InputTag("electronTrackIsolationLcone"),
+        electronID   = cms.InputTag("recoElectronID"),
         muons        = cms.InputTag("muons"),
         puppiNoLepIsolationChargedHadrons = cms.InputTag("muonIsolationPUPPINoLep","h+-DR040-ThresholdVeto000-ConeVeto000"),
         puppiNoLepIsolationNeutralHadrons = cms.InputTag("muonIsolationPUPPINoLep","h0-DR040-ThresholdVeto000-ConeVeto001"),
@@ -14,19 +12,9 @@ myana = cms.EDAnalyzer('BasicRecoDistrib',
         pfCandsNoLep = cms.InputTag("particleFlow"),
         jets         = cms.InputTag("ak4PFJetsCHS"),
         met          = cms.InputTag("pfMet"),
-        genParts     = cms.InputTag("genParticles"),
         genJets      = cms.InputTag("ak4GenJets"),
         vertices     = cms.InputTag("offlinePrimaryVertices"),
-        HGCalIDToolConfig = cms.PSet(
-            HGCBHInput = cms.InputTag("HGCalRecHit","HGCHEBRecHits"),
-            HGCEEInput = cms.InputTag("HGCalRecHit","HGCEERecHits"),
-            HGCFHInput = cms.InputTag("HGCalRecHit","HGCHEFRecHits"),
-            HGCPFRecHits = cms.InputTag("particleFlowRecHitHGC::MyAna"),
-            withPileup = cms.bool(True),
-            debug = cms.bool(False),
-        ),
-        
-
+        timing       = cms.untracked.bool(False),
 )
 
 IsoConeDefinitions = cms.VPSet(
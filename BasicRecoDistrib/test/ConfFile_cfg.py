@@ -11,6 +11,7 @@ process.GlobalTag = GlobalTag(process.GlobalTag, '91X_upgrade2023_realistic_v3',
 process.load("FWCore.MessageService.MessageLogger_cfi")
 process.MessageLogger.cerr.threshold = 'INFO'
 process.MessageLogger.categories.append('MyAna')
+process.MessageLogger.categories.append('ElectronIDPipeline')
 process.MessageLogger.cerr.INFO = cms.untracked.PSet(
         limit = cms.untracked.int32(-1)
 )
@@ -58,10 +59,13 @@ process.load("RecoParticleFlow.PFClusterProducer.particleFlowRecHitHGC_cff")
 
 # jurassic track isolation
 # https://indico.cern.ch/event/27568/contributions/1618615/attachments/499629/690192/080421.Isolation.Update.RecHits.pdf
-process.load("RecoEgamma.EgammaIsolationAlgos.electronTrackIsolationLcone_cfi")
-process.electronTrackIsolationLcone.electronProducer = cms.InputTag("ecalDrivenGsfElectrons")
-process.electronTrackIsolationLcone.intRadiusBarrel = 0.04
-process.electronTrackIsolationLcone.intRadiusEndcap = 0.04
+# (Lcone: electronTrackIsolationLcone with the inner radius 0.04, in one pass over the tracks)
+process.load("PhaseTwoAnalysis.Electrons.electronTrackIsolationCones_cfi")
+
+# primary vertex, electron ID and isolation
+process.load("PhaseTwoAnalysis.Common.PrimaryVertexSelector_cfi")
+process.load("PhaseTwoAnalysis.Electrons.RecoElectronIDProducer_cfi")
+process.recoElectronID.pfCandsNoLep = "puppiNoLep"
 
 #run MyAna
 process.myana = cms.EDAnalyzer('BasicRecoDistrib'
@@ -78,6 +82,6 @@ process.TFileService = cms.Service("TFileService",
 
 process.puSequence = cms.Sequence(process.primaryVertexAssociation * process.pfNoLepPUPPI * process.puppi * process.particleFlowNoLep * process.puppiNoLep * process.offlineSlimmedPrimaryVertices * process.packedPFCandidates * process.muonIsolationPUPPI * process.muonIsolationPUPPINoLep * process.ak4PUPPIJets * process.puppiMet)
 
-process.p = cms.Path(process.electronTrackIsolationLcone * process.particleFlowRecHitHGCSeq * process.puSequence * process.myana) 
+process.p = cms.Path(process.electronTrackIsolationCones * process.particleFlowRecHitHGCSeq * process.puSequence * process.primaryVertexSelector * process.recoElectronID * process.myana) 
 
 
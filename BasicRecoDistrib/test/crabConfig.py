@@ -8,7 +8,6 @@ config.General.workArea = 'crab_tasks/'
 config.section_("JobType")
 config.JobType.pluginName = 'Analysis'
 config.JobType.psetName = 'ConfFile_cfg.py'
-config.JobType.inputFiles = ['TMVAClassification_BDT.weights.xml']
 config.JobType.outputFiles = ['histos.root']
 
 config.section_("Data")
@@ -0,0 +1,424 @@
+// -*- C++ -*-
+//
+// Package:    PhaseTwoAnalysis/Common
+// Program:    benchmarkPhaseTwoKernels
+//
+// Replays the inputs recorded by KernelSnapshotRecorder through the
+// selection and isolation kernels of the package, with the cuts of the
+// ntuplers, and reports for each kernel the time per object and the event
+// rate. All snapshots are loaded in memory before timing, every kernel is
+// run once untimed and then over all the events for each repetition; the
+// best repetition is reported together with the median one. The electron
+// ID and ME0 matching kernels evaluate the working points on the inputs
+// computed at recording, which need the full objects and the geometry; they
+// process no objects on snapshots recorded without them.
+//
+// Each kernel also prints a checksum of its results, so that a change of
+// behaviour shows up next to a change of speed. A run can be saved with -o
+// and a later run compared to it with -c (the exit code is 2 if a checksum
+// differs).
+//
+//   benchmarkPhaseTwoKernels [-n maxEvents] [-r repetitions] [-k kernel]
+//                            [-o results.txt] [-c reference.txt] snapshots.root [...]
+
+#include "PhaseTwoAnalysis/Common/interface/KernelSnapshot.h"
+#include "PhaseTwoAnalysis/Common/interface/DeltaRKernels.h"
+#include "PhaseTwoAnalysis/Common/interface/ElectronIDEvaluator.h"
+#include "PhaseTwoAnalysis/Common/interface/EtaPhiGrid.h"
+#include "PhaseTwoAnalysis/Common/interface/JetConstituentSoA.h"
+#include "PhaseTwoAnalysis/Common/interface/ME0MatchSummary.h"
+#include "PhaseTwoAnalysis/Common/interface/OverlapRemover.h"
+
+#include "FWCore/Utilities/interface/Exception.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using kernelsnapshot::Event;
+
+namespace {
+
+  // prepare() sets up what the kernel needs from the event and is not
+  // timed; run() is timed and returns a checksum of the results, adding the
+  // number of processed objects to nObjects
+  struct Kernel
+  {
+    std::string name, objects;
+    std::function<void(const Event &)> prepare;
+    std::function<double(const Event &, size_t & nObjects)> run;
+  };
+
+  struct Result
+  {
+    double bestNs = 0., medianNs = 0.;
+    size_t nObjects = 0;
+    double checksum = 0.;
+  };
+
+  bool passKinematics(const drkernels::Candidates & cands, size_t i, float ptMin, float etaMax)
+  {
+    return cands.pt[i] >= ptMin && std::abs(cands.eta[i]) <= etaMax;
+  }
+
+  // the gen-level objects of the ntuplers: gen jets with pt > 25 and
+  // |eta| < 5 not overlapping with a gen lepton, and their constituents
+  struct GenJets
+  {
+    OverlapRemover overlapLeptons;
+    JetConstituentSoA constituents;
+    drkernels::Candidates selected;
+
+    size_t fill(const Event & event)
+    {
+      overlapLeptons.clear();
+      for (size_t i = 0; i < event.genLeptons.size(); i++)
+        overlapLeptons.add(event.genLeptons.eta[i], event.genLeptons.phi[i], event.genLeptons.pt[i]);
+      overlapLeptons.build();
+      constituents.clear();
+      selected.clear();
+      size_t begin = 0;
+      for (size_t j = 0; j < event.genJets.size(); j++) {
+        const size_t n = event.genJetNConstituents[j];
+        const float eta = event.genJets.eta[j], phi = event.genJets.phi[j], pt = event.genJets.pt[j];
+        begin += n;
+        if (!passKinematics(event.genJets, j, 25., 5.)) continue;
+        if (overlapLeptons.overlaps(eta, phi, pt)) continue;
+        const size_t b = begin - n;
+        constituents.addJet(eta, phi, event.genJetConstituents.eta.data() + b, event.genJetConstituents.phi.data() + b,
+                            event.genJetConstituents.pt.data() + b, n);
+        selected.eta.push_back(eta);
+        selected.phi.push_back(phi);
+        selected.pt.push_back(pt);
+      }
+      return event.genJets.size();
+    }
+  };
+
+  // the gen leptons stored by the ntuplers: pt > 20 and |eta| < 3
+  struct GenLeptons
+  {
+    drkernels::Candidates selected;
+    std::vector<int> pdgId;
+
+    void fill(const Event & event)
+    {
+      selected.clear();
+      pdgId.clear();
+      for (size_t i = 0; i < event.genLeptons.size(); i++) {
+        if (!passKinematics(event.genLeptons, i, 20., 3.)) continue;
+        selected.eta.push_back(event.genLeptons.eta[i]);
+        selected.phi.push_back(event.genLeptons.phi[i]);
+        selected.pt.push_back(event.genLeptons.pt[i]);
+        pdgId.push_back(event.genLeptonPdgId[i]);
+      }
+    }
+  };
+
+  std::vector<Kernel> makeKernels()
+  {
+    static EtaPhiGrid pfGrid;
+    static GenJets genJets;
+    static GenLeptons genLeptons;
+    static OverlapRemover jetOverlapLeptons;
+    static std::vector<ElectronIDEvaluator::Variables> electronIDVariables;
+    static std::vector<double> electronMVAs;
+    static std::vector<ME0MatchSummary> me0Matches;
+
+    auto fillGrid = [](const Event & event) {
+      pfGrid.clear();
+      for (size_t i = 0; i < event.pfCands.size(); i++) pfGrid.add(event.pfCands.eta[i], event.pfCands.phi[i], event.pfCands.pt[i], i);
+      pfGrid.build();
+    };
+
+    std::vector<Kernel> kernels;
+
+    kernels.push_back({"pfGrid.fill", "PF candidate",
+        [](const Event &) {},
+        [fillGrid](const Event & event, size_t & nObjects) {
+          fillGrid(event);
+          nObjects += event.pfCands.size();
+          return double(pfGrid.size());
+        }});
+
+    kernels.push_back({"electron.pfIso", "electron",
+        fillGrid,
+        [](const Event & event, size_t & nObjects) {
+          double sum = 0.;
+          for (size_t i = 0; i < event.electrons.size(); i++) {
+            if (!passKinematics(event.electrons, i, 10., 3.)) continue;
+            sum += pfGrid.coneSum(event.electrons.eta[i], event.electrons.phi[i], 0.4) / event.electrons.pt[i];
+            nObjects++;
+          }
+          return sum;
+        }});
+
+    kernels.push_back({"electron.id", "electron",
+        [](const Event & event) {
+          electronIDVariables.clear();
+          electronMVAs.clear();
+          for (size_t i = 0; i < event.elMVA.size(); i++) {
+            if (!passKinematics(event.electrons, i, 10., 3.)) continue;
+            electronIDVariables.push_back({event.elScEta[i], event.elSigmaIetaIeta[i], event.elDEtaIn[i], event.elDPhiIn[i],
+                                           event.elHOverE[i], event.elOoEmooP[i], event.elChargedIsoRel[i],
+                                           event.elMatchedConversion[i] != 0});
+            electronMVAs.push_back(event.elMVA[i]);
+          }
+        },
+        [](const Event &, size_t & nObjects) {
+          double sum = 0.;
+          for (size_t i = 0; i < electronIDVariables.size(); i++)
+            sum += ElectronIDEvaluator::evaluate(electronIDVariables[i], electronMVAs[i]);
+          nObjects += electronIDVariables.size();
+          return sum;
+        }});
+
+    kernels.push_back({"muon.me0Match", "ME0 muon",
+        [](const Event & event) {
+          me0Matches.clear();
+          size_t begin = 0;
+          for (size_t m = 0; m < event.me0NMatches.size(); m++) {
+            const size_t n = event.me0NMatches[m];
+            begin += n;
+            if (n == 0) continue;
+            std::vector<ME0MatchSummary::Match> matches;
+            for (size_t k = begin - n; k < begin; k++)
+              matches.push_back({event.me0DEta[k], event.me0DPhi[k], event.me0DPhiBend[k]});
+            me0Matches.emplace_back(event.me0P[m], matches);
+          }
+        },
+        [](const Event &, size_t & nObjects) {
+          double passed = 0.;
+          for (const auto & me0Match : me0Matches)
+            passed += me0Match.passes(ME0MatchSummary::kLoose) + 2*me0Match.passes(ME0MatchSummary::kTight);
+          nObjects += me0Matches.size();
+          return passed;
+        }});
+
+    kernels.push_back({"genJet.cleanAndFill", "gen jet",
+        [](const Event &) {},
+        [](const Event & event, size_t & nObjects) {
+          nObjects += genJets.fill(event);
+          return double(genJets.constituents.size());
+        }});
+
+    kernels.push_back({"genLepton.iso", "gen lepton",
+        [](const Event & event) { genJets.fill(event); genLeptons.fill(event); },
+        [](const Event & event, size_t & nObjects) {
+          double sum = 0.;
+          for (size_t i = 0; i < genLeptons.selected.size(); i++) {
+            double iso = genJets.constituents.coneSum(genLeptons.selected.eta[i], genLeptons.selected.phi[i], 0.7, 0.01,
+                                                      std::abs(genLeptons.pdgId[i]) == 13 ? 0.4 : 0.3);
+            sum += iso / genLeptons.selected.pt[i];
+          }
+          nObjects += genLeptons.selected.size();
+          return sum;
+        }});
+
+    kernels.push_back({"jet.cleaning", "jet",
+        [](const Event &) {},
+        [](const Event & event, size_t & nObjects) {
+          jetOverlapLeptons.clear();
+          for (size_t j = 0; j < event.electrons.size(); j++)
+            jetOverlapLeptons.add(event.electrons.eta[j], event.electrons.phi[j], event.electrons.pt[j]);
+          for (size_t j = 0; j < event.muons.size(); j++)
+            jetOverlapLeptons.add(event.muons.eta[j], event.muons.phi[j], event.muons.pt[j]);
+          jetOverlapLeptons.build();
+          double kept = 0.;
+          for (size_t i = 0; i < event.jets.size(); i++) {
+            if (!passKinematics(event.jets, i, 20., 5.)) continue;
+            nObjects++;
+            if (!jetOverlapLeptons.overlaps(event.jets.eta[i], event.jets.phi[i], event.jets.pt[i])) kept++;
+          }
+          return kept;
+        }});
+
+    kernels.push_back({"electron.genMatch", "electron",
+        [](const Event & event) { genLeptons.fill(event); },
+        [](const Event & event, size_t & nObjects) {
+          double sum = 0.;
+          for (size_t i = 0; i < event.electrons.size(); i++) {
+            if (!passKinematics(event.electrons, i, 10., 3.)) continue;
+            sum += 1 + drkernels::lastWithin(event.electrons.eta[i], event.electrons.phi[i], genLeptons.selected.eta.data(),
+                                             genLeptons.selected.phi.data(), genLeptons.selected.size(), 0.4,
+                                             genLeptons.pdgId.data(), 11);
+            nObjects++;
+          }
+          return sum;
+        }});
+
+    kernels.push_back({"jet.genMatch", "jet",
+        [](const Event & event) { genJets.fill(event); },
+        [](const Event & event, size_t & nObjects) {
+          double sum = 0.;
+          for (size_t i = 0; i < event.jets.size(); i++) {
+            if (!passKinematics(event.jets, i, 20., 5.)) continue;
+            sum += 1 + genJets.selected.firstWithin(event.jets.eta[i], event.jets.phi[i], 0.4);
+            nObjects++;
+          }
+          return sum;
+        }});
+
+    return kernels;
+  }
+
+  Result benchmark(const Kernel & kernel, const std::vector<Event> & events, int repetitions)
+  {
+    Result result;
+    std::vector<double> times;
+    for (int rep = -1; rep < repetitions; rep++) {
+      double ns = 0., checksum = 0.;
+      size_t nObjects = 0;
+      for (const auto & event : events) {
+        kernel.prepare(event);
+        auto start = std::chrono::steady_clock::now();
+        checksum += kernel.run(event, nObjects);
+        ns += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+      }
+      // the first pass warms up the caches and the allocations
+      if (rep < 0) continue;
+      times.push_back(ns);
+      result.nObjects = nObjects;
+      result.checksum = checksum;
+    }
+    std::sort(times.begin(), times.end());
+    result.bestNs = times.front();
+    result.medianNs = times[times.size()/2];
+    return result;
+  }
+
+  // name -> (ns/object, checksum) of a previous run
+  std::map<std::string, std::pair<double, double>> readReference(const std::string & fileName)
+  {
+    std::map<std::string, std::pair<double, double>> reference;
+    std::ifstream in(fileName);
+    if (!in) throw cms::Exception("benchmarkPhaseTwoKernels") << "cannot read " << fileName;
+    std::string line;
+    while (std::getline(in, line)) {
+      if (line.empty() || line[0] == '#') continue;
+      std::istringstream fields(line);
+      std::string name;
+      double nsPerObject, eventsPerSecond, checksum;
+      if (fields >> name >> nsPerObject >> eventsPerSecond >> checksum) reference[name] = std::make_pair(nsPerObject, checksum);
+    }
+    return reference;
+  }
+
+  bool sameChecksum(double a, double b)
+  {
+    return std::abs(a - b) <= 1e-9 * std::max(1., std::max(std::abs(a), std::abs(b)));
+  }
+
+  void usage(const char * program)
+  {
+    std::cerr << "Usage: " << program << " [-n maxEvents] [-r repetitions] [-k kernel] [-o results.txt] [-c reference.txt] snapshots.root [...]\n"
+              << "  -n  number of events to load (default: all)\n"
+              << "  -r  number of timed repetitions (default: 5)\n"
+              << "  -k  only run the kernels whose name contains this string\n"
+              << "  -o  save the results, to be compared to with -c\n"
+              << "  -c  compare with the results of a previous run\n";
+  }
+
+}
+
+int main(int argc, char * argv[])
+{
+  long maxEvents = -1;
+  int repetitions = 5;
+  std::string selection, outName, refName;
+  std::vector<std::string> inputs;
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    if ((arg == "-n" || arg == "-r" || arg == "-k" || arg == "-o" || arg == "-c") && i+1 < argc) {
+      std::string value = argv[++i];
+      if (arg == "-n") maxEvents = std::atol(value.c_str());
+      else if (arg == "-r") repetitions = std::max(1, std::atoi(value.c_str()));
+      else if (arg == "-k") selection = value;
+      else if (arg == "-o") outName = value;
+      else refName = value;
+    } else if (!arg.empty() && arg[0] == '-') {
+      usage(argv[0]);
+      return 1;
+    } else {
+      inputs.push_back(arg);
+    }
+  }
+  if (inputs.empty()) {
+    usage(argv[0]);
+    return 1;
+  }
+
+  std::vector<Event> events;
+  std::map<std::string, std::pair<double, double>> reference;
+  try {
+    for (const auto & input : inputs) {
+      long left = (maxEvents >= 0 ? maxEvents - (long)events.size() : -1);
+      if (left == 0) break;
+      std::vector<Event> fileEvents = kernelsnapshot::readAll(input, left);
+      events.insert(events.end(), fileEvents.begin(), fileEvents.end());
+    }
+    if (!refName.empty()) reference = readReference(refName);
+  } catch (cms::Exception & e) {
+    std::cerr << e.what() << std::endl;
+    return 1;
+  }
+  if (events.empty()) {
+    std::cerr << "no events in the snapshots" << std::endl;
+    return 1;
+  }
+  std::cout << events.size() << " events, " << repetitions << " repetitions" << std::endl;
+
+  std::ofstream out;
+  if (!outName.empty()) {
+    out.open(outName);
+    out << "# kernel ns/object events/s checksum\n" << std::fixed;
+  }
+
+  int status = 0;
+  double totalNs = 0.;
+  std::cout << std::setw(22) << std::left << "kernel" << std::right
+            << std::setw(12) << "objects/evt" << std::setw(12) << "ns/object" << std::setw(12) << "(median)"
+            << std::setw(12) << "events/s" << std::setw(18) << "checksum"
+            << (reference.empty() ? "" : "   vs reference") << std::endl;
+  for (const auto & kernel : makeKernels()) {
+    if (!selection.empty() && kernel.name.find(selection) == std::string::npos) continue;
+    Result result = benchmark(kernel, events, repetitions);
+    totalNs += result.bestNs;
+    const double nObjects = std::max<size_t>(result.nObjects, 1);
+    const double nsPerObject = result.bestNs / nObjects;
+    const double eventsPerSecond = events.size() / (result.bestNs * 1e-9);
+
+    std::cout << std::setw(22) << std::left << kernel.name << std::right << std::fixed
+              << std::setw(12) << std::setprecision(1) << double(result.nObjects) / events.size()
+              << std::setw(12) << std::setprecision(2) << nsPerObject
+              << std::setw(12) << result.medianNs / nObjects
+              << std::setw(12) << std::setprecision(0) << eventsPerSecond
+              << std::setw(18) << std::setprecision(6) << std::scientific << result.checksum << std::fixed;
+    auto ref = reference.find(kernel.name);
+    if (ref != reference.end()) {
+      std::cout << std::setw(9) << std::setprecision(1) << std::showpos << 100. * (nsPerObject / ref->second.first - 1.) << "%" << std::noshowpos;
+      if (!sameChecksum(result.checksum, ref->second.second)) {
+        std::cout << "  CHECKSUM CHANGED";
+        status = 2;
+      }
+    }
+    std::cout << "  (per " << kernel.objects << ")" << std::endl;
+
+    if (out) out << kernel.name << " " << std::setprecision(4) << nsPerObject << " " << eventsPerSecond << " "
+                 << std::scientific << std::setprecision(12) << result.checksum << std::fixed << "\n";
+  }
+  if (totalNs > 0.)
+    std::cout << std::setw(22) << std::left << "all" << std::right << std::setw(48) << std::setprecision(0)
+              << events.size() / (totalNs * 1e-9) << std::endl;
+
+  return status;
+}
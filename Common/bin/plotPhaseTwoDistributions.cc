@@ -0,0 +1,468 @@
+// -*- C++ -*-
+//
+// Package:    PhaseTwoAnalysis/Common
+// Program:    plotPhaseTwoDistributions
+//
+// Batch version of the plotIt.C macros of BasicRecoDistrib and
+// BasicPatDistrib: every TH1D of the directory of the input files is drawn
+// with the same style and saved as .C and .pdf.
+//
+// The keys of each file are scanned and the histograms read once, in memory,
+// before any drawing. The plots are then shared between -j worker processes
+// forked from the reader, each with its own canvas and pads (ROOT graphics is
+// not thread safe), which leaves the input files alone. A plot is only drawn
+// again if the content hash of its histogram (binning, contents, errors,
+// titles and style) differs from the one of the last run in the output
+// directory, or if one of its outputs is missing; -F draws them all.
+//
+//   plotPhaseTwoDistributions [-d myana] [-o Plots/] [-j workers] [-s reco|pat]
+//                             [-p pileup] [-F] histos.root [...]
+//
+// With several input files, the plots of each file go to a subdirectory of
+// the output directory named after the file.
+
+#include "TCanvas.h"
+#include "TClass.h"
+#include "TDirectory.h"
+#include "TError.h"
+#include "TFile.h"
+#include "TGaxis.h"
+#include "TH1.h"
+#include "TKey.h"
+#include "TPaveText.h"
+#include "TROOT.h"
+#include "TString.h"
+#include "TStyle.h"
+#include "TSystem.h"
+
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <set>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+  const double kTopMargin = 0.05, kBottomMargin = 0.13, kLeftMargin = 0.17, kRightMargin = 0.03;
+  const int kTitleFontSize = 26, kLabelFontSize = 18;
+  // to be increased with any change of the drawing, to redraw every plot
+  const int kStyleVersion = 1;
+  const char * kCacheName = ".plotcache";
+  const char * kExtensions[] = {".C", ".pdf"};
+
+  struct Plot
+  {
+    std::unique_ptr<TH1D> histo;
+    std::string outdir;
+    uint64_t hash;
+  };
+
+  // the style of plotIt.C
+  TStyle * createMyStyle()
+  {
+    TStyle *myStyle = new TStyle("myStyle", "myStyle");
+
+    TGaxis::SetExponentOffset(-0.07, -0.01, "y");
+
+    myStyle->SetCanvasBorderMode(0);
+    myStyle->SetCanvasColor(kWhite);
+    myStyle->SetCanvasDefH(800);
+    myStyle->SetCanvasDefW(800);
+    myStyle->SetCanvasDefX(0);
+    myStyle->SetCanvasDefY(0);
+
+    myStyle->SetPadBorderMode(0);
+    myStyle->SetPadColor(kWhite);
+    myStyle->SetPadGridX(false);
+    myStyle->SetPadGridY(false);
+    myStyle->SetGridColor(0);
+    myStyle->SetGridStyle(3);
+    myStyle->SetGridWidth(1);
+
+    myStyle->SetFrameBorderMode(0);
+    myStyle->SetFrameBorderSize(1);
+    myStyle->SetFrameFillColor(0);
+    myStyle->SetFrameFillStyle(0);
+    myStyle->SetFrameLineColor(1);
+    myStyle->SetFrameLineStyle(1);
+    myStyle->SetFrameLineWidth(1);
+
+    myStyle->SetHistLineStyle(1);
+    myStyle->SetHistLineWidth(2);
+    myStyle->SetEndErrorSize(2);
+
+    myStyle->SetFitFormat("5.4g");
+    myStyle->SetFuncColor(2);
+    myStyle->SetFuncStyle(1);
+    myStyle->SetFuncWidth(1);
+
+    myStyle->SetOptFile(0);
+    myStyle->SetStatColor(kWhite);
+    myStyle->SetStatTextColor(1);
+    myStyle->SetStatFormat("6.4g");
+    myStyle->SetStatBorderSize(1);
+    myStyle->SetStatH(0.12);
+    myStyle->SetStatW(0.3);
+    myStyle->SetStatY(0.92);
+    myStyle->SetStatX(0.94);
+
+    myStyle->SetOptDate(0);
+
+    myStyle->SetPadTopMargin(kTopMargin);
+    myStyle->SetPadBottomMargin(kBottomMargin);
+    myStyle->SetPadLeftMargin(kLeftMargin);
+    myStyle->SetPadRightMargin(kRightMargin);
+
+    myStyle->SetOptTitle(0);
+    myStyle->SetTitleFont(63);
+    myStyle->SetTitleColor(1);
+    myStyle->SetTitleTextColor(1);
+    myStyle->SetTitleFillColor(10);
+    myStyle->SetTitleBorderSize(0);
+    myStyle->SetTitleAlign(33);
+    myStyle->SetTitleX(1);
+    myStyle->SetTitleFontSize(kTitleFontSize);
+
+    myStyle->SetTitleColor(1, "XYZ");
+    myStyle->SetTitleFont(43, "XYZ");
+    myStyle->SetTitleSize(kTitleFontSize, "XYZ");
+    myStyle->SetTitleYOffset(1.75);
+    myStyle->SetTitleXOffset(1.5);
+
+    myStyle->SetLabelColor(1, "XYZ");
+    myStyle->SetLabelFont(43, "XYZ");
+    myStyle->SetLabelOffset(0.01, "YZ");
+    myStyle->SetLabelOffset(0.015, "X");
+    myStyle->SetLabelSize(kLabelFontSize, "XYZ");
+
+    myStyle->SetAxisColor(1, "XYZ");
+    myStyle->SetStripDecimals(kTRUE);
+    myStyle->SetTickLength(0.03, "XYZ");
+    myStyle->SetNdivisions(510, "XYZ");
+    myStyle->SetPadTickX(1);
+    myStyle->SetPadTickY(1);
+
+    myStyle->SetOptLogx(0);
+    myStyle->SetOptLogy(0);
+    myStyle->SetOptLogz(0);
+
+    myStyle->SetHatchesSpacing(1.3);
+    myStyle->SetHatchesLineWidth(1);
+
+    myStyle->cd();
+
+    return myStyle;
+  }
+
+  void h_myStyle(TH1 *h, int color)
+  {
+    h->SetLineWidth(3);
+    h->SetLineColor(color);
+    h->SetLineStyle(1);
+    h->SetFillColor(color);
+    h->SetFillStyle(2);
+    h->SetMaximum(-1111.);
+    h->SetMinimum(-1111.);
+    h->GetXaxis()->SetNdivisions(510);
+    h->GetYaxis()->SetNdivisions(510);
+    h->GetYaxis()->SetTitleOffset(2.);
+
+    h->SetMarkerStyle(22);
+    h->SetMarkerColor(color);
+    h->SetMarkerSize(1.2);
+    h->SetStats(0);
+  }
+
+  void cms_myStyle(const TString & pileup)
+  {
+    TPaveText* pt_exp = new TPaveText(kLeftMargin, 1 - 0.5 * kTopMargin, 1 - kRightMargin, 1, "brNDC");
+    pt_exp->SetFillStyle(0);
+    pt_exp->SetBorderSize(0);
+    pt_exp->SetMargin(0);
+    pt_exp->SetTextFont(62);
+    pt_exp->SetTextSize(0.75 * kTopMargin);
+    pt_exp->SetTextAlign(13);
+    pt_exp->AddText("CMS #font[52]{#scale[0.76]{Phase-2 Simulation Preliminary}}");
+    pt_exp->Draw();
+
+    TString lumi_s = "3 ab^{-1} (14 TeV";
+    if (pileup.Length() > 0) lumi_s = lumi_s + TString::Format(", %s PU)", pileup.Data());
+    else lumi_s = lumi_s + ")";
+    TPaveText* pt_lumi = new TPaveText(kLeftMargin, 1 - 0.5 * kTopMargin, 1 - kRightMargin, 1, "brNDC");
+    pt_lumi->SetFillStyle(0);
+    pt_lumi->SetBorderSize(0);
+    pt_lumi->SetMargin(0);
+    pt_lumi->SetTextFont(42);
+    pt_lumi->SetTextSize(0.6 * kTopMargin);
+    pt_lumi->SetTextAlign(33);
+    pt_lumi->AddText(lumi_s);
+    pt_lumi->Draw();
+  }
+
+  // the highlighted histograms of the two macros: the PF ones of
+  // BasicRecoDistrib, the gen ones of BasicPatDistrib
+  int colorOf(const TString & name, const std::string & style)
+  {
+    if (style == "reco") return name.Contains("PF") ? 30 : 38;
+    return name.BeginsWith("Gen") ? 46 : 38;
+  }
+
+  // FNV-1a
+  class Hash
+  {
+   public:
+    void add(const void *data, size_t size)
+    {
+      const unsigned char *bytes = static_cast<const unsigned char *>(data);
+      for (size_t i = 0; i < size; i++) {
+        value_ ^= bytes[i];
+        value_ *= 1099511628211ULL;
+      }
+    }
+    template <class T> void add(const T & value) { add(&value, sizeof(value)); }
+    void add(const std::string & value) { add(value.size()); add(value.data(), value.size()); }
+    uint64_t value() const { return value_; }
+
+   private:
+    uint64_t value_ = 14695981039346656037ULL;
+  };
+
+  void addAxis(Hash & hash, const TAxis & axis)
+  {
+    hash.add(std::string(axis.GetTitle()));
+    hash.add(axis.GetNbins());
+    hash.add(axis.GetXmin());
+    hash.add(axis.GetXmax());
+    const TArrayD & edges = *axis.GetXbins();
+    if (edges.GetSize() > 0) hash.add(edges.GetArray(), edges.GetSize()*sizeof(Double_t));
+    if (axis.GetLabels())
+      for (int b = 1; b <= axis.GetNbins(); b++) hash.add(std::string(axis.GetBinLabel(b)));
+  }
+
+  uint64_t contentHash(const TH1D & histo, const std::string & style, const std::string & pileup)
+  {
+    Hash hash;
+    hash.add(kStyleVersion);
+    hash.add(style);
+    hash.add(pileup);
+    hash.add(std::string(histo.GetName()));
+    hash.add(std::string(histo.GetTitle()));
+    addAxis(hash, *histo.GetXaxis());
+    hash.add(std::string(histo.GetYaxis()->GetTitle()));
+    hash.add(histo.GetArray(), histo.GetNcells()*sizeof(Double_t));
+    const TArrayD & sumw2 = *histo.GetSumw2();
+    if (sumw2.GetSize() > 0) hash.add(sumw2.GetArray(), sumw2.GetSize()*sizeof(Double_t));
+    hash.add(histo.GetEntries());
+    return hash.value();
+  }
+
+  std::map<std::string, uint64_t> readCache(const std::string & outdir)
+  {
+    std::map<std::string, uint64_t> cache;
+    std::ifstream in((outdir + kCacheName).c_str());
+    std::string name;
+    uint64_t hash;
+    while (in >> std::hex >> hash >> name) cache[name] = hash;
+    return cache;
+  }
+
+  void writeCache(const std::string & outdir, const std::map<std::string, uint64_t> & cache)
+  {
+    std::ofstream out((outdir + kCacheName).c_str());
+    for (const auto & entry : cache) out << std::hex << entry.second << " " << entry.first << "\n";
+  }
+
+  bool exists(const std::string & name)
+  {
+    struct stat buffer;
+    return stat(name.c_str(), &buffer) == 0;
+  }
+
+  bool plotted(const std::string & outdir, const std::string & name)
+  {
+    for (const char *extension : kExtensions)
+      if (!exists(outdir + name + extension)) return false;
+    return true;
+  }
+
+  void plot1D(const Plot & plot, const std::string & style, const TString & pileup)
+  {
+    TH1D *histo = plot.histo.get();
+    const std::string name = histo->GetName();
+    h_myStyle(histo, colorOf(name, style));
+
+    TCanvas cn("cn", "canvas");
+    cn.cd();
+    histo->DrawCopy("hist");
+    cms_myStyle(pileup);
+    for (const char *extension : kExtensions) cn.SaveAs((plot.outdir + name + extension).c_str());
+  }
+
+  // reads every TH1D of the directory, keeping the highest cycle of each key
+  bool readHistograms(const std::string & fileName, const std::string & directory, const std::string & outdir,
+                      std::vector<Plot> & plots)
+  {
+    std::unique_ptr<TFile> file(TFile::Open(fileName.c_str()));
+    if (!file || file->IsZombie()) {
+      std::cerr << "cannot open " << fileName << std::endl;
+      return false;
+    }
+    TDirectory *dir = file->GetDirectory(directory.c_str());
+    if (!dir) {
+      std::cerr << "no directory " << directory << " in " << fileName << std::endl;
+      return false;
+    }
+    std::set<std::string> seen;
+    TIter nextkey(dir->GetListOfKeys());
+    while (TKey *key = (TKey*)nextkey()) {
+      if (!seen.insert(key->GetName()).second) continue;
+      TClass *type = TClass::GetClass(key->GetClassName());
+      if (!type || !type->InheritsFrom(TH1D::Class())) continue;
+      TH1D *histo = static_cast<TH1D *>(key->ReadObj());
+      histo->SetDirectory(0);
+      plots.push_back(Plot{std::unique_ptr<TH1D>(histo), outdir, 0});
+    }
+    return true;
+  }
+
+  void usage(const char * program)
+  {
+    std::cerr << "Usage: " << program << " [-d myana] [-o Plots/] [-j workers] [-s reco|pat] [-p pileup] [-F] histos.root [...]\n"
+              << "  -d  directory of the histograms in the input files (default: myana)\n"
+              << "  -o  output directory (default: Plots/), one subdirectory per file with several files\n"
+              << "  -j  number of worker processes (default: number of cores)\n"
+              << "  -s  highlighted histograms: PF ones (reco, default) or gen ones (pat)\n"
+              << "  -p  pileup of the label (default: 200, empty for none)\n"
+              << "  -F  draw every plot, even if its histogram did not change\n";
+  }
+
+}
+
+int main(int argc, char * argv[])
+{
+  std::string directory = "myana", outdir = "Plots/", style = "reco", pileup = "200";
+  int nWorkers = std::max(1u, std::thread::hardware_concurrency());
+  bool force = false;
+  std::vector<std::string> inputs;
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    if ((arg == "-d" || arg == "-o" || arg == "-j" || arg == "-s" || arg == "-p") && i+1 < argc) {
+      std::string value = argv[++i];
+      if (arg == "-d") directory = value;
+      else if (arg == "-o") outdir = value;
+      else if (arg == "-j") nWorkers = std::max(1, std::atoi(value.c_str()));
+      else if (arg == "-s") style = value;
+      else pileup = value;
+    } else if (arg == "-F") {
+      force = true;
+    } else if (!arg.empty() && arg[0] == '-') {
+      usage(argv[0]);
+      return 1;
+    } else {
+      inputs.push_back(arg);
+    }
+  }
+  if (inputs.empty() || (style != "reco" && style != "pat")) {
+    usage(argv[0]);
+    return 1;
+  }
+  if (outdir.back() != '/') outdir += "/";
+
+  gROOT->SetBatch(true);
+  gErrorIgnoreLevel = kWarning;
+  TH1::AddDirectory(false);
+  createMyStyle();
+
+  // read everything once, and keep only the plots to be drawn
+  std::vector<Plot> plots;
+  for (const auto & input : inputs) {
+    std::string fileOutdir = outdir;
+    if (inputs.size() > 1) {
+      std::string base = input.substr(input.find_last_of('/') + 1);
+      if (base.size() > 5 && base.compare(base.size() - 5, 5, ".root") == 0) base.resize(base.size() - 5);
+      fileOutdir += base + "/";
+    }
+    if (!readHistograms(input, directory, fileOutdir, plots)) return 1;
+    gSystem->mkdir(fileOutdir.c_str(), true);
+  }
+
+  std::map<std::string, std::map<std::string, uint64_t>> caches;
+  std::vector<const Plot *> todo;
+  size_t nUnchanged = 0;
+  for (auto & plot : plots) {
+    plot.hash = contentHash(*plot.histo, style, pileup);
+    if (!caches.count(plot.outdir)) caches[plot.outdir] = readCache(plot.outdir);
+    const std::string name = plot.histo->GetName();
+    const auto & cache = caches[plot.outdir];
+    auto cached = cache.find(name);
+    if (!force && cached != cache.end() && cached->second == plot.hash && plotted(plot.outdir, name)) {
+      nUnchanged++;
+      continue;
+    }
+    todo.push_back(&plot);
+  }
+  nWorkers = std::min<int>(nWorkers, std::max<size_t>(todo.size(), 1));
+  std::cout << plots.size() << " histograms, " << nUnchanged << " unchanged, drawing " << todo.size()
+            << " with " << nWorkers << " worker" << (nWorkers > 1 ? "s" : "") << std::endl;
+
+  // worker w draws the plots w, w + nWorkers, ...; the cache entries of the
+  // plots of a failed worker are dropped, so that they are drawn next time
+  std::vector<bool> done(todo.size(), false);
+  if (nWorkers == 1) {
+    for (size_t i = 0; i < todo.size(); i++) {
+      plot1D(*todo[i], style, pileup);
+      done[i] = true;
+    }
+  } else {
+    std::cout.flush();
+    std::vector<pid_t> workers;
+    for (int w = 0; w < nWorkers; w++) {
+      pid_t pid = fork();
+      if (pid < 0) {
+        std::cerr << "cannot fork: " << std::strerror(errno) << std::endl;
+        break;
+      }
+      if (pid == 0) {
+        for (size_t i = w; i < todo.size(); i += nWorkers) plot1D(*todo[i], style, pileup);
+        std::cout.flush();
+        _exit(0);
+      }
+      workers.push_back(pid);
+    }
+    for (size_t w = 0; w < workers.size(); w++) {
+      int status = 0;
+      waitpid(workers[w], &status, 0);
+      const bool ok = WIFEXITED(status) && WEXITSTATUS(status) == 0;
+      if (!ok) std::cerr << "worker " << w << " failed" << std::endl;
+      for (size_t i = w; i < todo.size(); i += nWorkers) done[i] = ok;
+    }
+  }
+
+  int status = 0;
+  for (size_t i = 0; i < todo.size(); i++) {
+    auto & cache = caches[todo[i]->outdir];
+    const std::string name = todo[i]->histo->GetName();
+    if (done[i]) cache[name] = todo[i]->hash;
+    else {
+      cache.erase(name);
+      status = 1;
+    }
+  }
+  for (const auto & cache : caches) writeCache(cache.first, cache.second);
+
+  return status;
+}
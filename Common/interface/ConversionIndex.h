@@ -0,0 +1,40 @@
+#ifndef _conversionindex_h_
+#define _conversionindex_h_
+// -*- C++ -*-
+//
+// Package:     PhaseTwoAnalysis/Common
+// Class:       ConversionIndex
+// Description: per-event lookup of the electrons matched to a conversion
+//
+// fill() keeps the tracks of the conversions passing
+// ConversionTools::isGoodConversion, sorted by (product id, key), and
+// hasMatchedConversion() looks the GSF and closest CTF tracks of an electron
+// up by binary search. The result is the one of
+// ConversionTools::hasMatchedConversion(ele, conversions, beamspot) with its
+// default cuts, without a scan of the conversion collection per electron.
+
+#include "DataFormats/EgammaCandidates/interface/Conversion.h"
+#include "DataFormats/EgammaCandidates/interface/GsfElectron.h"
+#include "DataFormats/Math/interface/Point3D.h"
+#include "DataFormats/Provenance/interface/ProductID.h"
+
+#include <utility>
+#include <vector>
+
+class ConversionIndex
+{
+ public:
+  void fill(const reco::ConversionCollection & conversions, const math::XYZPoint & beamspot);
+
+  bool hasMatchedConversion(const reco::GsfElectron & ele) const;
+
+  // number of tracks of good conversions
+  size_t size() const { return tracks_.size(); }
+
+ private:
+  bool contains(const edm::ProductID & id, size_t key) const;
+
+  std::vector<std::pair<edm::ProductID, size_t>> tracks_;
+};
+
+#endif
@@ -0,0 +1,92 @@
+#ifndef _cutflow_h_
+#define _cutflow_h_
+// -*- C++ -*-
+//
+// Package:     PhaseTwoAnalysis/Common
+// Class:       CutFlow
+// Description: per-cut object counters and cost attribution of a selection
+//
+// A selection declares its cuts once, in the order they are applied, and
+// wraps each object in a CutFlow::Object; every cut goes through it.
+//
+//   CutFlow::Object cuts(muonFlow_);
+//   if (!cuts(kPt, muon.pt() >= 2.)) continue;
+//   if (!cuts(kEta, std::abs(muon.eta()) <= 2.8)) continue;
+//   ...
+//
+// The flow counts the objects reaching each cut and failing it; an object
+// leaves the flow at its first failed cut, so working points that are not
+// nested in the selection itself are counted as the nested sequence. An
+// object still in the flow when it goes out of scope is counted as passed:
+// every way of dropping it, e.g. a full output buffer, must be a cut. For
+// one object in "cutFlowSampling" (16 by default) the time from the start
+// of the object to each cut is also recorded: the mean cumulative time at a
+// cut is the cost of the selection up to and including that cut, and the
+// difference to the previous cut the cost of the cut itself. Enabled with
+// the untracked "cutFlow" parameter of the module, the flow otherwise only
+// returns the decisions.
+//
+// Like StageTimer, every stream (or module) instance has its own counters,
+// merged by finish() at endStream/endJob into a process-wide summary per
+// module label and selection (LabelSummaryRegistry). The last instance
+// prints the summary and, if the TFileService is available, stores in a
+// "cutflow" directory the number of objects reaching each cut (the last bin
+// counts the objects passing all of them) and the mean cumulative time per
+// object at each cut.
+
+#include "FWCore/ParameterSet/interface/ParameterSet.h"
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class CutFlow
+{
+ public:
+  CutFlow(const edm::ParameterSet & iConfig, const std::string & selection, const std::vector<std::string> & cuts);
+
+  bool enabled() const { return enabled_; }
+  // to be called from endStream/endJob, while the TFileService is still open
+  void finish();
+
+  class Object
+  {
+   public:
+    explicit Object(CutFlow & flow) : flow_(flow), alive_(flow.enabled()), timed_(alive_ && flow.sample())
+    {
+      if (timed_) start_ = std::chrono::steady_clock::now();
+    }
+    ~Object() { if (alive_) flow_.passed_++; }
+
+    // returns passed; the first failed cut ends the object
+    bool operator()(unsigned int cut, bool passed)
+    {
+      if (!alive_) return passed;
+      flow_.reached_[cut]++;
+      if (timed_) {
+        flow_.timed_[cut]++;
+        flow_.cumulativeNs_[cut] += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start_).count();
+      }
+      if (!passed) alive_ = false;
+      return passed;
+    }
+
+   private:
+    CutFlow & flow_;
+    bool alive_, timed_;
+    std::chrono::steady_clock::time_point start_;
+  };
+
+ private:
+  bool sample() { return ++objects_ % sampling_ == 0; }
+
+  bool enabled_, finished_;
+  std::string label_, selection_;
+  std::vector<std::string> cuts_;
+  unsigned int sampling_;
+  uint64_t objects_, passed_;
+  std::vector<uint64_t> reached_, timed_, cumulativeNs_;
+};
+
+#endif
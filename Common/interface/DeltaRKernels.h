@@ -0,0 +1,152 @@
+#ifndef _deltarkernels_h_
+#define _deltarkernels_h_
+// -*- C++ -*-
+//
+// Package:     PhaseTwoAnalysis/Common
+// Namespace:   drkernels
+// Description: one-to-many deltaR matching and cone sums over float arrays
+//
+// The kernels compare one direction (eta0, phi0) with n candidates stored as
+// separate eta[], phi[] (and pt[]) arrays, e.g. the MiniEvent_t columns or a
+// drkernels::Candidates filled once per event. They work on deltaR^2 and are
+// written without early exits or data-dependent branches so that the
+// compiler can vectorize them; match index semantics are those of the
+// historical loops ("first"/"last" candidate within the cone, in array order).
+//
+// Cone boundaries follow the usual "skip if deltaR > dR" convention: a
+// candidate at exactly dR is inside. Phi values are expected in [-pi, pi].
+//
+// Define DELTARKERNELS_SCALAR to get plain loops without vectorization hints.
+
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+#ifdef DELTARKERNELS_SCALAR
+#define DELTARKERNELS_VECTOR_LOOP
+#else
+#define DELTARKERNELS_VECTOR_LOOP _Pragma("GCC ivdep")
+#endif
+
+namespace drkernels {
+
+  inline float deltaPhi(float phi1, float phi2)
+  {
+    float dPhi = std::abs(phi1 - phi2);
+    return (dPhi > (float)M_PI) ? 2.f*(float)M_PI - dPhi : dPhi;
+  }
+
+  inline float deltaR2(float eta1, float phi1, float eta2, float phi2)
+  {
+    float dEta = eta1 - eta2;
+    float dPhi = deltaPhi(phi1, phi2);
+    return dEta*dEta + dPhi*dPhi;
+  }
+
+  // out[i] = deltaR^2 between (eta0, phi0) and candidate i
+  inline void deltaR2(float eta0, float phi0, const float *eta, const float *phi, size_t n, float *out)
+  {
+    DELTARKERNELS_VECTOR_LOOP
+    for (size_t i = 0; i < n; i++) out[i] = deltaR2(eta0, phi0, eta[i], phi[i]);
+  }
+
+  // index of the first candidate within dR, -1 if none;
+  // pdgId (optional) restricts the candidates to |pdgId[i]| == absPdgId
+  inline int firstWithin(float eta0, float phi0, const float *eta, const float *phi, size_t n, float dR,
+                         const int *pdgId = nullptr, int absPdgId = 0)
+  {
+    const float dR2 = dR*dR;
+    int index = -1;
+    DELTARKERNELS_VECTOR_LOOP
+    for (int i = (int)n - 1; i >= 0; i--) {
+      bool match = deltaR2(eta0, phi0, eta[i], phi[i]) <= dR2 && (!pdgId || std::abs(pdgId[i]) == absPdgId);
+      index = match ? i : index;
+    }
+    return index;
+  }
+
+  // index of the last candidate within dR, -1 if none
+  inline int lastWithin(float eta0, float phi0, const float *eta, const float *phi, size_t n, float dR,
+                        const int *pdgId = nullptr, int absPdgId = 0)
+  {
+    const float dR2 = dR*dR;
+    int index = -1;
+    DELTARKERNELS_VECTOR_LOOP
+    for (int i = 0; i < (int)n; i++) {
+      bool match = deltaR2(eta0, phi0, eta[i], phi[i]) <= dR2 && (!pdgId || std::abs(pdgId[i]) == absPdgId);
+      index = match ? i : index;
+    }
+    return index;
+  }
+
+  // index of the closest candidate within dR, -1 if none
+  inline int bestMatch(float eta0, float phi0, const float *eta, const float *phi, size_t n, float dR)
+  {
+    float best = dR*dR;
+    int index = -1;
+    DELTARKERNELS_VECTOR_LOOP
+    for (int i = 0; i < (int)n; i++) {
+      float d = deltaR2(eta0, phi0, eta[i], phi[i]);
+      bool match = (index < 0) ? d <= best : d < best;
+      best = match ? d : best;
+      index = match ? i : index;
+    }
+    return index;
+  }
+
+  // scalar pt sum of the candidates with dRMin <= deltaR <= dRMax
+  inline float coneSum(float eta0, float phi0, const float *eta, const float *phi, const float *pt, size_t n,
+                       float dRMin, float dRMax)
+  {
+    const float dR2Min = dRMin*dRMin, dR2Max = dRMax*dRMax;
+    float sum = 0.f;
+    DELTARKERNELS_VECTOR_LOOP
+    for (size_t i = 0; i < n; i++) {
+      float d = deltaR2(eta0, phi0, eta[i], phi[i]);
+      sum += (d >= dR2Min && d <= dR2Max) ? pt[i] : 0.f;
+    }
+    return sum;
+  }
+
+  // true if a candidate is closer than dR (strictly) and has
+  // |pt0 - pt[i]| < relPt*pt[i], i.e. is the same physics object
+  inline bool anyOverlap(float eta0, float phi0, float pt0, const float *eta, const float *phi, const float *pt, size_t n,
+                         float dR, float relPt)
+  {
+    const float dR2 = dR*dR;
+    bool overlaps = false;
+    DELTARKERNELS_VECTOR_LOOP
+    for (size_t i = 0; i < n; i++)
+      overlaps |= (std::abs(pt0 - pt[i]) < relPt*pt[i]) & (deltaR2(eta0, phi0, eta[i], phi[i]) < dR2);
+    return overlaps;
+  }
+
+  // per-event eta/phi/pt arrays of a set of candidates
+  struct Candidates
+  {
+    std::vector<float> eta, phi, pt;
+
+    void clear() { eta.clear(); phi.clear(); pt.clear(); }
+    size_t size() const { return pt.size(); }
+    template <class T> void push_back(const T & cand)
+    {
+      eta.push_back(cand.eta());
+      phi.push_back(cand.phi());
+      pt.push_back(cand.pt());
+    }
+
+    int firstWithin(float eta0, float phi0, float dR) const
+    { return drkernels::firstWithin(eta0, phi0, eta.data(), phi.data(), size(), dR); }
+    int lastWithin(float eta0, float phi0, float dR) const
+    { return drkernels::lastWithin(eta0, phi0, eta.data(), phi.data(), size(), dR); }
+    int bestMatch(float eta0, float phi0, float dR) const
+    { return drkernels::bestMatch(eta0, phi0, eta.data(), phi.data(), size(), dR); }
+    float coneSum(float eta0, float phi0, float dRMin, float dRMax) const
+    { return drkernels::coneSum(eta0, phi0, eta.data(), phi.data(), pt.data(), size(), dRMin, dRMax); }
+    bool anyOverlap(float eta0, float phi0, float pt0, float dR, float relPt) const
+    { return drkernels::anyOverlap(eta0, phi0, pt0, eta.data(), phi.data(), pt.data(), size(), dR, relPt); }
+  };
+
+}
+
+#endif
@@ -0,0 +1,57 @@
+#ifndef _electronidevaluator_h_
+#define _electronidevaluator_h_
+// -*- C++ -*-
+//
+// Package:     PhaseTwoAnalysis/Common
+// Class:       ElectronIDEvaluator
+// Description: loose/medium/tight ID of the RECO electrons in one pass
+//
+// Barrel electrons (|eta_SC| < 1.479) are identified with cuts on the shower
+// shape, track-cluster matching, H/E, |1/E - 1/p|, charged isolation and
+// conversion veto; endcap electrons (|eta_SC| >= 1.556) with the output of the
+// endcap BDT; electrons in the transition region fail. The electron
+// quantities are computed once for all the working points, and the
+// conversion match, the most expensive of them, only for the barrel
+// electrons that pass the other cuts of a working point.
+//
+// evaluate() returns the bitmask of the requested working points that are
+// passed. The working points are tried in the order loose, medium, tight
+// and, with cascade = true, the evaluation stops at the first requested one
+// that fails: a bit is then only set if all the requested looser working
+// points are passed too, which is how the selections use them.
+
+#include "PhaseTwoAnalysis/Common/interface/ConversionIndex.h"
+
+#include "DataFormats/EgammaCandidates/interface/GsfElectron.h"
+
+class ElectronIDEvaluator
+{
+ public:
+  enum WorkingPoint { kLoose = 1 << 0, kMedium = 1 << 1, kTight = 1 << 2, kAll = kLoose | kMedium | kTight };
+
+  // the inputs of the cut-based ID
+  struct Variables
+  {
+    double scEta;
+    double sigmaIetaIeta, dEtaIn, dPhiIn, hOverE, ooEmooP, chargedIsoRel;
+    bool matchedConversion;
+  };
+
+  // without the conversion match, left false
+  static Variables variables(const reco::GsfElectron & ele);
+  static Variables variables(const reco::GsfElectron & ele, const ConversionIndex & conversions);
+
+  static unsigned int evaluate(const Variables & vars, double mva, unsigned int wps = kAll, bool cascade = true);
+  static unsigned int evaluate(const reco::GsfElectron & ele, const ConversionIndex & conversions, double mva,
+                               unsigned int wps = kAll, bool cascade = true);
+
+ private:
+  struct Cuts
+  {
+    double sigmaIetaIeta, dEtaIn, dPhiIn, hOverE, ooEmooP, chargedIsoRel;
+    double mva;
+  };
+  static const Cuts kCuts[3];
+};
+
+#endif
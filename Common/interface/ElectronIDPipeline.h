@@ -0,0 +1,88 @@
+#ifndef _electronidpipeline_h_
+#define _electronidpipeline_h_
+// -*- C++ -*-
+//
+// Package:     PhaseTwoAnalysis/Common
+// Class:       ElectronIDPipeline
+// Description: cost-ordered ElectronIDEvaluator selection of the RECO electrons
+//
+// The electrons of an event go through the stages of the selection from the
+// cheapest to the most expensive one, and leave it at the first stage where
+// they fail all the requested working points:
+//   pt               pT > 10 GeV
+//   eta              |eta| < 3
+//   acceptance       not in the barrel-endcap transition region
+//   barrel cuts      cut-based ID without the conversion veto
+//   conversion veto  barrel electrons matched to a conversion
+//   HGCal shower     endcap electrons without BDT inputs (HGCal cluster,
+//                    primary vertex)
+//   endcap BDT       endcap electrons below the BDT cuts
+// so that the HGCal shower shapes and the BDT are only computed for the
+// endcap candidates, and the module can compute its other expensive
+// quantities (e.g. the PF isolation) for the electrons passing a working
+// point only. The result is the one of ElectronIDEvaluator::evaluate(). The
+// number of candidates rejected at each stage, and of the accepted ones
+// passing each working point, is summed over the streams and printed at the
+// end of the job (ElectronIDPipeline category): this is the cut flow of the
+// RECO electrons up to the ID, the filters only count the working points.
+//
+//   electronID_.beginEvent(elecs->size());
+//   for (i) if (electronID_.preselect(i, elecs->at(i), conversionIndex_))
+//     ...                                  // BDT inputs of the endcap electrons
+//   ...                                    // BDT
+//   for (i) if (electronID_.needsMVA(i)) electronID_.setMVA(i, mva, hasInputs);
+//   for (i) if (electronID_.passed(i) & ElectronIDEvaluator::kLoose) ...
+
+#include "PhaseTwoAnalysis/Common/interface/ElectronIDEvaluator.h"
+
+#include "FWCore/ParameterSet/interface/ParameterSet.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class ElectronIDPipeline
+{
+ public:
+  enum Stage { kPt = 0, kEta, kAcceptance, kBarrelCuts, kConversionVeto, kShowerShape, kMVA, nStages };
+
+  ElectronIDPipeline(const edm::ParameterSet & iConfig, unsigned int wps = ElectronIDEvaluator::kAll, bool cascade = true);
+
+  void beginEvent(size_t nElectrons);
+
+  // runs the stages before the BDT, returns true if the endcap BDT is needed
+  bool preselect(size_t i, const reco::GsfElectron & ele, const ConversionIndex & conversions);
+  bool needsMVA(size_t i) const { return status_[i].needsMVA; }
+  // hasInputs = false if the BDT inputs could not be computed
+  void setMVA(size_t i, double mva, bool hasInputs);
+
+  // the electron passes the kinematic preselection
+  bool preselected(size_t i) const { return status_[i].preselected; }
+  // bitmask of the working points passed
+  unsigned int passed(size_t i) const { return status_[i].passed; }
+
+  // to be called from endStream/endJob
+  void finish();
+
+ private:
+  struct Status
+  {
+    bool preselected, needsMVA;
+    double scEta;
+    unsigned int passed;
+  };
+
+  unsigned int reject(Stage stage) { rejected_[stage]++; return 0; }
+  void accept(unsigned int passed);
+
+  unsigned int wps_;
+  bool cascade_, finished_;
+  std::string label_;
+  std::vector<Status> status_;
+  uint64_t candidates_, accepted_;
+  std::vector<uint64_t> rejected_;
+  // loose, medium, tight
+  std::vector<uint64_t> passedWPs_;
+};
+
+#endif
@@ -0,0 +1,98 @@
+#ifndef _etaphigrid_h_
+#define _etaphigrid_h_
+// -*- C++ -*-
+//
+// Package:     PhaseTwoAnalysis/Common
+// Class:       EtaPhiGrid
+// Description: eta-phi binned index over a candidate collection, meant to be
+//              built once per event and shared by all cone-sum computations
+//
+// Candidates are sorted by cell (counting sort) into flat eta/phi/pt arrays.
+// A cone query only visits the cells overlapping the cone's bounding box,
+// with phi wrapping around at +-pi; |eta| beyond etaMax goes to the edge rows.
+// A candidate is inside the cone when deltaR <= coneSize, as in the
+// historical "DeltaR(...) > coneSize continue" loops.
+
+#include <cmath>
+#include <vector>
+
+class EtaPhiGrid
+{
+ public:
+  explicit EtaPhiGrid(double cellSize = 0.2, double etaMax = 5.0);
+
+  // fill from any collection of objects providing eta(), phi() and pt()
+  template <class Collection> void fill(const Collection & cands);
+
+  // incremental filling: clear(), add() every candidate, then build()
+  void clear();
+  void add(float eta, float phi, float pt, unsigned int index);
+  void build();
+
+  // scalar pt sum of the candidates with deltaR <= coneSize
+  double coneSum(double eta, double phi, double coneSize) const;
+
+  // call f(index, pt, deltaR2) for every candidate with deltaR <= coneSize
+  template <class F> void forEachInCone(double eta, double phi, double coneSize, F f) const;
+
+  size_t size() const { return pt_.size(); }
+
+ private:
+  int etaBin(double eta) const;
+  int phiBin(double phi) const;
+  void cellRange(double eta, double phi, double coneSize, int & eta0, int & eta1, int & phi0, int & nPhiCells) const;
+
+  double etaMax_;
+  double etaCell_, phiCell_;
+  int nEta_, nPhi_;
+
+  // per-candidate input, in insertion order
+  std::vector<float> inEta_, inPhi_, inPt_;
+  std::vector<unsigned int> inIndex_;
+  std::vector<int> inCell_;
+
+  // cell-sorted storage, cellStart_[c] .. cellStart_[c+1] belong to cell c
+  std::vector<unsigned int> cellStart_;
+  std::vector<float> eta_, phi_, pt_;
+  std::vector<unsigned int> index_;
+};
+
+template <class Collection>
+void
+EtaPhiGrid::fill(const Collection & cands)
+{
+  clear();
+  unsigned int i = 0;
+  for (const auto & cand : cands) {
+    add(cand.eta(), cand.phi(), cand.pt(), i);
+    i++;
+  }
+  build();
+}
+
+template <class F>
+void
+EtaPhiGrid::forEachInCone(double eta, double phi, double coneSize, F f) const
+{
+  if (pt_.empty()) return;
+  int eta0, eta1, phi0, nPhiCells;
+  cellRange(eta, phi, coneSize, eta0, eta1, phi0, nPhiCells);
+  const float dR2Max = coneSize*coneSize;
+  for (int ie = eta0; ie <= eta1; ie++) {
+    for (int k = 0; k < nPhiCells; k++) {
+      int ip = (phi0 + k) % nPhi_;
+      if (ip < 0) ip += nPhi_;
+      const int cell = ie*nPhi_ + ip;
+      for (unsigned int j = cellStart_[cell]; j < cellStart_[cell+1]; j++) {
+        float dEta = eta_[j] - (float)eta;
+        float dPhi = std::abs(phi_[j] - (float)phi);
+        if (dPhi > (float)M_PI) dPhi = 2.f*(float)M_PI - dPhi;
+        float dR2 = dEta*dEta + dPhi*dPhi;
+        if (dR2 > dR2Max) continue;
+        f(index_[j], pt_[j], dR2);
+      }
+    }
+  }
+}
+
+#endif
@@ -0,0 +1,84 @@
+#ifndef _flatbdt_h_
+#define _flatbdt_h_
+// -*- C++ -*-
+//
+// Package:     PhaseTwoAnalysis/Common
+// Class:       FlatBDT
+// Description: inference-only replacement for TMVA::Reader on BDT weight files
+//
+// The TMVA weights XML is read once and all the trees of the forest are
+// stored in one flat node array, each tree in depth-first order: the left
+// child of an internal node is the next node, the right child is given by
+// its index. The TMVA cut type is folded in at load time (children swapped
+// for cType=0), so that every internal node reads "go right if x >= cut".
+// Leaves store their output in place of the cut.
+//
+// The output is the same as TMVA::Reader::EvaluateMVA for the supported
+// configurations: AdaBoost/RealAdaBoost/Bagging (boost-weighted average of
+// the leaf type or purity, depending on UseYesNoLeaf) and Grad. Input
+// transformations and Fisher cuts are not supported and are rejected.
+//
+// The input features are given in the order of the <Variables> block of the
+// weights file, as the raw values that would have been bound to the Reader
+// (TMVA does not evaluate the variable expressions at application time).
+// Spectators do not enter the evaluation and are not needed.
+//
+// FlatBDT::get() is the way modules should obtain a forest: every weights
+// file is loaded once per process and the same immutable instance is shared
+// by all modules and streams (evaluate() is const and keeps no state). The
+// flattened forest is also stored next to the XML file as "<file>.bin",
+// keyed by a hash of the XML content, and read back instead of parsing the
+// XML in later jobs. The cache is written atomically and only if the
+// directory is writable, a stale or unreadable cache is ignored.
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+class FlatBDT
+{
+ public:
+  explicit FlatBDT(const std::string & weightsFile);
+  // also checks that the variables of the weights file are the expected ones,
+  // written as in TMVA::Reader::AddVariable ("label := expression" allowed)
+  FlatBDT(const std::string & weightsFile, const std::vector<std::string> & variables);
+
+  // process-wide shared instance for weightsFile, loaded on first use
+  static std::shared_ptr<const FlatBDT> get(const std::string & weightsFile);
+  static std::shared_ptr<const FlatBDT> get(const std::string & weightsFile, const std::vector<std::string> & variables);
+
+  size_t nVariables() const { return variables_.size(); }
+  const std::vector<std::string> & variables() const { return variables_; }
+  size_t nTrees() const { return treeWeight_.size(); }
+
+  // one candidate, features[nVariables()]
+  double evaluate(const float * features) const;
+  // n candidates stored row-major in features[n*nVariables()], results in out[n];
+  // the loop over trees is the outer one so that each tree is read once
+  void evaluate(const float * features, size_t n, double * out) const;
+
+ private:
+  struct Node
+  {
+    float cut;   // cut value, or output for a leaf
+    int var;     // input variable, -1 for a leaf
+    int right;   // index of the right child (x >= cut)
+  };
+
+  FlatBDT();
+  void parse(const std::string & content);
+  void checkVariables(const std::vector<std::string> & variables) const;
+  bool readCache(const std::string & cacheFile, uint64_t hash);
+  void writeCache(const std::string & cacheFile, uint64_t hash) const;
+
+  std::string file_;
+  bool gradBoost_;
+  std::vector<std::string> variables_;
+  std::vector<Node> nodes_;
+  std::vector<int> treeRoot_;
+  std::vector<double> treeWeight_;
+  double sumWeights_;
+};
+
+#endif
@@ -0,0 +1,49 @@
+#ifndef _gentruthtable_h_
+#define _gentruthtable_h_
+// -*- C++ -*-
+//
+// Package:     PhaseTwoAnalysis/Common
+// Class:       GenTruthTable
+// Description: per-event table of the gen electrons and muons, for the
+//              gen-jet cleaning and the gen-lepton loop of the ntuplers
+//
+// The table is built once per event from the gen collection (genParticles
+// or packedGenParticles) and keeps the electrons and muons, in the order of
+// the collection, with their pt/eta/phi, so that the gen collection is only
+// scanned once per event.
+//
+//   genTruth_.build(*genParts);
+//   for (const GenTruthTable::Lepton & l : genTruth_.leptons()) remover.add(l.eta, l.phi, l.pt);
+
+#include "DataFormats/Candidate/interface/Candidate.h"
+
+#include <cstddef>
+#include <vector>
+
+class GenTruthTable
+{
+ public:
+  struct Lepton
+  {
+    size_t index;            // in the gen collection
+    int pdgId, status;
+    float pt, eta, phi;
+  };
+
+  void clear() { leptons_.clear(); }
+  // ignores anything but electrons and muons
+  void add(size_t index, const reco::Candidate & particle);
+
+  template <class Collection> void build(const Collection & genParts)
+  {
+    clear();
+    for (size_t i = 0; i < genParts.size(); i++) add(i, genParts[i]);
+  }
+
+  const std::vector<Lepton> & leptons() const { return leptons_; }
+
+ private:
+  std::vector<Lepton> leptons_;
+};
+
+#endif
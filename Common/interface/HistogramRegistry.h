@@ -0,0 +1,65 @@
+#ifndef _histogramregistry_h_
+#define _histogramregistry_h_
+// -*- C++ -*-
+//
+// Package:     PhaseTwoAnalysis/Common
+// Class:       HistogramRegistry
+// Description: TFileService histograms filled concurrently by the streams
+//
+// The histograms of a module are declared in a booking table, one
+// HistogramSpec per histogram with its index in the table as id (usually an
+// enum of the module). The registry, shared by the streams as their
+// edm::GlobalCache, books them once in the TFileService. Every stream fills
+// its own detached copies through a HistogramRegistry::Local, without any
+// lock, and adds them to the booked histograms at endStream with merge().
+// Histograms given bin labels are drawn as bar charts.
+//
+//   const std::vector<HistogramSpec> kHistograms = {
+//     {kMuonsN,  "MuonsN",  ";Number of muons;Events / 1", 4, 0., 4.},
+//     {kMuonsID, "MuonsID", ";;Muons / 1", 2, 0., 2., {"All", "Tight"}},
+//   };
+//   hists_.fill(kMuonsN, nMuons);                 // in analyze()
+//   globalCache()->merge(hists_);                 // in endStream()
+
+#include "TH1D.h"
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+struct HistogramSpec
+{
+  int id;
+  std::string name, title;
+  int nbins;
+  double xmin, xmax;
+  std::vector<std::string> binLabels;
+};
+
+class HistogramRegistry
+{
+ public:
+  explicit HistogramRegistry(const std::vector<HistogramSpec> & specs);
+
+  class Local
+  {
+   public:
+    explicit Local(const HistogramRegistry & registry);
+
+    void fill(int id, double x) { hists_[id]->Fill(x); }
+
+   private:
+    friend class HistogramRegistry;
+    std::vector<std::unique_ptr<TH1D>> hists_;
+  };
+
+  // adds the copies of a stream to the booked histograms and resets them
+  void merge(Local & local) const;
+
+ private:
+  mutable std::mutex mutex_;
+  std::vector<TH1D *> hists_;
+};
+
+#endif
@@ -0,0 +1,62 @@
+#ifndef _jetconstituentsoa_h_
+#define _jetconstituentsoa_h_
+// -*- C++ -*-
+//
+// Package:     PhaseTwoAnalysis/Common
+// Class:       JetConstituentSoA
+// Description: flat eta/phi/pt arrays of the constituents of a set of jets,
+//              meant to be filled once per event and queried for every lepton
+//
+// The constituents of the jets added with addJet() are stored contiguously,
+// jet after jet, and jetBegin_[j] .. jetBegin_[j+1] are those of jet j. They
+// are read through Candidate::daughter(), so that no constituent vector is
+// allocated per query as with getJetConstituentsQuick().
+//
+// coneSum() reproduces the historical gen-isolation loops: jets farther than
+// jetDR from the direction are skipped, constituents are summed if
+// dRMin <= deltaR <= dRMax.
+
+#include <cstddef>
+#include <vector>
+
+class JetConstituentSoA
+{
+ public:
+  void clear();
+
+  // append a jet (anything with eta(), phi(), numberOfDaughters(), daughter(k))
+  template <class Jet> void addJet(const Jet & jet);
+  // append a jet given the flat arrays of its n constituents
+  void addJet(float eta, float phi, const float *eta_c, const float *phi_c, const float *pt_c, size_t n);
+
+  // scalar pt sum of the constituents of the jets within jetDR,
+  // with dRMin <= deltaR <= dRMax
+  double coneSum(double eta, double phi, double jetDR, double dRMin, double dRMax) const;
+
+  size_t nJets() const { return jetEta_.size(); }
+  size_t size() const { return pt_.size(); }
+
+ private:
+  std::vector<float> jetEta_, jetPhi_;
+  std::vector<unsigned int> jetBegin_;
+  std::vector<float> eta_, phi_, pt_;
+};
+
+template <class Jet>
+void
+JetConstituentSoA::addJet(const Jet & jet)
+{
+  if (jetBegin_.empty()) jetBegin_.push_back(0);
+  jetEta_.push_back(jet.eta());
+  jetPhi_.push_back(jet.phi());
+  const size_t n = jet.numberOfDaughters();
+  for (size_t k = 0; k < n; k++) {
+    const auto * cand = jet.daughter(k);
+    eta_.push_back(cand->eta());
+    phi_.push_back(cand->phi());
+    pt_.push_back(cand->pt());
+  }
+  jetBegin_.push_back(pt_.size());
+}
+
+#endif
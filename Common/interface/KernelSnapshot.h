@@ -0,0 +1,64 @@
+#ifndef _kernelsnapshot_h_
+#define _kernelsnapshot_h_
+// -*- C++ -*-
+//
+// Package:     PhaseTwoAnalysis/Common
+// Namespace:   kernelsnapshot
+// Description: per-event inputs of the selection and isolation kernels
+//
+// A snapshot holds, for one event, the flat eta/phi/pt arrays the kernels of
+// this package run on: the PF candidates used for the electron isolation,
+// the electrons, muons and jets, the gen electrons and muons, and the gen
+// jets with their constituents (genJetNConstituents[j] consecutive entries
+// of genJetConstituents belong to gen jet j). No selection is applied at
+// recording, the kernels apply their own cuts.
+//
+// The snapshot can also hold the inputs of the object IDs, which need the
+// full objects and are only recorded on request: the variables of the RECO
+// electron ID (ElectronIDEvaluator::Variables and the endcap BDT output,
+// one entry per electron), and the ME0 track-segment matches of the muons
+// (ME0MatchSummary; the momentum and number of matches per muon, and
+// me0NMatches[m] consecutive matches belonging to muon m). They are empty
+// in snapshots recorded without them.
+//
+// Snapshots are recorded from real events by the KernelSnapshotRecorder
+// module into a "snapshots" tree and replayed by benchmarkPhaseTwoKernels,
+// which does not need the framework.
+
+#include "PhaseTwoAnalysis/Common/interface/DeltaRKernels.h"
+
+#include <string>
+#include <vector>
+
+class TTree;
+
+namespace kernelsnapshot {
+
+  struct Event
+  {
+    unsigned int run = 0, lumi = 0;
+    unsigned long long event = 0;
+
+    drkernels::Candidates pfCands, electrons, muons, jets;
+    drkernels::Candidates genLeptons, genJets, genJetConstituents;
+    std::vector<int> genLeptonPdgId;
+    std::vector<unsigned int> genJetNConstituents;
+
+    std::vector<float> elScEta, elSigmaIetaIeta, elDEtaIn, elDPhiIn, elHOverE, elOoEmooP, elChargedIsoRel, elMVA;
+    std::vector<int> elMatchedConversion;
+    std::vector<float> me0P, me0DEta, me0DPhi, me0DPhiBend;
+    std::vector<unsigned int> me0NMatches;
+
+    void clear();
+  };
+
+  // branches of tree pointing at the members of event, for writing
+  void book(TTree * tree, Event & event);
+
+  // all the entries of the snapshots tree of fileName (at most maxEvents if >= 0);
+  // throws cms::Exception if the file or the tree cannot be read
+  std::vector<Event> readAll(const std::string & fileName, long maxEvents = -1, const std::string & treeName = "snapshots");
+
+}
+
+#endif
@@ -0,0 +1,67 @@
+#ifndef _labelsummaryregistry_h_
+#define _labelsummaryregistry_h_
+// -*- C++ -*-
+//
+// Package:     PhaseTwoAnalysis/Common
+// Class:       LabelSummaryRegistry
+// Description: process-wide summaries of per-stream counters, by module label
+//
+// Every stream (or module) instance of a counter registers itself under its
+// key (module label, or label and selection) when it is constructed, and
+// merges its counters into the summary of the key when it finishes. The last
+// instance of a key to finish writes the summary, which is then erased, so
+// that a job running the same module in several streams reports it once.
+//
+//   namespace { LabelSummaryRegistry<Summary> summaries; }
+//   summaries.registerInstance(label_, [&](Summary & summary) { ... });   // first instance only
+//   summaries.merge(label_, [&](Summary & summary) { summary.events += events_; },
+//                   [](const std::string & label, const Summary & summary) { ... });
+//
+// All the calls are serialized by one mutex per registry; write is called
+// while holding it.
+
+#include <map>
+#include <mutex>
+#include <string>
+
+template <class Summary, class Key = std::string>
+class LabelSummaryRegistry
+{
+ public:
+  // init is called on the summary of the first instance of key
+  template <class Init>
+  void registerInstance(const Key & key, Init init)
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    Entry & entry = entries_[key];
+    if (entry.instances++ == 0) init(entry.summary);
+  }
+
+  void registerInstance(const Key & key) { registerInstance(key, [](Summary &) {}); }
+
+  // merge adds the counters of one instance; the last instance of key calls
+  // write(key, summary) and erases the summary
+  template <class Merge, class Write>
+  void merge(const Key & key, Merge merge, Write write)
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    Entry & entry = entries_[key];
+    merge(entry.summary);
+    if (++entry.finished == entry.instances) {
+      write(key, entry.summary);
+      entries_.erase(key);
+    }
+  }
+
+ private:
+  struct Entry
+  {
+    unsigned int instances = 0, finished = 0;
+    Summary summary;
+  };
+
+  std::mutex mutex_;
+  std::map<Key, Entry> entries_;
+};
+
+#endif
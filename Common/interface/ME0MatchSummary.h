@@ -0,0 +1,83 @@
+#ifndef _me0matchsummary_h_
+#define _me0matchsummary_h_
+// -*- C++ -*-
+//
+// Package:     PhaseTwoAnalysis/Common
+// Class:       ME0MatchSummary
+// Description: track-segment matching of an ME0 muon, computed once
+//
+// For each ME0 segment matched to the muon, the |dEta|, |dPhi| (global
+// positions) and |dPhiBend| (local bending) between the extrapolated track
+// and the segment are computed once, with the ME0 chambers looked up through
+// an ME0ChamberCache filled at beginRun. A muon passes a working point if
+// one of its segments passes all the cuts together; the dPhi and dPhiBend
+// cuts scale as 1.2/p and 0.2/p, between 1.2/100 (0.2/100) and the maximum
+// of the working point. The segment bending is recomputed from its local
+// direction, or taken from the ME0Segment itself with storedSegmentBend,
+// which needs the segment references of the RECO muons.
+//
+//   ME0MatchSummary me0Match(muon, me0Chambers_);
+//   bool isLooseME0 = me0Match.passes(ME0MatchSummary::kLoose);
+//   bool isTightME0 = me0Match.passes(ME0MatchSummary::kTight);
+//
+// The matches can also be read out and a summary rebuilt from them, e.g. by
+// the kernel benchmark from a recorded snapshot.
+
+#include "DataFormats/DetId/interface/DetId.h"
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+class ME0Chamber;
+class ME0Geometry;
+namespace reco { class Muon; }
+
+class ME0ChamberCache
+{
+ public:
+  // to be called when the geometry may have changed, clears the cache
+  void setGeometry(const ME0Geometry * geometry);
+
+  const ME0Chamber * chamber(const DetId & id);
+
+ private:
+  const ME0Geometry * geometry_ = nullptr;
+  std::unordered_map<uint32_t, const ME0Chamber *> chambers_;
+};
+
+class ME0MatchSummary
+{
+ public:
+  struct WorkingPoint
+  {
+    double dEta, dPhiMax, dPhiBendMax;
+  };
+  static const WorkingPoint kLoose, kTight;
+
+  struct Match
+  {
+    double deltaEta, deltaPhi, deltaPhiBend;
+  };
+
+  ME0MatchSummary() {}
+  ME0MatchSummary(const reco::Muon & muon, ME0ChamberCache & chambers, bool storedSegmentBend = false)
+  { fill(muon, chambers, storedSegmentBend); }
+  ME0MatchSummary(double p, const std::vector<Match> & matches) : p_(p), matches_(matches) {}
+
+  void fill(const reco::Muon & muon, ME0ChamberCache & chambers, bool storedSegmentBend = false);
+
+  bool passes(const WorkingPoint & wp) const;
+  bool passes(double dEtaCut, double dPhiCut, double dPhiBendCut) const;
+
+  // number of matched ME0 segments, 0 if not an ME0 muon
+  size_t size() const { return matches_.size(); }
+  double p() const { return p_; }
+  const std::vector<Match> & matches() const { return matches_; }
+
+ private:
+  double p_ = 0.;
+  std::vector<Match> matches_;
+};
+
+#endif
@@ -0,0 +1,74 @@
+#ifndef _modulecostmonitor_h_
+#define _modulecostmonitor_h_
+// -*- C++ -*-
+//
+// Package:     PhaseTwoAnalysis/Common
+// Class:       ModuleCostMonitor
+// Description: per-module time and RSS accounting of a cmsRun job, with the
+//              sizes of its input collections
+//
+// The service times every module call and reads the resident set size of
+// the process before and after it. The CollectionSizeRecorder module adds the
+// sizes of the input collections of each event (pfCands, tracks, gen
+// particles, gen jets...), so that the cost of every module can be related
+// to the multiplicities it loops over. At the end of the job a JSON summary
+// is written to the untracked fileName parameter:
+//   { "events": ..., "peakRssMB": ...,
+//     "modules": { label: { "type", "calls", "msPerEvent", "msPerCall",
+//                           "maxMsPerCall", "rssGrowthMB", "maxRssMB" } },
+//     "collections": { name: { "mean", "max" } } }
+// which is read by Common/scripts/pileupScaling.py.
+//
+// Modules called while another one runs on the same thread (unscheduled
+// producers) are also included in the time of the caller. The RSS growth of
+// a module is only meaningful with a single thread.
+
+#include "FWCore/ParameterSet/interface/ParameterSet.h"
+
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+
+namespace edm {
+  class ActivityRegistry;
+  class ModuleCallingContext;
+  class StreamContext;
+  class ConfigurationDescriptions;
+}
+
+class ModuleCostMonitor
+{
+ public:
+  ModuleCostMonitor(const edm::ParameterSet & iConfig, edm::ActivityRegistry & iRegistry);
+
+  static void fillDescriptions(edm::ConfigurationDescriptions & descriptions);
+
+  // size of an input collection in the current event, thread safe
+  void addCollectionSize(const std::string & name, size_t size);
+
+ private:
+  struct Module
+  {
+    std::string type;
+    uint64_t calls = 0, totalNs = 0, maxNs = 0;
+    int64_t rssGrowthKB = 0, maxRssKB = 0;
+  };
+  struct Collection
+  {
+    uint64_t entries = 0, sum = 0, max = 0;
+  };
+
+  void preModuleEvent(const edm::StreamContext &, const edm::ModuleCallingContext &);
+  void postModuleEvent(const edm::StreamContext &, const edm::ModuleCallingContext &);
+  void postEvent(const edm::StreamContext &);
+  void postEndJob();
+
+  std::string fileName_;
+  std::mutex mutex_;
+  uint64_t events_;
+  std::map<std::string, Module> modules_;
+  std::map<std::string, Collection> collections_;
+};
+
+#endif
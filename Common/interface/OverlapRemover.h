@@ -0,0 +1,47 @@
+#ifndef _overlapremover_h_
+#define _overlapremover_h_
+// -*- C++ -*-
+//
+// Package:     PhaseTwoAnalysis/Common
+// Class:       OverlapRemover
+// Description: jet-lepton cleaning against an eta-sorted array of leptons
+//
+// The candidates to clean against (typically all the electrons and muons of
+// the event) are added once per event and build() sorts them in eta. A
+// query only looks at the candidates within dR in eta, found by binary
+// search, and applies the historical definition of an overlap: the same
+// object seen twice, i.e. deltaR < dR and |pt - pt_lep| < relPt*pt_lep.
+//
+//   remover.clear();
+//   for (...) remover.add(lepton);
+//   remover.build();
+//   for (...) if (remover.overlaps(jet)) continue;
+
+#include <cstddef>
+#include <vector>
+
+class OverlapRemover
+{
+ public:
+  explicit OverlapRemover(float dR = 0.01, float relPt = 0.01) : dR_(dR), relPt_(relPt) {}
+
+  void clear();
+  // anything with eta(), phi() and pt()
+  template <class T> void add(const T & cand) { add(cand.eta(), cand.phi(), cand.pt()); }
+  void add(float eta, float phi, float pt);
+  // sort the candidates, to be called after the last add() and before overlaps()
+  void build();
+
+  bool overlaps(float eta, float phi, float pt) const;
+  template <class T> bool overlaps(const T & cand) const { return overlaps(cand.eta(), cand.phi(), cand.pt()); }
+
+  size_t size() const { return eta_.size(); }
+
+ private:
+  float dR_, relPt_;
+  std::vector<float> eta_, phi_, pt_;
+  std::vector<unsigned int> order_;
+  std::vector<float> buffer_;
+};
+
+#endif
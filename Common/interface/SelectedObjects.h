@@ -0,0 +1,68 @@
+#ifndef _selectedobjects_h_
+#define _selectedobjects_h_
+// -*- C++ -*-
+//
+// Package:     PhaseTwoAnalysis/Common
+// Namespace:   selectedobjects
+// Description: products of the object filters
+//
+// The filters record the indices of the selected objects in their input
+// collection and publish them with put(), either
+//   - as a std::vector<T> holding copies of the objects (default), or
+//   - with outputPtrs = True, as an edm::PtrVector<T> into the input
+//     collection, which then has to be kept in the output file.
+// Both can be read back as an edm::View<T>.
+//
+// In the PtrVector mode the per-object quantities (relIso) are stored in one
+// edm::ValueMap keyed on the input collection instead of one vector per
+// working point; objects failing the pt/eta preselection are given -1.
+
+#include "DataFormats/Common/interface/Handle.h"
+#include "DataFormats/Common/interface/Ptr.h"
+#include "DataFormats/Common/interface/PtrVector.h"
+#include "DataFormats/Common/interface/ValueMap.h"
+#include "DataFormats/Common/interface/View.h"
+#include "FWCore/Framework/interface/Event.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace selectedobjects {
+
+  template <class T>
+  edm::Ptr<T> ptrAt(const edm::Handle<std::vector<T>> & handle, size_t index) { return edm::Ptr<T>(handle, index); }
+  template <class T>
+  edm::Ptr<T> ptrAt(const edm::Handle<edm::View<T>> & handle, size_t index) { return handle->ptrAt(index); }
+
+  // the objects of handle at indices, as copies or as edm::PtrVector<T>
+  template <class T, class C>
+  void put(edm::Event & iEvent, const edm::Handle<C> & handle, const std::vector<unsigned int> & indices, bool asPtrs, const std::string & label)
+  {
+    if (asPtrs) {
+      std::unique_ptr<edm::PtrVector<T>> ptrs(new edm::PtrVector<T>());
+      ptrs->reserve(indices.size());
+      for (unsigned int index : indices) ptrs->push_back(ptrAt(handle, index));
+      iEvent.put(std::move(ptrs), label);
+    } else {
+      std::unique_ptr<std::vector<T>> objects(new std::vector<T>());
+      objects->reserve(indices.size());
+      for (unsigned int index : indices) objects->push_back((*handle)[index]);
+      iEvent.put(std::move(objects), label);
+    }
+  }
+
+  // values[i] for every object of handle
+  template <class C, class V>
+  void putValueMap(edm::Event & iEvent, const edm::Handle<C> & handle, const std::vector<V> & values, const std::string & label)
+  {
+    std::unique_ptr<edm::ValueMap<V>> valueMap(new edm::ValueMap<V>());
+    typename edm::ValueMap<V>::Filler filler(*valueMap);
+    filler.insert(handle, values.begin(), values.end());
+    filler.fill();
+    iEvent.put(std::move(valueMap), label);
+  }
+
+}
+
+#endif
@@ -0,0 +1,99 @@
+#ifndef _stagetimer_h_
+#define _stagetimer_h_
+// -*- C++ -*-
+//
+// Package:     PhaseTwoAnalysis/Common
+// Class:       StageTimer
+// Description: per-stage wall-clock accounting inside a module
+//
+// A module declares its stages once and wraps the corresponding code in
+// StageTimer::Scope objects; endEvent() closes the event. Enabled with the
+// untracked "timing" parameter of the module, the timer is otherwise a
+// no-op (no clock is read).
+//
+//   StageTimer::Scope scope(timer_, kMuons);
+//   ...                      // muon selection
+//   scope.next(kElectrons);  // closes kMuons, opens kElectrons
+//   ...
+//   scope.stop();
+//
+// Every stream (or module) instance has its own timer. At endStream/endJob
+// finish() merges it into a process-wide summary per module label
+// (LabelSummaryRegistry); the last instance of a label prints the summary
+// (mean time per event and per call for each stage) and, if the TFileService
+// is available, stores in a "timing" directory the mean time per event of
+// each stage and per-event distributions of the time spent in each stage and
+// in all of them.
+
+#include "FWCore/ParameterSet/interface/ParameterSet.h"
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class StageTimer
+{
+ public:
+  StageTimer(const edm::ParameterSet & iConfig, const std::vector<std::string> & stages);
+
+  bool enabled() const { return enabled_; }
+
+  void add(unsigned int stage, uint64_t ns)
+  {
+    eventNs_[stage] += ns;
+    calls_[stage]++;
+  }
+  void endEvent();
+  // to be called from endStream/endJob, while the TFileService is still open
+  void finish();
+
+  class Scope
+  {
+   public:
+    Scope(StageTimer & timer, unsigned int stage) : timer_(timer), stage_(stage), running_(timer.enabled())
+    {
+      if (running_) start_ = std::chrono::steady_clock::now();
+    }
+    ~Scope() { stop(); }
+
+    void stop()
+    {
+      if (!running_) return;
+      timer_.add(stage_, std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start_).count());
+      running_ = false;
+    }
+    void next(unsigned int stage)
+    {
+      if (!timer_.enabled()) return;
+      auto now = std::chrono::steady_clock::now();
+      if (running_) timer_.add(stage_, std::chrono::duration_cast<std::chrono::nanoseconds>(now - start_).count());
+      stage_ = stage;
+      start_ = now;
+      running_ = true;
+    }
+
+   private:
+    StageTimer & timer_;
+    unsigned int stage_;
+    bool running_;
+    std::chrono::steady_clock::time_point start_;
+  };
+
+  // per-event histograms: log binning of the time in ms
+  static const int kBinsPerDecade = 10, kDecades = 7;
+  static constexpr double kMinMs = 1e-3;
+
+ private:
+  static int bin(uint64_t ns);
+
+  bool enabled_, finished_;
+  std::string label_;
+  std::vector<std::string> stages_;
+  uint64_t events_;
+  std::vector<uint64_t> eventNs_, totalNs_, calls_;
+  // [stage][bin], stage nStages is the sum over the stages
+  std::vector<std::vector<uint64_t>> counts_;
+};
+
+#endif
@@ -0,0 +1,124 @@
+// -*- C++ -*-
+//
+// Package:    PhaseTwoAnalysis/Common
+// Class:      CollectionSizeRecorder
+//
+/**\class CollectionSizeRecorder CollectionSizeRecorder.cc PhaseTwoAnalysis/Common/plugins/CollectionSizeRecorder.cc
+
+Description: records the sizes of the input collections of each event in the
+ModuleCostMonitor service, to relate the cost of the modules to the
+multiplicities they loop over
+
+Implementation:
+- the "candidates" collections are read as edm::View<reco::Candidate>, so that
+  the same module runs on RECO and PAT events, the "tracks" ones as
+  edm::View<reco::Track>
+- the collections are named by their encoded input tag
+*/
+
+
+// system include files
+#include <memory>
+
+// user include files
+#include "FWCore/Framework/interface/Frameworkfwd.h"
+#include "FWCore/Framework/interface/global/EDAnalyzer.h"
+
+#include "FWCore/Framework/interface/Event.h"
+#include "FWCore/Framework/interface/MakerMacros.h"
+
+#include "FWCore/ParameterSet/interface/ParameterSet.h"
+#include "FWCore/Utilities/interface/StreamID.h"
+#include "FWCore/Utilities/interface/InputTag.h"
+#include "FWCore/ServiceRegistry/interface/Service.h"
+#include "DataFormats/Common/interface/Handle.h"
+#include "DataFormats/Common/interface/View.h"
+#include "DataFormats/Candidate/interface/Candidate.h"
+#include "DataFormats/TrackReco/interface/Track.h"
+#include "DataFormats/VertexReco/interface/Vertex.h"
+
+#include "PhaseTwoAnalysis/Common/interface/ModuleCostMonitor.h"
+
+#include <string>
+#include <vector>
+
+//
+// class declaration
+//
+
+class CollectionSizeRecorder : public edm::global::EDAnalyzer<> {
+  public:
+    explicit CollectionSizeRecorder(const edm::ParameterSet&);
+    ~CollectionSizeRecorder() {}
+
+    static void fillDescriptions(edm::ConfigurationDescriptions& descriptions);
+
+  private:
+    virtual void analyze(edm::StreamID, const edm::Event&, const edm::EventSetup&) const override;
+
+    // ----------member data ---------------------------
+    std::vector<std::string> candidatesNames_, tracksNames_;
+    std::vector<edm::EDGetTokenT<edm::View<reco::Candidate>>> candidatesTokens_;
+    std::vector<edm::EDGetTokenT<edm::View<reco::Track>>> tracksTokens_;
+    std::string verticesName_;
+    edm::EDGetTokenT<std::vector<reco::Vertex>> verticesToken_;
+};
+
+//
+// constructors and destructor
+//
+CollectionSizeRecorder::CollectionSizeRecorder(const edm::ParameterSet& iConfig)
+{
+  for (const edm::InputTag & tag : iConfig.getParameter<std::vector<edm::InputTag>>("candidates")) {
+    candidatesNames_.push_back(tag.encode());
+    candidatesTokens_.push_back(consumes<edm::View<reco::Candidate>>(tag));
+  }
+  for (const edm::InputTag & tag : iConfig.getParameter<std::vector<edm::InputTag>>("tracks")) {
+    tracksNames_.push_back(tag.encode());
+    tracksTokens_.push_back(consumes<edm::View<reco::Track>>(tag));
+  }
+  const edm::InputTag vertices = iConfig.getParameter<edm::InputTag>("vertices");
+  verticesName_ = vertices.encode();
+  verticesToken_ = consumes<std::vector<reco::Vertex>>(vertices);
+}
+
+//
+// member functions
+//
+
+// ------------ method called for each event  ------------
+  void
+CollectionSizeRecorder::analyze(edm::StreamID, const edm::Event& iEvent, const edm::EventSetup& iSetup) const
+{
+  using namespace edm;
+
+  Service<ModuleCostMonitor> monitor;
+  if (!monitor.isAvailable()) return;
+
+  for (size_t i = 0; i < candidatesTokens_.size(); i++) {
+    Handle<View<reco::Candidate>> candidates;
+    iEvent.getByToken(candidatesTokens_[i], candidates);
+    monitor->addCollectionSize(candidatesNames_[i], candidates->size());
+  }
+  for (size_t i = 0; i < tracksTokens_.size(); i++) {
+    Handle<View<reco::Track>> tracks;
+    iEvent.getByToken(tracksTokens_[i], tracks);
+    monitor->addCollectionSize(tracksNames_[i], tracks->size());
+  }
+  Handle<std::vector<reco::Vertex>> vertices;
+  iEvent.getByToken(verticesToken_, vertices);
+  monitor->addCollectionSize(verticesName_, vertices->size());
+}
+
+// ------------ method fills 'descriptions' with the allowed parameters for the module  ------------
+void
+CollectionSizeRecorder::fillDescriptions(edm::ConfigurationDescriptions& descriptions) {
+  //The following says we do not know what parameters are allowed so do no validation
+  // Please change this to state exactly what you do use, even if it is no parameters
+  edm::ParameterSetDescription desc;
+  desc.setUnknown();
+  descriptions.addDefault(desc);
+}
+
+//define this as a plug-in
+DEFINE_FWK_MODULE(CollectionSizeRecorder);
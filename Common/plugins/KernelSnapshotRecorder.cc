@@ -0,0 +1,260 @@
+// -*- C++ -*-
+//
+// Package:    PhaseTwoAnalysis/Common
+// Class:      KernelSnapshotRecorder
+//
+/**\class KernelSnapshotRecorder KernelSnapshotRecorder.cc PhaseTwoAnalysis/Common/plugins/KernelSnapshotRecorder.cc
+
+Description: records per-event snapshots of the inputs of the selection and
+isolation kernels, to be replayed by benchmarkPhaseTwoKernels
+
+Implementation:
+- all collections are read as edm::View<reco::Candidate>, so that the same
+  module runs on RECO and PAT events
+- only gen electrons and muons are kept, as only those enter the kernels
+- with recordElectronID, the electrons are also read as reco::GsfElectron
+  and the variables of ElectronIDEvaluator are recorded, with the conversion
+  match and the endcap BDT output of electronMVA (an edm::ValueMap<double>,
+  e.g. recoElectronID:MVA; -1 if its label is empty)
+- with recordME0Matches, the muons are also read as reco::Muon and their ME0
+  track-segment matches are recorded (needs the ME0 geometry)
+- the snapshots are stored in the "snapshots" tree of the TFileService
+*/
+
+
+// system include files
+#include <memory>
+
+// user include files
+#include "FWCore/Framework/interface/Frameworkfwd.h"
+#include "FWCore/Framework/interface/one/EDAnalyzer.h"
+
+#include "FWCore/Framework/interface/Event.h"
+#include "FWCore/Framework/interface/EventSetup.h"
+#include "FWCore/Framework/interface/ESHandle.h"
+#include "FWCore/Framework/interface/MakerMacros.h"
+#include "FWCore/Framework/interface/Run.h"
+
+#include "FWCore/ParameterSet/interface/ParameterSet.h"
+#include "FWCore/Utilities/interface/InputTag.h"
+#include "FWCore/ServiceRegistry/interface/Service.h"
+#include "CommonTools/UtilAlgos/interface/TFileService.h"
+#include "DataFormats/Common/interface/Handle.h"
+#include "DataFormats/Common/interface/View.h"
+#include "DataFormats/Common/interface/ValueMap.h"
+#include "DataFormats/BeamSpot/interface/BeamSpot.h"
+#include "DataFormats/Candidate/interface/Candidate.h"
+#include "DataFormats/EgammaCandidates/interface/Conversion.h"
+#include "DataFormats/EgammaCandidates/interface/GsfElectron.h"
+#include "DataFormats/MuonReco/interface/Muon.h"
+#include "Geometry/GEMGeometry/interface/ME0Geometry.h"
+#include "Geometry/Records/interface/MuonGeometryRecord.h"
+
+#include "PhaseTwoAnalysis/Common/interface/ConversionIndex.h"
+#include "PhaseTwoAnalysis/Common/interface/ElectronIDEvaluator.h"
+#include "PhaseTwoAnalysis/Common/interface/KernelSnapshot.h"
+#include "PhaseTwoAnalysis/Common/interface/ME0MatchSummary.h"
+
+#include "TTree.h"
+
+//
+// class declaration
+//
+
+class KernelSnapshotRecorder : public edm::one::EDAnalyzer<edm::one::SharedResources, edm::one::WatchRuns>  {
+  public:
+    explicit KernelSnapshotRecorder(const edm::ParameterSet&);
+    ~KernelSnapshotRecorder() {}
+
+    static void fillDescriptions(edm::ConfigurationDescriptions& descriptions);
+
+  private:
+    virtual void beginJob() override;
+    virtual void beginRun(const edm::Run&, const edm::EventSetup&) override;
+    virtual void analyze(const edm::Event&, const edm::EventSetup&) override;
+    virtual void endRun(const edm::Run&, const edm::EventSetup&) override {}
+    virtual void endJob() override {}
+
+    void recordElectronID(const edm::Event&);
+    void recordME0Matches(const edm::Event&);
+
+    // ----------member data ---------------------------
+    edm::EDGetTokenT<edm::View<reco::Candidate>> pfCandsToken_;
+    edm::EDGetTokenT<edm::View<reco::Candidate>> elecsToken_;
+    edm::EDGetTokenT<edm::View<reco::Candidate>> muonsToken_;
+    edm::EDGetTokenT<edm::View<reco::Candidate>> jetsToken_;
+    edm::EDGetTokenT<edm::View<reco::Candidate>> genPartsToken_;
+    edm::EDGetTokenT<edm::View<reco::Candidate>> genJetsToken_;
+
+    bool recordElectronID_, recordME0Matches_;
+    edm::EDGetTokenT<edm::View<reco::GsfElectron>> gsfElecsToken_;
+    edm::EDGetTokenT<reco::BeamSpot> bsToken_;
+    edm::EDGetTokenT<std::vector<reco::Conversion>> convToken_;
+    edm::EDGetTokenT<edm::ValueMap<double>> electronMVAToken_;
+    edm::EDGetTokenT<edm::View<reco::Muon>> recoMuonsToken_;
+
+    ConversionIndex conversionIndex_;
+    ME0ChamberCache me0Chambers_;
+    TTree *tree_;
+    kernelsnapshot::Event snapshot_;
+};
+
+//
+// constructors and destructor
+//
+KernelSnapshotRecorder::KernelSnapshotRecorder(const edm::ParameterSet& iConfig):
+  pfCandsToken_(consumes<edm::View<reco::Candidate>>(iConfig.getParameter<edm::InputTag>("pfCands"))),
+  elecsToken_(consumes<edm::View<reco::Candidate>>(iConfig.getParameter<edm::InputTag>("electrons"))),
+  muonsToken_(consumes<edm::View<reco::Candidate>>(iConfig.getParameter<edm::InputTag>("muons"))),
+  jetsToken_(consumes<edm::View<reco::Candidate>>(iConfig.getParameter<edm::InputTag>("jets"))),
+  genPartsToken_(consumes<edm::View<reco::Candidate>>(iConfig.getParameter<edm::InputTag>("genParts"))),
+  genJetsToken_(consumes<edm::View<reco::Candidate>>(iConfig.getParameter<edm::InputTag>("genJets"))),
+  recordElectronID_(iConfig.getParameter<bool>("recordElectronID")),
+  recordME0Matches_(iConfig.getParameter<bool>("recordME0Matches")),
+  tree_(nullptr)
+{
+  usesResource("TFileService");
+  if (recordElectronID_) {
+    gsfElecsToken_ = consumes<edm::View<reco::GsfElectron>>(iConfig.getParameter<edm::InputTag>("electrons"));
+    bsToken_ = consumes<reco::BeamSpot>(iConfig.getParameter<edm::InputTag>("beamspot"));
+    convToken_ = consumes<std::vector<reco::Conversion>>(iConfig.getParameter<edm::InputTag>("conversions"));
+    const edm::InputTag electronMVA = iConfig.getParameter<edm::InputTag>("electronMVA");
+    if (!electronMVA.label().empty()) electronMVAToken_ = consumes<edm::ValueMap<double>>(electronMVA);
+  }
+  if (recordME0Matches_)
+    recoMuonsToken_ = consumes<edm::View<reco::Muon>>(iConfig.getParameter<edm::InputTag>("muons"));
+}
+
+//
+// member functions
+//
+
+// ------------ method called for each event  ------------
+  void
+KernelSnapshotRecorder::analyze(const edm::Event& iEvent, const edm::EventSetup& iSetup)
+{
+  using namespace edm;
+
+  Handle<View<reco::Candidate>> pfCands;
+  iEvent.getByToken(pfCandsToken_, pfCands);
+  Handle<View<reco::Candidate>> elecs;
+  iEvent.getByToken(elecsToken_, elecs);
+  Handle<View<reco::Candidate>> muons;
+  iEvent.getByToken(muonsToken_, muons);
+  Handle<View<reco::Candidate>> jets;
+  iEvent.getByToken(jetsToken_, jets);
+
+  snapshot_.clear();
+  snapshot_.run   = iEvent.id().run();
+  snapshot_.lumi  = iEvent.luminosityBlock();
+  snapshot_.event = iEvent.id().event();
+
+  for (const auto & cand : *pfCands) snapshot_.pfCands.push_back(cand);
+  for (const auto & elec : *elecs) snapshot_.electrons.push_back(elec);
+  for (const auto & muon : *muons) snapshot_.muons.push_back(muon);
+  for (const auto & jet : *jets) snapshot_.jets.push_back(jet);
+  if (recordElectronID_) recordElectronID(iEvent);
+  if (recordME0Matches_) recordME0Matches(iEvent);
+
+  if (!iEvent.isRealData()) {
+    Handle<View<reco::Candidate>> genParts;
+    iEvent.getByToken(genPartsToken_, genParts);
+    Handle<View<reco::Candidate>> genJets;
+    iEvent.getByToken(genJetsToken_, genJets);
+
+    for (const auto & part : *genParts) {
+      if (abs(part.pdgId()) != 11 && abs(part.pdgId()) != 13) continue;
+      snapshot_.genLeptons.push_back(part);
+      snapshot_.genLeptonPdgId.push_back(part.pdgId());
+    }
+    for (const auto & jet : *genJets) {
+      snapshot_.genJets.push_back(jet);
+      const size_t n = jet.numberOfDaughters();
+      for (size_t k = 0; k < n; k++) snapshot_.genJetConstituents.push_back(*jet.daughter(k));
+      snapshot_.genJetNConstituents.push_back(n);
+    }
+  }
+
+  tree_->Fill();
+}
+
+// ------------ method recording the inputs of the RECO electron ID  ------------
+  void
+KernelSnapshotRecorder::recordElectronID(const edm::Event& iEvent)
+{
+  using namespace edm;
+
+  Handle<View<reco::GsfElectron>> elecs;
+  iEvent.getByToken(gsfElecsToken_, elecs);
+  Handle<reco::BeamSpot> bsHandle;
+  iEvent.getByToken(bsToken_, bsHandle);
+  Handle<reco::ConversionCollection> conversions;
+  iEvent.getByToken(convToken_, conversions);
+  conversionIndex_.fill(*conversions, bsHandle->position());
+  Handle<ValueMap<double>> mva;
+  if (!electronMVAToken_.isUninitialized()) iEvent.getByToken(electronMVAToken_, mva);
+
+  for (size_t i = 0; i < elecs->size(); i++) {
+    const ElectronIDEvaluator::Variables vars = ElectronIDEvaluator::variables(elecs->at(i), conversionIndex_);
+    snapshot_.elScEta.push_back(vars.scEta);
+    snapshot_.elSigmaIetaIeta.push_back(vars.sigmaIetaIeta);
+    snapshot_.elDEtaIn.push_back(vars.dEtaIn);
+    snapshot_.elDPhiIn.push_back(vars.dPhiIn);
+    snapshot_.elHOverE.push_back(vars.hOverE);
+    snapshot_.elOoEmooP.push_back(vars.ooEmooP);
+    snapshot_.elChargedIsoRel.push_back(vars.chargedIsoRel);
+    snapshot_.elMatchedConversion.push_back(vars.matchedConversion);
+    snapshot_.elMVA.push_back(mva.isValid() ? (*mva)[elecs->ptrAt(i)] : -1.);
+  }
+}
+
+// ------------ method recording the ME0 track-segment matches of the muons  ------------
+  void
+KernelSnapshotRecorder::recordME0Matches(const edm::Event& iEvent)
+{
+  edm::Handle<edm::View<reco::Muon>> muons;
+  iEvent.getByToken(recoMuonsToken_, muons);
+
+  for (const auto & muon : *muons) {
+    ME0MatchSummary me0Match(muon, me0Chambers_);
+    snapshot_.me0P.push_back(me0Match.p());
+    snapshot_.me0NMatches.push_back(me0Match.size());
+    for (const auto & match : me0Match.matches()) {
+      snapshot_.me0DEta.push_back(match.deltaEta);
+      snapshot_.me0DPhi.push_back(match.deltaPhi);
+      snapshot_.me0DPhiBend.push_back(match.deltaPhiBend);
+    }
+  }
+}
+
+// ------------ method called when starting to process a run  ------------
+  void
+KernelSnapshotRecorder::beginRun(const edm::Run&, const edm::EventSetup& iSetup)
+{
+  if (!recordME0Matches_) return;
+  edm::ESHandle<ME0Geometry> hGeom;
+  iSetup.get<MuonGeometryRecord>().get(hGeom);
+  me0Chambers_.setGeometry(&*hGeom);
+}
+
+// ------------ method called once each job just before starting event loop  ------------
+  void
+KernelSnapshotRecorder::beginJob()
+{
+  edm::Service<TFileService> fs;
+  tree_ = fs->make<TTree>("snapshots", "inputs of the selection and isolation kernels");
+  kernelsnapshot::book(tree_, snapshot_);
+}
+
+// ------------ method fills 'descriptions' with the allowed parameters for the module  ------------
+void
+KernelSnapshotRecorder::fillDescriptions(edm::ConfigurationDescriptions& descriptions) {
+  //The following says we do not know what parameters are allowed so do no validation
+  // Please change this to state exactly what you do use, even if it is no parameters
+  edm::ParameterSetDescription desc;
+  desc.setUnknown();
+  descriptions.addDefault(desc);
+}
+
+//define this as a plug-in
+DEFINE_FWK_MODULE(KernelSnapshotRecorder);
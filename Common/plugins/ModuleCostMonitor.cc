@@ -0,0 +1,17 @@
+// -*- C++ -*-
+//
+// Package:    PhaseTwoAnalysis/Common
+// Class:      ModuleCostMonitor
+//
+/**\class ModuleCostMonitor ModuleCostMonitor.cc PhaseTwoAnalysis/Common/plugins/ModuleCostMonitor.cc
+
+Description: plug-in of the ModuleCostMonitor service, see
+PhaseTwoAnalysis/Common/interface/ModuleCostMonitor.h
+*/
+
+#include "FWCore/ServiceRegistry/interface/ServiceMaker.h"
+
+#include "PhaseTwoAnalysis/Common/interface/ModuleCostMonitor.h"
+
+//define this as a plug-in
+DEFINE_FWK_SERVICE(ModuleCostMonitor);
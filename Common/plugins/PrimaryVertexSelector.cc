@@ -0,0 +1,106 @@
+// -*- C++ -*-
+//
+// Package:    PhaseTwoAnalysis/Common
+// Class:      PrimaryVertexSelector
+//
+/**\class PrimaryVertexSelector PrimaryVertexSelector.cc PhaseTwoAnalysis/Common/plugins/PrimaryVertexSelector.cc
+
+Description: selects the primary vertex once per event for the object
+filters and the ntuplers
+
+Implementation:
+- vertices flagged as fake or with ndof <= 4 are rejected, the primary vertex
+  is the first of the remaining ones
+- the index of the primary vertex in the input collection is put as an int,
+  -1 if no vertex passes; the consumers read the same vertex collection to
+  access it
+- the pT of the p4 of every selected vertex, in the order of the input
+  collection, is put as "Pt2" (the v_pt2 branch of the ntuples)
+*/
+
+
+// system include files
+#include <memory>
+
+// user include files
+#include "FWCore/Framework/interface/Frameworkfwd.h"
+#include "FWCore/Framework/interface/global/EDProducer.h"
+
+#include "FWCore/Framework/interface/Event.h"
+#include "FWCore/Framework/interface/MakerMacros.h"
+
+#include "FWCore/ParameterSet/interface/ParameterSet.h"
+#include "FWCore/Utilities/interface/StreamID.h"
+#include "FWCore/Utilities/interface/InputTag.h"
+#include "DataFormats/Common/interface/Handle.h"
+
+#include "DataFormats/VertexReco/interface/Vertex.h"
+
+#include <vector>
+
+//
+// class declaration
+//
+
+class PrimaryVertexSelector : public edm::global::EDProducer<> {
+  public:
+    explicit PrimaryVertexSelector(const edm::ParameterSet&);
+    ~PrimaryVertexSelector() {}
+
+    static void fillDescriptions(edm::ConfigurationDescriptions& descriptions);
+
+  private:
+    virtual void produce(edm::StreamID, edm::Event&, const edm::EventSetup&) const override;
+
+    // ----------member data ---------------------------
+    edm::EDGetTokenT<std::vector<reco::Vertex>> verticesToken_;
+};
+
+//
+// constructors and destructor
+//
+PrimaryVertexSelector::PrimaryVertexSelector(const edm::ParameterSet& iConfig):
+  verticesToken_(consumes<std::vector<reco::Vertex>>(iConfig.getParameter<edm::InputTag>("vertices")))
+{
+  produces<int>();
+  produces<std::vector<double>>("Pt2");
+}
+
+//
+// member functions
+//
+
+// ------------ method called to produce the data  ------------
+  void
+PrimaryVertexSelector::produce(edm::StreamID, edm::Event& iEvent, const edm::EventSetup& iSetup) const
+{
+  using namespace edm;
+
+  Handle<std::vector<reco::Vertex>> vertices;
+  iEvent.getByToken(verticesToken_, vertices);
+
+  int prVtx = -1;
+  std::unique_ptr<std::vector<double>> pt2(new std::vector<double>());
+  for (size_t i = 0; i < vertices->size(); i++) {
+    if (vertices->at(i).isFake()) continue;
+    if (vertices->at(i).ndof() <= 4) continue;
+    if (prVtx < 0) prVtx = i;
+    pt2->push_back(vertices->at(i).p4().pt());
+  }
+
+  iEvent.put(std::unique_ptr<int>(new int(prVtx)));
+  iEvent.put(std::move(pt2), "Pt2");
+}
+
+// ------------ method fills 'descriptions' with the allowed parameters for the module  ------------
+void
+PrimaryVertexSelector::fillDescriptions(edm::ConfigurationDescriptions& descriptions) {
+  //The following says we do not know what parameters are allowed so do no validation
+  // Please change this to state exactly what you do use, even if it is no parameters
+  edm::ParameterSetDescription desc;
+  desc.setUnknown();
+  descriptions.addDefault(desc);
+}
+
+//define this as a plug-in
+DEFINE_FWK_MODULE(PrimaryVertexSelector);
@@ -0,0 +1,7 @@
+import FWCore.ParameterSet.Config as cms
+
+collectionSizes = cms.EDAnalyzer('CollectionSizeRecorder',
+        candidates   = cms.VInputTag("packedPFCandidates", "lostTracks", "packedGenParticles", "prunedGenParticles", "slimmedGenJets"),
+        tracks       = cms.VInputTag(),
+        vertices     = cms.InputTag("offlineSlimmedPrimaryVertices"),
+)
@@ -0,0 +1,15 @@
+import FWCore.ParameterSet.Config as cms
+
+snapshots = cms.EDAnalyzer('KernelSnapshotRecorder',
+        pfCands      = cms.InputTag("packedPFCandidates"),
+        electrons    = cms.InputTag("slimmedElectrons"),
+        muons        = cms.InputTag("slimmedMuons"),
+        jets         = cms.InputTag("slimmedJetsPuppi"),
+        genParts     = cms.InputTag("packedGenParticles"),
+        genJets      = cms.InputTag("slimmedGenJets"),
+        recordElectronID = cms.bool(False),
+        beamspot     = cms.InputTag("offlineBeamSpot"),
+        conversions  = cms.InputTag("reducedEgamma", "reducedConversions"),
+        electronMVA  = cms.InputTag(""),
+        recordME0Matches = cms.bool(False),
+)
@@ -0,0 +1,20 @@
+import FWCore.ParameterSet.Config as cms
+
+def addPileupBenchmark(process, inputFormat, fileName):
+    """Record the time and RSS of every module of the process and the sizes of
+    its input collections in the JSON file fileName (see ModuleCostMonitor.h),
+    to be compared between pileup scenarios with Common/scripts/pileupScaling.py"""
+    process.ModuleCostMonitor = cms.Service("ModuleCostMonitor",
+                                            fileName = cms.untracked.string(fileName)
+                                            )
+    process.MessageLogger.categories.append('ModuleCostMonitor')
+
+    process.load("PhaseTwoAnalysis.Common.CollectionSizeRecorder_cfi")
+    if (inputFormat.lower() == "reco"):
+        process.collectionSizes.candidates = cms.VInputTag("particleFlow", "genParticles", "ak4GenJets")
+        process.collectionSizes.tracks = cms.VInputTag("generalTracks")
+        process.collectionSizes.vertices = "offlinePrimaryVertices"
+    # own path, so that the sizes are recorded before any skim
+    process.benchmarkSizes = cms.Path(process.collectionSizes)
+    if hasattr(process, "schedule") and process.schedule is not None:
+        process.schedule.insert(0, process.benchmarkSizes)
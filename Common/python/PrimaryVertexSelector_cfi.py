@@ -0,0 +1,5 @@
+import FWCore.ParameterSet.Config as cms
+
+primaryVertexSelector = cms.EDProducer('PrimaryVertexSelector',
+        vertices     = cms.InputTag("offlinePrimaryVertices"),
+)
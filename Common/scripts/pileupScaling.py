@@ -0,0 +1,179 @@
+#!/usr/bin/env python
+"""Pileup scaling of the edmFilter and produceNtuples chains.
+
+Runs the chains with benchmark=<json> (see Common/interface/ModuleCostMonitor.h)
+over matched samples at several pileup values and reports, for each module,
+the time per event and the RSS growth at each pileup together with the
+exponent of the time per event vs. the multiplicity of a reference input
+collection (1: linear, 2: quadratic, e.g. an O(N x M) loop over the PF
+candidates and the tracks).
+
+    pileupScaling.py -f RECO -n 200 \\
+        --sample PU0=file:PU0.root --sample PU140=file:PU140.root --sample PU200=file:PU200.root
+
+With --report-only, the summaries already present in the work directory are
+used, e.g. to compare a new set of summaries to an old one with --compare.
+"""
+from __future__ import print_function
+
+import argparse
+import json
+import math
+import os
+import re
+import subprocess
+import sys
+
+chains = {
+    "edmFilter": "edmFilter_cfg.py",
+    "produceNtuples": "produceNtuples_cfg.py",
+}
+referenceCollections = {"pat": "packedPFCandidates", "reco": "particleFlow"}
+
+def configDir():
+    here = os.path.dirname(os.path.abspath(__file__))
+    return os.path.join(here, "..", "..", "NTupler", "scripts")
+
+def pileupOf(name):
+    digits = re.findall(r"\d+", name)
+    if not digits:
+        raise ValueError("no pileup value in sample name " + name)
+    return int(digits[-1])
+
+def summaryFile(workdir, chain, sample):
+    return os.path.join(workdir, "%s_%s.json" % (chain, sample))
+
+def run(chain, sample, files, args):
+    outFile = os.path.join(args.workdir, "%s_%s.root" % (chain, sample))
+    command = ["cmsRun", os.path.join(configDir(), chains[chain]),
+               "inputFormat=" + args.format,
+               "maxEvents=%d" % args.events,
+               "benchmark=" + summaryFile(args.workdir, chain, sample),
+               "outFilename=" + outFile]
+    command += ["inputFiles=" + f for f in files]
+    if chain == "produceNtuples":
+        command += ["nThreads=1"]
+    print("Running", chain, "over", sample)
+    with open(os.path.join(args.workdir, "%s_%s.log" % (chain, sample)), "w") as log:
+        status = subprocess.call(command, stdout=log, stderr=subprocess.STDOUT)
+    if status != 0:
+        sys.exit("%s failed over %s (exit code %d), see the log in %s" % (chain, sample, status, args.workdir))
+    if not args.keep and os.path.exists(outFile):
+        os.remove(outFile)
+
+def exponent(points):
+    """least-squares slope of log(time) vs log(multiplicity)"""
+    points = [(math.log(n), math.log(t)) for n, t in points if n > 0 and t > 0]
+    if len(points) < 2:
+        return None
+    mx = sum(x for x, _ in points) / len(points)
+    my = sum(y for _, y in points) / len(points)
+    sxx = sum((x - mx) ** 2 for x, _ in points)
+    if sxx == 0:
+        return None
+    return sum((x - mx) * (y - my) for x, y in points) / sxx
+
+def load(workdir, chain, samples):
+    summaries = []
+    for sample in samples:
+        name = summaryFile(workdir, chain, sample)
+        if os.path.exists(name):
+            with open(name) as f:
+                summaries.append((sample, json.load(f)))
+    return summaries
+
+def report(chain, summaries, reference, out, csv, previous=None):
+    if not summaries:
+        return {}
+    samples = [s for s, _ in summaries]
+    width = 10 * len(samples)
+    multiplicity = [summary["collections"].get(reference, {}).get("mean", 0.) for _, summary in summaries]
+
+    out.write("\n%s over %s\n" % (chain, ", ".join("%s (%d events)" % (s, summary["events"]) for s, summary in summaries)))
+    out.write("%-32s" % "mean multiplicity" + "".join("%10s" % s for s in samples) + "\n")
+    collections = sorted(set(c for _, summary in summaries for c in summary["collections"]))
+    for c in collections:
+        out.write("%-32s" % c + "".join("%10.1f" % summary["collections"].get(c, {}).get("mean", 0.) for _, summary in summaries) + "\n")
+
+    modules = set(m for _, summary in summaries for m in summary["modules"])
+    def time(summary, module):
+        return summary["modules"].get(module, {}).get("msPerEvent", 0.)
+    last = summaries[-1][1]
+    modules = sorted(modules, key=lambda m: -time(last, m))
+
+    out.write("\n%-32s%-*s%-*s%8s%s\n" % ("module (vs. %s)" % reference, width, "ms/event", width, "RSS growth [MB]", "slope",
+                                        "  (previous)" if previous is not None else ""))
+    slopes = {}
+    totals = [0.] * len(summaries)
+    for m in modules:
+        times = [time(summary, m) for _, summary in summaries]
+        rss = [summary["modules"].get(m, {}).get("rssGrowthMB", 0.) for _, summary in summaries]
+        totals = [t + x for t, x in zip(totals, times)]
+        slope = exponent(zip(multiplicity, times))
+        slopes[m] = slope
+        line = "%-32s" % m[:31] + "".join("%10.3f" % t for t in times) + "".join("%10.1f" % r for r in rss)
+        line += "%8s" % ("%.2f" % slope if slope is not None else "-")
+        if previous is not None and previous.get(m) is not None:
+            line += "  (%.2f)" % previous[m]
+        if slope is not None and slope > 1.2:
+            line += "  superlinear"
+        out.write(line + "\n")
+        csv.write(",".join([chain, m] + ["%s:%g:%g:%g" % (s, n, t, r) for s, n, t, r in zip(samples, multiplicity, times, rss)]) + "\n")
+    slope = exponent(zip(multiplicity, totals))
+    slopes["total"] = slope
+    out.write("%-32s" % "total" + "".join("%10.3f" % t for t in totals) + " " * width
+              + "%8s" % ("%.2f" % slope if slope is not None else "-") + "\n")
+    out.write("%-32s" % "peak RSS [MB]" + "".join("%10.0f" % summary["peakRssMB"] for _, summary in summaries) + "\n")
+    return slopes
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--sample", action="append", default=[], metavar="NAME=FILE[,FILE...]",
+                        help="input files of one pileup scenario, the pileup is the last number of NAME")
+    parser.add_argument("-f", "--format", default="PAT", help="format of the input files (PAT or RECO)")
+    parser.add_argument("-n", "--events", type=int, default=100, help="number of events per sample")
+    parser.add_argument("-c", "--chains", default=",".join(sorted(chains)), help="comma-separated chains to run")
+    parser.add_argument("-w", "--workdir", default="pileupScaling", help="directory of the summaries, logs and report")
+    parser.add_argument("-r", "--reference", default=None,
+                        help="collection of the multiplicity the slopes are computed against (default: the PF candidates)")
+    parser.add_argument("--report-only", action="store_true", help="do not run the chains, report the existing summaries")
+    parser.add_argument("--compare", default=None, metavar="DIR", help="also show the slopes of the summaries in DIR")
+    parser.add_argument("--keep", action="store_true", help="keep the output files of the chains")
+    args = parser.parse_args()
+
+    samples = {}
+    for sample in args.sample:
+        name, _, files = sample.partition("=")
+        samples[name] = [f for f in files.split(",") if f]
+    if args.report_only and not samples:
+        samples = dict((name, []) for name in set(re.sub(r"^[^_]+_|\.json$", "", f)
+                                                   for f in os.listdir(args.workdir) if f.endswith(".json")))
+    if not samples:
+        parser.error("no sample given")
+    order = sorted(samples, key=pileupOf)
+    chainList = [c for c in args.chains.split(",") if c]
+    for c in chainList:
+        if c not in chains:
+            parser.error("unknown chain %s (known: %s)" % (c, ", ".join(sorted(chains))))
+    reference = args.reference or referenceCollections[args.format.lower()]
+
+    if not os.path.isdir(args.workdir):
+        os.makedirs(args.workdir)
+    if not args.report_only:
+        for c in chainList:
+            for sample in order:
+                run(c, sample, samples[sample], args)
+
+    with open(os.path.join(args.workdir, "report.txt"), "w") as out, \
+         open(os.path.join(args.workdir, "scaling.csv"), "w") as csv:
+        csv.write("chain,module,sample:multiplicity:msPerEvent:rssGrowthMB...\n")
+        for c in chainList:
+            previous = None
+            if args.compare:
+                previous = report(c, load(args.compare, c, order), reference, open(os.devnull, "w"), open(os.devnull, "w"))
+            report(c, load(args.workdir, c, order), reference, out, csv, previous)
+    with open(os.path.join(args.workdir, "report.txt")) as f:
+        sys.stdout.write(f.read())
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,66 @@
+import FWCore.ParameterSet.Config as cms
+from FWCore.ParameterSet.VarParsing import VarParsing
+
+options = VarParsing ('python')
+options.register('outFilename', 'KernelSnapshots.root',
+                 VarParsing.multiplicity.singleton,
+                 VarParsing.varType.string,
+                 "Output file name"
+                 )
+options.register('inputFormat', 'PAT',
+                 VarParsing.multiplicity.singleton,
+                 VarParsing.varType.string,
+                 "format of the input files (PAT or RECO)"
+                 )
+options.register('nEvents', 1000,
+                 VarParsing.multiplicity.singleton,
+                 VarParsing.varType.int,
+                 "number of events to record"
+                 )
+options.parseArguments()
+
+process = cms.Process("KernelSnapshots")
+
+# Geometry, for the ME0 matching of the RECO muons
+if (options.inputFormat.lower() == "reco"):
+    process.load('Configuration.Geometry.GeometryExtended2023D17Reco_cff')
+
+# Log settings
+process.load("FWCore.MessageService.MessageLogger_cfi")
+process.MessageLogger.cerr.FwkReport.reportEvery = 100
+
+# Input
+process.maxEvents = cms.untracked.PSet( input = cms.untracked.int32(options.nEvents) )
+
+process.source = cms.Source("PoolSource",
+    fileNames = cms.untracked.vstring(*(
+        '/store/mc/PhaseIITDRSpring17MiniAOD/TTToSemiLepton_TuneCUETP8M1_14TeV-powheg-pythia8/MINIAODSIM/PU200_91X_upgrade2023_realistic_v3-v1/120000/008BFDF2-285E-E711-8055-001E674FC887.root',
+    ))
+)
+if (options.inputFormat.lower() == "reco"):
+    process.source.fileNames = cms.untracked.vstring(*(
+        '/store/mc/PhaseIITDRSpring17DR/TTToSemiLepton_TuneCUETP8M1_14TeV-powheg-pythia8/AODSIM/PU200_91X_upgrade2023_realistic_v3-v1/120000/000CD008-7A58-E711-82DB-1CB72C0A3A61.root',
+    ))
+if options.inputFiles:
+    process.source.fileNames = cms.untracked.vstring(options.inputFiles)
+
+# snapshots
+process.load("PhaseTwoAnalysis.Common.KernelSnapshotRecorder_cfi")
+process.snapshots.recordElectronID = True
+if (options.inputFormat.lower() == "reco"):
+    process.snapshots.pfCands   = "particleFlow"
+    process.snapshots.electrons = "ecalDrivenGsfElectrons"
+    process.snapshots.muons     = "muons"
+    process.snapshots.jets      = "ak4PFJetsCHS"
+    process.snapshots.genParts  = "genParticles"
+    process.snapshots.genJets   = "ak4GenJets"
+    process.snapshots.conversions = "particleFlowEGamma"
+    process.snapshots.recordME0Matches = True
+
+# output
+process.TFileService = cms.Service("TFileService",
+                                   fileName = cms.string(options.outFilename)
+                                   )
+
+# run
+process.p = cms.Path(process.snapshots)
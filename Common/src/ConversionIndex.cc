@@ -0,0 +1,35 @@
+#include "PhaseTwoAnalysis/Common/interface/ConversionIndex.h"
+
+#include "RecoEgamma/EgammaTools/interface/ConversionTools.h"
+
+#include <algorithm>
+
+void
+ConversionIndex::fill(const reco::ConversionCollection & conversions, const math::XYZPoint & beamspot)
+{
+  tracks_.clear();
+  for (const auto & conv : conversions) {
+    // the cuts of ConversionTools::hasMatchedConversion
+    if (!ConversionTools::isGoodConversion(conv, beamspot, 2.0, 1e-6, 0)) continue;
+    for (const auto & track : conv.tracks()) tracks_.emplace_back(track.id(), track.key());
+  }
+  std::sort(tracks_.begin(), tracks_.end());
+  tracks_.erase(std::unique(tracks_.begin(), tracks_.end()), tracks_.end());
+}
+
+bool
+ConversionIndex::contains(const edm::ProductID & id, size_t key) const
+{
+  return std::binary_search(tracks_.begin(), tracks_.end(), std::make_pair(id, key));
+}
+
+bool
+ConversionIndex::hasMatchedConversion(const reco::GsfElectron & ele) const
+{
+  // as in ConversionTools::matchesConversion, the references of the
+  // GsfElectron itself (pat::Electron overrides gsfTrack() when embedding)
+  const reco::GsfTrackRef & gsfTrack = ele.reco::GsfElectron::gsfTrack();
+  if (gsfTrack.isNonnull() && contains(gsfTrack.id(), gsfTrack.key())) return true;
+  const reco::TrackRef & ctfTrack = ele.reco::GsfElectron::closestCtfTrackRef();
+  return ctfTrack.isNonnull() && contains(ctfTrack.id(), ctfTrack.key());
+}
@@ -0,0 +1,112 @@
+#include "PhaseTwoAnalysis/Common/interface/CutFlow.h"
+#include "PhaseTwoAnalysis/Common/interface/LabelSummaryRegistry.h"
+
+#include "FWCore/MessageLogger/interface/MessageLogger.h"
+#include "FWCore/ServiceRegistry/interface/Service.h"
+#include "FWCore/Utilities/interface/Exception.h"
+#include "CommonTools/UtilAlgos/interface/TFileService.h"
+
+#include "TH1.h"
+
+#include <iomanip>
+#include <sstream>
+#include <utility>
+
+namespace {
+
+  struct Summary
+  {
+    std::vector<std::string> cuts;
+    uint64_t objects = 0, passed = 0;
+    std::vector<uint64_t> reached, timed, cumulativeNs;
+  };
+
+  typedef std::pair<std::string, std::string> Key;
+  // by module label and selection
+  LabelSummaryRegistry<Summary, Key> summaries;
+
+  double meanUs(const Summary & summary, size_t c)
+  {
+    return summary.timed[c] > 0 ? summary.cumulativeNs[c]*1e-3/summary.timed[c] : 0.;
+  }
+
+  void write(const std::string & label, const std::string & selection, const Summary & summary)
+  {
+    const size_t nCuts = summary.cuts.size();
+
+    std::ostringstream out;
+    out << "Cut flow of " << label << " " << selection << " over " << summary.objects << " objects\n"
+        << std::setw(24) << "cut" << std::setw(14) << "reached" << std::setw(14) << "failed"
+        << std::setw(12) << "failed %" << std::setw(16) << "us/object\n";
+    for (size_t c = 0; c < nCuts; c++) {
+      // an object skipping a cut would make the next count the larger
+      const uint64_t next = c+1 < nCuts ? summary.reached[c+1] : summary.passed;
+      const uint64_t failed = summary.reached[c] > next ? summary.reached[c] - next : 0;
+      out << std::setw(24) << summary.cuts[c]
+          << std::setw(14) << summary.reached[c]
+          << std::setw(14) << failed
+          << std::setw(12) << std::fixed << std::setprecision(2) << (summary.reached[c] > 0 ? 100.*failed/summary.reached[c] : 0.)
+          << std::setw(15) << std::setprecision(3) << meanUs(summary, c) << "\n";
+    }
+    out << std::setw(24) << "passed" << std::setw(14) << summary.passed;
+    edm::LogInfo("CutFlow") << out.str();
+
+    edm::Service<TFileService> fs;
+    if (!fs.isAvailable()) return;
+    TFileDirectory dir = fs->mkdir("cutflow");
+
+    TH1D *h_reached = dir.make<TH1D>(selection.c_str(), ";;objects reaching the cut", nCuts+1, 0., nCuts+1);
+    TH1D *h_cost = dir.make<TH1D>((selection + "_cost").c_str(), ";;mean cumulative time per object (us)", nCuts, 0., nCuts);
+    for (size_t c = 0; c < nCuts; c++) {
+      h_reached->GetXaxis()->SetBinLabel(c+1, summary.cuts[c].c_str());
+      h_reached->SetBinContent(c+1, summary.reached[c]);
+      h_cost->GetXaxis()->SetBinLabel(c+1, summary.cuts[c].c_str());
+      h_cost->SetBinContent(c+1, meanUs(summary, c));
+    }
+    h_reached->GetXaxis()->SetBinLabel(nCuts+1, "passed");
+    h_reached->SetBinContent(nCuts+1, summary.passed);
+    h_reached->SetEntries(summary.objects);
+    h_cost->SetEntries(summary.timed.empty() ? 0 : summary.timed[0]);
+  }
+
+}
+
+CutFlow::CutFlow(const edm::ParameterSet & iConfig, const std::string & selection, const std::vector<std::string> & cuts) :
+  enabled_(iConfig.getUntrackedParameter<bool>("cutFlow", false)),
+  finished_(false),
+  label_(iConfig.getParameter<std::string>("@module_label")),
+  selection_(selection),
+  cuts_(cuts),
+  sampling_(iConfig.getUntrackedParameter<unsigned int>("cutFlowSampling", 16)),
+  objects_(0),
+  passed_(0),
+  reached_(cuts.size(), 0),
+  timed_(cuts.size(), 0),
+  cumulativeNs_(cuts.size(), 0)
+{
+  if (!enabled_) return;
+  if (sampling_ == 0) throw cms::Exception("Configuration") << label_ << ": cutFlowSampling must be at least 1";
+  summaries.registerInstance(Key(label_, selection_), [&cuts](Summary & summary) {
+      summary.cuts = cuts;
+      summary.reached.assign(cuts.size(), 0);
+      summary.timed.assign(cuts.size(), 0);
+      summary.cumulativeNs.assign(cuts.size(), 0);
+    });
+}
+
+void
+CutFlow::finish()
+{
+  if (!enabled_ || finished_) return;
+  finished_ = true;
+
+  summaries.merge(Key(label_, selection_), [this](Summary & summary) {
+      summary.objects += objects_;
+      summary.passed += passed_;
+      for (size_t c = 0; c < reached_.size(); c++) {
+        summary.reached[c] += reached_[c];
+        summary.timed[c] += timed_[c];
+        summary.cumulativeNs[c] += cumulativeNs_[c];
+      }
+    }, [](const Key & key, const Summary & summary) { write(key.first, key.second, summary); });
+}
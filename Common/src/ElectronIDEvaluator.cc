@@ -0,0 +1,76 @@
+#include "PhaseTwoAnalysis/Common/interface/ElectronIDEvaluator.h"
+
+#include <cmath>
+
+// loose, medium, tight
+const ElectronIDEvaluator::Cuts ElectronIDEvaluator::kCuts[3] = {
+  {0.02992, 0.004119, 0.05176, 6.741, 73.76, 2.5,   -0.01},
+  {0.01609, 0.001766, 0.03130, 7.371, 22.6,  1.325,  0.03},
+  {0.01614, 0.001322, 0.06129, 4.492, 18.26, 1.255,  0.1}};
+
+ElectronIDEvaluator::Variables
+ElectronIDEvaluator::variables(const reco::GsfElectron & ele)
+{
+  Variables vars;
+  vars.scEta = std::abs(ele.superCluster()->eta());
+  vars.sigmaIetaIeta = ele.full5x5_sigmaIetaIeta();
+  vars.dEtaIn = std::abs(ele.deltaEtaSuperClusterTrackAtVtx());
+  vars.dPhiIn = std::abs(ele.deltaPhiSuperClusterTrackAtVtx());
+  vars.hOverE = ele.hcalOverEcal();
+  if (ele.ecalEnergy() == 0) vars.ooEmooP = 999.;
+  else if (!std::isfinite(ele.ecalEnergy())) vars.ooEmooP = 998.;
+  else vars.ooEmooP = std::abs(1.0/ele.ecalEnergy() - ele.eSuperClusterOverP()/ele.ecalEnergy());
+  vars.chargedIsoRel = ele.pfIsolationVariables().sumChargedHadronPt / ele.pt();
+  vars.matchedConversion = false;
+  return vars;
+}
+
+ElectronIDEvaluator::Variables
+ElectronIDEvaluator::variables(const reco::GsfElectron & ele, const ConversionIndex & conversions)
+{
+  Variables vars = variables(ele);
+  // only the barrel cuts use it
+  vars.matchedConversion = (vars.scEta < 1.479 && conversions.hasMatchedConversion(ele));
+  return vars;
+}
+
+unsigned int
+ElectronIDEvaluator::evaluate(const reco::GsfElectron & ele, const ConversionIndex & conversions, double mva,
+                              unsigned int wps, bool cascade)
+{
+  // the conversion veto rejects for all the working points, so it is only
+  // looked up for the electrons passing one of them otherwise
+  const Variables vars = variables(ele);
+  unsigned int passed = evaluate(vars, mva, wps, cascade);
+  if (passed && vars.scEta < 1.479 && conversions.hasMatchedConversion(ele)) passed = 0;
+  return passed;
+}
+
+unsigned int
+ElectronIDEvaluator::evaluate(const Variables & vars, double mva, unsigned int wps, bool cascade)
+{
+  const bool barrel = vars.scEta < 1.479, endcap = vars.scEta >= 1.556;
+  if (!barrel && !endcap) return 0;
+  if (barrel && vars.matchedConversion) return 0;
+
+  unsigned int passed = 0;
+  for (unsigned int w = 0; w < 3; w++) {
+    const unsigned int bit = 1 << w;
+    if (!(wps & bit)) continue;
+    const Cuts & cuts = kCuts[w];
+    bool pass;
+    if (endcap) {
+      pass = mva > cuts.mva;
+    } else {
+      pass = vars.sigmaIetaIeta < cuts.sigmaIetaIeta
+        && vars.dEtaIn < cuts.dEtaIn
+        && vars.dPhiIn < cuts.dPhiIn
+        && vars.hOverE < cuts.hOverE
+        && vars.ooEmooP < cuts.ooEmooP
+        && vars.chargedIsoRel < cuts.chargedIsoRel;
+    }
+    if (pass) passed |= bit;
+    else if (cascade) break;
+  }
+  return passed;
+}
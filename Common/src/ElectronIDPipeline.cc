@@ -0,0 +1,132 @@
+#include "PhaseTwoAnalysis/Common/interface/ElectronIDPipeline.h"
+#include "PhaseTwoAnalysis/Common/interface/LabelSummaryRegistry.h"
+
+#include "FWCore/MessageLogger/interface/MessageLogger.h"
+
+#include <cmath>
+#include <iomanip>
+#include <sstream>
+
+namespace {
+
+  const unsigned int nWPs = 3;
+  const unsigned int wpBits[nWPs] = {ElectronIDEvaluator::kLoose, ElectronIDEvaluator::kMedium, ElectronIDEvaluator::kTight};
+  const char * wpNames[nWPs] = {"loose", "medium", "tight"};
+
+  const char * stageNames[ElectronIDPipeline::nStages] = {
+    "pt", "eta", "acceptance", "barrel cuts", "conversion veto", "HGCal shower", "endcap BDT"};
+
+  struct Summary
+  {
+    uint64_t candidates = 0, accepted = 0;
+    std::vector<uint64_t> rejected = std::vector<uint64_t>(ElectronIDPipeline::nStages, 0);
+    std::vector<uint64_t> passedWPs = std::vector<uint64_t>(nWPs, 0);
+  };
+
+  LabelSummaryRegistry<Summary> summaries;
+
+  void write(const std::string & label, const Summary & summary)
+  {
+    std::ostringstream out;
+    out << "Electron ID stages of " << label << " over " << summary.candidates << " electrons\n"
+        << std::setw(24) << "stage" << std::setw(14) << "rejected" << std::setw(12) << "left\n";
+    uint64_t left = summary.candidates;
+    for (int s = 0; s < ElectronIDPipeline::nStages; s++) {
+      left -= summary.rejected[s];
+      out << std::setw(24) << stageNames[s] << std::setw(14) << summary.rejected[s] << std::setw(12) << left << "\n";
+    }
+    out << std::setw(24) << "accepted" << std::setw(14) << "" << std::setw(12) << summary.accepted;
+    // the working points are not nested
+    for (unsigned int w = 0; w < nWPs; w++)
+      out << "\n" << std::setw(24) << wpNames[w] << std::setw(14) << "" << std::setw(12) << summary.passedWPs[w];
+    edm::LogInfo("ElectronIDPipeline") << out.str();
+  }
+
+}
+
+ElectronIDPipeline::ElectronIDPipeline(const edm::ParameterSet & iConfig, unsigned int wps, bool cascade) :
+  wps_(wps),
+  cascade_(cascade),
+  finished_(false),
+  label_(iConfig.getParameter<std::string>("@module_label")),
+  candidates_(0),
+  accepted_(0),
+  rejected_(nStages, 0),
+  passedWPs_(nWPs, 0)
+{
+  summaries.registerInstance(label_);
+}
+
+void
+ElectronIDPipeline::beginEvent(size_t nElectrons)
+{
+  status_.assign(nElectrons, Status{false, false, 0., 0});
+}
+
+bool
+ElectronIDPipeline::preselect(size_t i, const reco::GsfElectron & ele, const ConversionIndex & conversions)
+{
+  Status & status = status_[i];
+  candidates_++;
+  if (ele.pt() < 10.) {
+    reject(kPt);
+    return false;
+  }
+  if (std::abs(ele.eta()) > 3.) {
+    reject(kEta);
+    return false;
+  }
+  status.preselected = true;
+
+  const ElectronIDEvaluator::Variables vars = ElectronIDEvaluator::variables(ele);
+  status.scEta = vars.scEta;
+  if (vars.scEta >= 1.479 && vars.scEta < 1.556) {
+    reject(kAcceptance);
+    return false;
+  }
+  if (vars.scEta >= 1.556) {
+    status.needsMVA = true;
+    return true;
+  }
+
+  unsigned int passed = ElectronIDEvaluator::evaluate(vars, -1., wps_, cascade_);
+  if (!passed) passed = reject(kBarrelCuts);
+  else if (conversions.hasMatchedConversion(ele)) passed = reject(kConversionVeto);
+  else accept(passed);
+  status.passed = passed;
+  return false;
+}
+
+void
+ElectronIDPipeline::setMVA(size_t i, double mva, bool hasInputs)
+{
+  Status & status = status_[i];
+  ElectronIDEvaluator::Variables vars = ElectronIDEvaluator::Variables();
+  vars.scEta = status.scEta;
+  unsigned int passed = ElectronIDEvaluator::evaluate(vars, mva, wps_, cascade_);
+  if (!passed) passed = reject(hasInputs ? kMVA : kShowerShape);
+  else accept(passed);
+  status.passed = passed;
+}
+
+void
+ElectronIDPipeline::accept(unsigned int passed)
+{
+  accepted_++;
+  for (unsigned int w = 0; w < nWPs; w++)
+    if (passed & wpBits[w]) passedWPs_[w]++;
+}
+
+void
+ElectronIDPipeline::finish()
+{
+  if (finished_) return;
+  finished_ = true;
+
+  summaries.merge(label_, [this](Summary & summary) {
+      summary.candidates += candidates_;
+      summary.accepted += accepted_;
+      for (int s = 0; s < nStages; s++) summary.rejected[s] += rejected_[s];
+      for (unsigned int w = 0; w < nWPs; w++) summary.passedWPs[w] += passedWPs_[w];
+    }, write);
+}
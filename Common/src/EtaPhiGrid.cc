@@ -0,0 +1,97 @@
+#include "PhaseTwoAnalysis/Common/interface/EtaPhiGrid.h"
+
+#include <algorithm>
+
+EtaPhiGrid::EtaPhiGrid(double cellSize, double etaMax) :
+  etaMax_(etaMax)
+{
+  nEta_ = std::max(1, (int)std::ceil(2.*etaMax/cellSize));
+  etaCell_ = 2.*etaMax/nEta_;
+  nPhi_ = std::max(1, (int)std::floor(2.*M_PI/cellSize));
+  phiCell_ = 2.*M_PI/nPhi_;
+  cellStart_.assign(nEta_*nPhi_+1, 0);
+}
+
+void
+EtaPhiGrid::clear()
+{
+  inEta_.clear();
+  inPhi_.clear();
+  inPt_.clear();
+  inIndex_.clear();
+  inCell_.clear();
+}
+
+void
+EtaPhiGrid::add(float eta, float phi, float pt, unsigned int index)
+{
+  if (phi > (float)M_PI) phi -= 2.f*(float)M_PI;
+  else if (phi < -(float)M_PI) phi += 2.f*(float)M_PI;
+  inEta_.push_back(eta);
+  inPhi_.push_back(phi);
+  inPt_.push_back(pt);
+  inIndex_.push_back(index);
+  inCell_.push_back(etaBin(eta)*nPhi_ + phiBin(phi));
+}
+
+void
+EtaPhiGrid::build()
+{
+  const size_t n = inPt_.size();
+  std::fill(cellStart_.begin(), cellStart_.end(), 0);
+  for (size_t i = 0; i < n; i++) cellStart_[inCell_[i]+1]++;
+  for (size_t c = 1; c < cellStart_.size(); c++) cellStart_[c] += cellStart_[c-1];
+
+  eta_.resize(n);
+  phi_.resize(n);
+  pt_.resize(n);
+  index_.resize(n);
+  std::vector<unsigned int> next(cellStart_.begin(), cellStart_.end()-1);
+  for (size_t i = 0; i < n; i++) {
+    unsigned int j = next[inCell_[i]]++;
+    eta_[j] = inEta_[i];
+    phi_[j] = inPhi_[i];
+    pt_[j] = inPt_[i];
+    index_[j] = inIndex_[i];
+  }
+}
+
+double
+EtaPhiGrid::coneSum(double eta, double phi, double coneSize) const
+{
+  double sum = 0.;
+  forEachInCone(eta, phi, coneSize, [&sum](unsigned int, float pt, float) { sum += pt; });
+  return sum;
+}
+
+int
+EtaPhiGrid::etaBin(double eta) const
+{
+  int bin = (int)std::floor((eta + etaMax_)/etaCell_);
+  return std::min(std::max(bin, 0), nEta_-1);
+}
+
+int
+EtaPhiGrid::phiBin(double phi) const
+{
+  int bin = (int)std::floor((phi + M_PI)/phiCell_);
+  return std::min(std::max(bin, 0), nPhi_-1);
+}
+
+void
+EtaPhiGrid::cellRange(double eta, double phi, double coneSize, int & eta0, int & eta1, int & phi0, int & nPhiCells) const
+{
+  eta0 = etaBin(eta - coneSize);
+  eta1 = etaBin(eta + coneSize);
+
+  if (phi > M_PI) phi -= 2.*M_PI;
+  else if (phi < -M_PI) phi += 2.*M_PI;
+  int nSide = (int)std::ceil(coneSize/phiCell_);
+  nPhiCells = 2*nSide + 1;
+  if (nPhiCells >= nPhi_) {
+    phi0 = 0;
+    nPhiCells = nPhi_;
+  } else {
+    phi0 = phiBin(phi) - nSide;
+  }
+}
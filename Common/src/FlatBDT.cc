@@ -0,0 +1,448 @@
+#include "PhaseTwoAnalysis/Common/interface/FlatBDT.h"
+
+#include "FWCore/Utilities/interface/Exception.h"
+
+#include <cctype>
+#include <cstdio>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <sstream>
+
+#include <unistd.h>
+
+namespace {
+
+  // Minimal scanner for the TMVA weights XML: returns the tags one by one
+  // with their attributes, and the text following them (Option values).
+  class WeightsScanner
+  {
+    public:
+      struct Tag
+      {
+        std::string name;
+        std::map<std::string, std::string> attributes;
+        std::string text;
+        bool closing, selfClosing;
+      };
+
+      explicit WeightsScanner(const std::string & content) : xml_(content), pos_(0) {}
+
+      bool next(Tag & tag)
+      {
+        while (true) {
+          pos_ = xml_.find('<', pos_);
+          if (pos_ == std::string::npos) return false;
+          if (xml_.compare(pos_, 4, "<!--") == 0) {
+            pos_ = xml_.find("-->", pos_);
+            if (pos_ == std::string::npos) return false;
+            continue;
+          }
+          if (xml_[pos_+1] == '?' || xml_[pos_+1] == '!') {
+            pos_ = xml_.find('>', pos_);
+            if (pos_ == std::string::npos) return false;
+            continue;
+          }
+          break;
+        }
+        size_t end = xml_.find('>', pos_);
+        if (end == std::string::npos) return false;
+
+        tag.attributes.clear();
+        tag.text.clear();
+        tag.closing = (xml_[pos_+1] == '/');
+        tag.selfClosing = (xml_[end-1] == '/');
+        size_t i = pos_ + (tag.closing ? 2 : 1);
+        size_t stop = tag.selfClosing ? end-1 : end;
+        size_t nameEnd = i;
+        while (nameEnd < stop && !isspace(xml_[nameEnd])) nameEnd++;
+        tag.name = xml_.substr(i, nameEnd-i);
+
+        i = nameEnd;
+        while (i < stop) {
+          while (i < stop && isspace(xml_[i])) i++;
+          size_t eq = xml_.find('=', i);
+          if (eq == std::string::npos || eq >= stop) break;
+          std::string key = xml_.substr(i, eq-i);
+          while (!key.empty() && isspace(key[key.size()-1])) key.erase(key.size()-1);
+          size_t open = xml_.find('"', eq);
+          size_t close = (open == std::string::npos) ? open : xml_.find('"', open+1);
+          if (close == std::string::npos || close >= stop) break;
+          tag.attributes[key] = xml_.substr(open+1, close-open-1);
+          i = close+1;
+        }
+
+        pos_ = end+1;
+        if (!tag.closing && !tag.selfClosing) {
+          size_t textEnd = xml_.find('<', pos_);
+          if (textEnd != std::string::npos) tag.text = xml_.substr(pos_, textEnd-pos_);
+        }
+        return true;
+      }
+
+    private:
+      const std::string & xml_;
+      size_t pos_;
+  };
+
+  // node as written in the weights file, before flattening
+  struct RawNode
+  {
+    int var, cType, nType, nCoef;
+    float cut, purity, res;
+    int child[2];
+  };
+
+  const std::string & attribute(const WeightsScanner::Tag & tag, const std::string & key, const std::string & file)
+  {
+    std::map<std::string, std::string>::const_iterator it = tag.attributes.find(key);
+    if (it == tag.attributes.end())
+      throw cms::Exception("FlatBDT") << "missing attribute " << key << " of <" << tag.name << "> in " << file;
+    return it->second;
+  }
+
+  std::string readFile(const std::string & file)
+  {
+    std::ifstream in(file.c_str(), std::ios::in | std::ios::binary);
+    if (!in)
+      throw cms::Exception("FlatBDT") << "cannot open BDT weights file " << file;
+    std::stringstream buffer;
+    buffer << in.rdbuf();
+    return buffer.str();
+  }
+
+  // FNV-1a, to tie a binary cache to the XML it was made from
+  uint64_t contentHash(const std::string & content)
+  {
+    uint64_t hash = 14695981039346656037ULL;
+    for (size_t i = 0; i < content.size(); i++) {
+      hash ^= (unsigned char)content[i];
+      hash *= 1099511628211ULL;
+    }
+    return hash;
+  }
+
+  const uint32_t kCacheMagic = 0x54444246; // "FBDT"
+  const uint32_t kCacheVersion = 1;
+
+  template <typename T>
+  void writePod(std::ofstream & out, const T & value)
+  {
+    out.write(reinterpret_cast<const char *>(&value), sizeof(T));
+  }
+  template <typename T>
+  void writeVector(std::ofstream & out, const std::vector<T> & values)
+  {
+    writePod(out, (uint64_t)values.size());
+    if (!values.empty()) out.write(reinterpret_cast<const char *>(values.data()), values.size()*sizeof(T));
+  }
+
+  template <typename T>
+  bool readPod(std::ifstream & in, T & value)
+  {
+    return (bool)in.read(reinterpret_cast<char *>(&value), sizeof(T));
+  }
+  template <typename T>
+  bool readVector(std::ifstream & in, std::vector<T> & values, uint64_t maxSize)
+  {
+    uint64_t n;
+    if (!readPod(in, n) || n > maxSize) return false;
+    values.resize(n);
+    return n == 0 || (bool)in.read(reinterpret_cast<char *>(values.data()), n*sizeof(T));
+  }
+
+  std::string trim(const std::string & s)
+  {
+    size_t b = s.find_first_not_of(" \t\n\r");
+    if (b == std::string::npos) return "";
+    size_t e = s.find_last_not_of(" \t\n\r");
+    return s.substr(b, e-b+1);
+  }
+
+}
+
+FlatBDT::FlatBDT() :
+  gradBoost_(false),
+  sumWeights_(0.)
+{
+}
+
+FlatBDT::FlatBDT(const std::string & weightsFile) :
+  file_(weightsFile),
+  gradBoost_(false),
+  sumWeights_(0.)
+{
+  parse(readFile(weightsFile));
+}
+
+std::shared_ptr<const FlatBDT>
+FlatBDT::get(const std::string & weightsFile)
+{
+  static std::mutex mutex;
+  static std::map<std::string, std::weak_ptr<const FlatBDT>> loaded;
+
+  std::lock_guard<std::mutex> guard(mutex);
+  std::shared_ptr<const FlatBDT> bdt = loaded[weightsFile].lock();
+  if (bdt) return bdt;
+
+  const std::string content = readFile(weightsFile);
+  const uint64_t hash = contentHash(content);
+  const std::string cacheFile = weightsFile + ".bin";
+  std::shared_ptr<FlatBDT> fresh(new FlatBDT());
+  fresh->file_ = weightsFile;
+  if (!fresh->readCache(cacheFile, hash)) {
+    fresh.reset(new FlatBDT());
+    fresh->file_ = weightsFile;
+    fresh->parse(content);
+    fresh->writeCache(cacheFile, hash);
+  }
+  loaded[weightsFile] = fresh;
+  return fresh;
+}
+
+std::shared_ptr<const FlatBDT>
+FlatBDT::get(const std::string & weightsFile, const std::vector<std::string> & variables)
+{
+  std::shared_ptr<const FlatBDT> bdt = get(weightsFile);
+  bdt->checkVariables(variables);
+  return bdt;
+}
+
+bool
+FlatBDT::readCache(const std::string & cacheFile, uint64_t hash)
+{
+  std::ifstream in(cacheFile.c_str(), std::ios::in | std::ios::binary);
+  if (!in) return false;
+
+  uint32_t magic, version;
+  uint64_t storedHash;
+  if (!readPod(in, magic) || magic != kCacheMagic) return false;
+  if (!readPod(in, version) || version != kCacheVersion) return false;
+  if (!readPod(in, storedHash) || storedHash != hash) return false;
+
+  uint8_t grad;
+  uint64_t nVar;
+  if (!readPod(in, grad) || !readPod(in, nVar) || nVar > 10000) return false;
+  gradBoost_ = (grad != 0);
+  variables_.resize(nVar);
+  for (size_t i = 0; i < nVar; i++) {
+    std::vector<char> name;
+    if (!readVector(in, name, 100000)) return false;
+    variables_[i].assign(name.begin(), name.end());
+  }
+  if (!readVector(in, nodes_, 100000000)) return false;
+  if (!readVector(in, treeRoot_, 10000000)) return false;
+  if (!readVector(in, treeWeight_, 10000000)) return false;
+  if (!readPod(in, sumWeights_)) return false;
+
+  // sanity checks, so that a corrupted cache cannot send evaluate() astray
+  if (treeRoot_.empty() || treeRoot_.size() != treeWeight_.size()) return false;
+  for (size_t t = 0; t < treeRoot_.size(); t++)
+    if (treeRoot_[t] < 0 || treeRoot_[t] >= (int)nodes_.size()) return false;
+  for (size_t k = 0; k < nodes_.size(); k++) {
+    if (nodes_[k].var < 0) continue;
+    if (nodes_[k].var >= (int)nVar) return false;
+    if (nodes_[k].right <= (int)k || nodes_[k].right >= (int)nodes_.size() || k+1 >= nodes_.size()) return false;
+  }
+  return true;
+}
+
+void
+FlatBDT::writeCache(const std::string & cacheFile, uint64_t hash) const
+{
+  // written under a temporary name and renamed, so that concurrent jobs
+  // never read a partial file; silently skipped in read-only areas
+  std::ostringstream tmpName;
+  tmpName << cacheFile << ".tmp." << getpid();
+  const std::string tmpFile = tmpName.str();
+  {
+    std::ofstream out(tmpFile.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!out) return;
+    writePod(out, kCacheMagic);
+    writePod(out, kCacheVersion);
+    writePod(out, hash);
+    writePod(out, (uint8_t)(gradBoost_ ? 1 : 0));
+    writePod(out, (uint64_t)variables_.size());
+    for (size_t i = 0; i < variables_.size(); i++)
+      writeVector(out, std::vector<char>(variables_[i].begin(), variables_[i].end()));
+    writeVector(out, nodes_);
+    writeVector(out, treeRoot_);
+    writeVector(out, treeWeight_);
+    writePod(out, sumWeights_);
+    if (!out) {
+      out.close();
+      std::remove(tmpFile.c_str());
+      return;
+    }
+  }
+  if (std::rename(tmpFile.c_str(), cacheFile.c_str()) != 0) std::remove(tmpFile.c_str());
+}
+
+void
+FlatBDT::parse(const std::string & content)
+{
+  const std::string & weightsFile = file_;
+  std::string boostType = "AdaBoost";
+  bool useYesNoLeaf = true;
+  std::vector<RawNode> raw;
+  std::vector<int> stack;
+  double boostWeight = 0.;
+
+  // depth-first flattening of one tree, cType folded into the child order
+  struct Flattener
+  {
+    const std::vector<RawNode> & raw;
+    std::vector<Node> & nodes;
+    bool gradBoost, useYesNoLeaf;
+    const std::string & file;
+
+    int add(int i)
+    {
+      const RawNode & r = raw[i];
+      int index = nodes.size();
+      nodes.push_back(Node());
+      if (r.nType != 0) {
+        nodes[index].var = -1;
+        nodes[index].right = -1;
+        nodes[index].cut = gradBoost ? r.res : (useYesNoLeaf ? (float)r.nType : r.purity);
+        return index;
+      }
+      if (r.child[0] < 0 || r.child[1] < 0)
+        throw cms::Exception("FlatBDT") << "internal node without two daughters in " << file;
+      nodes[index].var = r.var;
+      nodes[index].cut = r.cut;
+      // TMVA goes right if (x >= cut) == (cType == 1)
+      int goRight = (r.cType == 1) ? r.child[1] : r.child[0];
+      int goLeft  = (r.cType == 1) ? r.child[0] : r.child[1];
+      add(goLeft);
+      int right = add(goRight);
+      nodes[index].right = right;
+      return index;
+    }
+  };
+
+  WeightsScanner scanner(content);
+  WeightsScanner::Tag tag;
+  while (scanner.next(tag)) {
+    if (tag.closing) {
+      if (tag.name == "Node") {
+        if (stack.empty()) throw cms::Exception("FlatBDT") << "unbalanced <Node> in " << weightsFile;
+        stack.pop_back();
+      } else if (tag.name == "BinaryTree") {
+        if (raw.empty()) throw cms::Exception("FlatBDT") << "empty tree in " << weightsFile;
+        Flattener flattener = {raw, nodes_, gradBoost_, useYesNoLeaf, file_};
+        treeRoot_.push_back(flattener.add(0));
+        treeWeight_.push_back(boostWeight);
+        sumWeights_ += boostWeight;
+      }
+      continue;
+    }
+
+    if (tag.name == "Option") {
+      const std::string & name = attribute(tag, "name", weightsFile);
+      if (name == "BoostType") boostType = trim(tag.text);
+      else if (name == "UseYesNoLeaf") useYesNoLeaf = (trim(tag.text) == "True");
+      else if (name == "UseFisherCuts" && trim(tag.text) == "True")
+        throw cms::Exception("FlatBDT") << "Fisher cuts are not supported (" << weightsFile << ")";
+    } else if (tag.name == "Variable") {
+      variables_.push_back(attribute(tag, "Expression", weightsFile));
+    } else if (tag.name == "Transformations") {
+      if (std::atoi(attribute(tag, "NTransformations", weightsFile).c_str()) != 0)
+        throw cms::Exception("FlatBDT") << "input variable transformations are not supported (" << weightsFile << ")";
+    } else if (tag.name == "Weights") {
+      if (std::atoi(attribute(tag, "AnalysisType", weightsFile).c_str()) != 0)
+        throw cms::Exception("FlatBDT") << "only classification BDTs are supported (" << weightsFile << ")";
+      if (boostType == "Grad") gradBoost_ = true;
+      else if (boostType != "AdaBoost" && boostType != "RealAdaBoost" && boostType != "Bagging")
+        throw cms::Exception("FlatBDT") << "unsupported BoostType " << boostType << " in " << weightsFile;
+    } else if (tag.name == "BinaryTree") {
+      raw.clear();
+      stack.clear();
+      boostWeight = std::strtod(attribute(tag, "boostWeight", weightsFile).c_str(), 0);
+    } else if (tag.name == "Node") {
+      RawNode node;
+      node.var    = std::atoi(attribute(tag, "IVar", weightsFile).c_str());
+      node.cType  = std::atoi(attribute(tag, "cType", weightsFile).c_str());
+      node.nType  = std::atoi(attribute(tag, "nType", weightsFile).c_str());
+      node.nCoef  = std::atoi(attribute(tag, "NCoef", weightsFile).c_str());
+      node.cut    = std::strtof(attribute(tag, "Cut", weightsFile).c_str(), 0);
+      node.purity = std::strtof(attribute(tag, "purity", weightsFile).c_str(), 0);
+      node.res    = std::strtof(attribute(tag, "res", weightsFile).c_str(), 0);
+      node.child[0] = node.child[1] = -1;
+      if (node.nCoef > 0)
+        throw cms::Exception("FlatBDT") << "Fisher cuts are not supported (" << weightsFile << ")";
+      if (node.nType == 0 && (node.var < 0 || node.var >= (int)variables_.size()))
+        throw cms::Exception("FlatBDT") << "invalid variable index " << node.var << " in " << weightsFile;
+
+      int index = raw.size();
+      raw.push_back(node);
+      if (!stack.empty()) {
+        const std::string & pos = attribute(tag, "pos", weightsFile);
+        raw[stack.back()].child[pos == "r" ? 1 : 0] = index;
+      } else if (index != 0) {
+        throw cms::Exception("FlatBDT") << "several root nodes in one tree of " << weightsFile;
+      }
+      if (!tag.selfClosing) stack.push_back(index);
+    }
+  }
+
+  if (treeRoot_.empty())
+    throw cms::Exception("FlatBDT") << "no trees found in " << weightsFile;
+}
+
+FlatBDT::FlatBDT(const std::string & weightsFile, const std::vector<std::string> & variables) :
+  FlatBDT(weightsFile)
+{
+  checkVariables(variables);
+}
+
+void
+FlatBDT::checkVariables(const std::vector<std::string> & variables) const
+{
+  if (variables.size() != variables_.size())
+    throw cms::Exception("FlatBDT") << file_ << " has " << variables_.size() << " input variables, " << variables.size() << " expected";
+  for (size_t i = 0; i < variables.size(); i++) {
+    std::string expression = variables[i];
+    size_t def = expression.find(":=");
+    if (def != std::string::npos) expression = expression.substr(def+2);
+    expression = trim(expression);
+    if (expression != variables_[i])
+      throw cms::Exception("FlatBDT") << "input variable " << i << " of " << file_ << " is " << variables_[i] << ", expected " << expression;
+  }
+}
+
+double
+FlatBDT::evaluate(const float * features) const
+{
+  double out;
+  evaluate(features, 1, &out);
+  return out;
+}
+
+void
+FlatBDT::evaluate(const float * features, size_t n, double * out) const
+{
+  const size_t nVar = variables_.size();
+  const Node * nodes = nodes_.data();
+  for (size_t i = 0; i < n; i++) out[i] = 0.;
+
+  for (size_t t = 0; t < treeRoot_.size(); t++) {
+    const int root = treeRoot_[t];
+    const double weight = gradBoost_ ? 1. : treeWeight_[t];
+    const float * x = features;
+    for (size_t i = 0; i < n; i++, x += nVar) {
+      int k = root;
+      while (nodes[k].var >= 0)
+        k = (x[nodes[k].var] >= nodes[k].cut) ? nodes[k].right : k+1;
+      out[i] += weight * nodes[k].cut;
+    }
+  }
+
+  for (size_t i = 0; i < n; i++) {
+    if (gradBoost_) out[i] = 2.0/(1.0+std::exp(-2.0*out[i]))-1.0;
+    else out[i] = (sumWeights_ > std::numeric_limits<double>::epsilon()) ? out[i]/sumWeights_ : 0.;
+  }
+}
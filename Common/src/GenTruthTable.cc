@@ -0,0 +1,14 @@
+#include "PhaseTwoAnalysis/Common/interface/GenTruthTable.h"
+
+#include <cstdlib>
+
+void
+GenTruthTable::add(size_t index, const reco::Candidate & particle)
+{
+  const int absPdgId = std::abs(particle.pdgId());
+  if (absPdgId != 11 && absPdgId != 13) return;
+
+  Lepton lepton = {index, particle.pdgId(), particle.status(),
+                   (float)particle.pt(), (float)particle.eta(), (float)particle.phi()};
+  leptons_.push_back(lepton);
+}
@@ -0,0 +1,47 @@
+#include "PhaseTwoAnalysis/Common/interface/HistogramRegistry.h"
+
+#include "FWCore/ServiceRegistry/interface/Service.h"
+#include "FWCore/Utilities/interface/Exception.h"
+#include "CommonTools/UtilAlgos/interface/TFileService.h"
+
+HistogramRegistry::HistogramRegistry(const std::vector<HistogramSpec> & specs)
+{
+  edm::Service<TFileService> fs;
+  for (size_t i = 0; i < specs.size(); i++) {
+    const HistogramSpec & spec = specs[i];
+    if (spec.id != int(i))
+      throw cms::Exception("LogicError") << "HistogramRegistry: histogram " << spec.name << " has id " << spec.id
+                                         << " but is at position " << i << " of the booking table";
+
+    TH1D *h = fs->make<TH1D>(spec.name.c_str(), spec.title.c_str(), spec.nbins, spec.xmin, spec.xmax);
+    if (!spec.binLabels.empty()) {
+      h->SetOption("bar");
+      h->SetBarWidth(0.75);
+      h->SetBarOffset(0.125);
+      for (size_t b = 0; b < spec.binLabels.size(); b++)
+        h->GetXaxis()->SetBinLabel(b+1, spec.binLabels[b].c_str());
+    }
+    hists_.push_back(h);
+  }
+}
+
+HistogramRegistry::Local::Local(const HistogramRegistry & registry)
+{
+  std::lock_guard<std::mutex> lock(registry.mutex_);
+  for (const TH1D *h : registry.hists_) {
+    TH1D *copy = static_cast<TH1D *>(h->Clone());
+    copy->SetDirectory(nullptr);
+    copy->Reset();
+    hists_.emplace_back(copy);
+  }
+}
+
+void
+HistogramRegistry::merge(Local & local) const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (size_t i = 0; i < hists_.size(); i++) {
+    hists_[i]->Add(local.hists_[i].get());
+    local.hists_[i]->Reset();
+  }
+}
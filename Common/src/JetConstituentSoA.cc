@@ -0,0 +1,40 @@
+#include "PhaseTwoAnalysis/Common/interface/JetConstituentSoA.h"
+#include "PhaseTwoAnalysis/Common/interface/DeltaRKernels.h"
+
+void
+JetConstituentSoA::clear()
+{
+  jetEta_.clear();
+  jetPhi_.clear();
+  jetBegin_.clear();
+  eta_.clear();
+  phi_.clear();
+  pt_.clear();
+}
+
+void
+JetConstituentSoA::addJet(float eta, float phi, const float *eta_c, const float *phi_c, const float *pt_c, size_t n)
+{
+  if (jetBegin_.empty()) jetBegin_.push_back(0);
+  jetEta_.push_back(eta);
+  jetPhi_.push_back(phi);
+  eta_.insert(eta_.end(), eta_c, eta_c + n);
+  phi_.insert(phi_.end(), phi_c, phi_c + n);
+  pt_.insert(pt_.end(), pt_c, pt_c + n);
+  jetBegin_.push_back(pt_.size());
+}
+
+double
+JetConstituentSoA::coneSum(double eta, double phi, double jetDR, double dRMin, double dRMax) const
+{
+  const float feta = eta, fphi = phi;
+  const float jetDR2 = jetDR*jetDR;
+
+  double sum = 0.;
+  for (size_t j = 0; j < jetEta_.size(); j++) {
+    if (drkernels::deltaR2(feta, fphi, jetEta_[j], jetPhi_[j]) > jetDR2) continue;
+    const unsigned int begin = jetBegin_[j], n = jetBegin_[j+1] - begin;
+    sum += drkernels::coneSum(feta, fphi, eta_.data() + begin, phi_.data() + begin, pt_.data() + begin, n, dRMin, dRMax);
+  }
+  return sum;
+}
@@ -0,0 +1,133 @@
+#include "PhaseTwoAnalysis/Common/interface/KernelSnapshot.h"
+
+#include "FWCore/Utilities/interface/Exception.h"
+
+#include "TFile.h"
+#include "TTree.h"
+
+#include <deque>
+#include <memory>
+#include <utility>
+
+namespace {
+
+  // the float arrays of a snapshot, with their branch names
+  template <class E, class F>
+  void forEachArray(E & event, F f)
+  {
+    const std::pair<const char *, decltype(&event.pfCands)> candidates[] = {
+      {"pf", &event.pfCands},
+      {"el", &event.electrons},
+      {"mu", &event.muons},
+      {"jet", &event.jets},
+      {"gl", &event.genLeptons},
+      {"gj", &event.genJets},
+      {"gc", &event.genJetConstituents}};
+    for (const auto & c : candidates) {
+      f(std::string(c.first) + "_eta", c.second->eta);
+      f(std::string(c.first) + "_phi", c.second->phi);
+      f(std::string(c.first) + "_pt",  c.second->pt);
+    }
+  }
+
+  // the float arrays of the ID inputs, absent from older snapshots
+  template <class E, class F>
+  void forEachIDArray(E & event, F f)
+  {
+    const std::pair<const char *, decltype(&event.elMVA)> arrays[] = {
+      {"el_scEta", &event.elScEta},
+      {"el_sieie", &event.elSigmaIetaIeta},
+      {"el_dEtaIn", &event.elDEtaIn},
+      {"el_dPhiIn", &event.elDPhiIn},
+      {"el_hOverE", &event.elHOverE},
+      {"el_ooEmooP", &event.elOoEmooP},
+      {"el_chIsoRel", &event.elChargedIsoRel},
+      {"el_mva", &event.elMVA},
+      {"me0_p", &event.me0P},
+      {"me0_dEta", &event.me0DEta},
+      {"me0_dPhi", &event.me0DPhi},
+      {"me0_dPhiBend", &event.me0DPhiBend}};
+    for (const auto & a : arrays) f(std::string(a.first), *a.second);
+  }
+
+}
+
+void
+kernelsnapshot::Event::clear()
+{
+  pfCands.clear();
+  electrons.clear();
+  muons.clear();
+  jets.clear();
+  genLeptons.clear();
+  genJets.clear();
+  genJetConstituents.clear();
+  genLeptonPdgId.clear();
+  genJetNConstituents.clear();
+  forEachIDArray(*this, [](const std::string &, std::vector<float> & values) { values.clear(); });
+  elMatchedConversion.clear();
+  me0NMatches.clear();
+}
+
+void
+kernelsnapshot::book(TTree * tree, Event & event)
+{
+  tree->Branch("run", &event.run, "run/i");
+  tree->Branch("lumi", &event.lumi, "lumi/i");
+  tree->Branch("event", &event.event, "event/l");
+  forEachArray(event, [tree](const std::string & name, std::vector<float> & values) { tree->Branch(name.c_str(), &values); });
+  tree->Branch("gl_pid", &event.genLeptonPdgId);
+  tree->Branch("gj_nc", &event.genJetNConstituents);
+  forEachIDArray(event, [tree](const std::string & name, std::vector<float> & values) { tree->Branch(name.c_str(), &values); });
+  tree->Branch("el_conv", &event.elMatchedConversion);
+  tree->Branch("me0_n", &event.me0NMatches);
+}
+
+std::vector<kernelsnapshot::Event>
+kernelsnapshot::readAll(const std::string & fileName, long maxEvents, const std::string & treeName)
+{
+  std::unique_ptr<TFile> file(TFile::Open(fileName.c_str()));
+  if (!file || file->IsZombie())
+    throw cms::Exception("KernelSnapshot") << "cannot open " << fileName;
+  TTree *tree = nullptr;
+  file->GetObject(treeName.c_str(), tree);
+  if (!tree)
+    throw cms::Exception("KernelSnapshot") << "no " << treeName << " tree in " << fileName;
+
+  // ROOT reads the vectors through pointers that must outlive the tree
+  Event current;
+  std::deque<std::vector<float> *> addresses;
+  std::vector<int> *pdgIdAddress = &current.genLeptonPdgId;
+  std::vector<unsigned int> *nConstituentsAddress = &current.genJetNConstituents;
+  std::vector<int> *conversionAddress = &current.elMatchedConversion;
+  std::vector<unsigned int> *nMatchesAddress = &current.me0NMatches;
+  auto check = [tree](const std::string & name, int status) {
+    if (status < 0) throw cms::Exception("KernelSnapshot") << "cannot read the " << name << " branch of " << tree->GetName();
+  };
+  check("run", tree->SetBranchAddress("run", &current.run));
+  check("lumi", tree->SetBranchAddress("lumi", &current.lumi));
+  check("event", tree->SetBranchAddress("event", &current.event));
+  forEachArray(current, [tree, &addresses, &check](const std::string & name, std::vector<float> & values) {
+      addresses.push_back(&values);
+      check(name, tree->SetBranchAddress(name.c_str(), &addresses.back()));
+    });
+  check("gl_pid", tree->SetBranchAddress("gl_pid", &pdgIdAddress));
+  check("gj_nc", tree->SetBranchAddress("gj_nc", &nConstituentsAddress));
+  forEachIDArray(current, [tree, &addresses, &check](const std::string & name, std::vector<float> & values) {
+      if (!tree->GetBranch(name.c_str())) return;
+      addresses.push_back(&values);
+      check(name, tree->SetBranchAddress(name.c_str(), &addresses.back()));
+    });
+  if (tree->GetBranch("el_conv")) check("el_conv", tree->SetBranchAddress("el_conv", &conversionAddress));
+  if (tree->GetBranch("me0_n")) check("me0_n", tree->SetBranchAddress("me0_n", &nMatchesAddress));
+
+  std::vector<Event> events;
+  const long n = (maxEvents >= 0 && maxEvents < tree->GetEntries()) ? maxEvents : tree->GetEntries();
+  events.reserve(n);
+  for (long i = 0; i < n; i++) {
+    tree->GetEntry(i);
+    events.push_back(current);
+  }
+  tree->ResetBranchAddresses();
+  return events;
+}
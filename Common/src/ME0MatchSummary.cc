@@ -0,0 +1,81 @@
+#include "PhaseTwoAnalysis/Common/interface/ME0MatchSummary.h"
+
+#include "DataFormats/GEMRecHit/interface/ME0Segment.h"
+#include "DataFormats/GeometryVector/interface/GlobalPoint.h"
+#include "DataFormats/GeometryVector/interface/LocalPoint.h"
+#include "DataFormats/GeometryVector/interface/LocalVector.h"
+#include "DataFormats/MuonReco/interface/Muon.h"
+#include "Geometry/GEMGeometry/interface/ME0Geometry.h"
+
+#include <algorithm>
+#include <cmath>
+
+const ME0MatchSummary::WorkingPoint ME0MatchSummary::kLoose = {0.077, 0.056, 0.0096};
+const ME0MatchSummary::WorkingPoint ME0MatchSummary::kTight = {0.048, 0.032, 0.0041};
+
+void
+ME0ChamberCache::setGeometry(const ME0Geometry * geometry)
+{
+  geometry_ = geometry;
+  chambers_.clear();
+}
+
+const ME0Chamber *
+ME0ChamberCache::chamber(const DetId & id)
+{
+  auto it = chambers_.find(id.rawId());
+  if (it == chambers_.end()) it = chambers_.emplace(id.rawId(), geometry_->chamber(id)).first;
+  return it->second;
+}
+
+void
+ME0MatchSummary::fill(const reco::Muon & muon, ME0ChamberCache & chambers, bool storedSegmentBend)
+{
+  p_ = muon.p();
+  matches_.clear();
+  if (!muon.isME0Muon()) return;
+
+  for (const auto & chamber : muon.matches()) {
+    if (chamber.detector() != 5) continue;
+    if (chamber.me0Matches.empty()) continue;
+
+    const ME0Chamber * me0chamber = chambers.chamber(chamber.id);
+    LocalPoint trk_loc_coord(chamber.x, chamber.y, 0);
+    LocalVector trk_loc_vec(chamber.dXdZ, chamber.dYdZ, 1);
+    GlobalPoint trk_glb_coord = me0chamber->toGlobal(trk_loc_coord);
+    double trackDPhi = me0chamber->computeDeltaPhi(trk_loc_coord, trk_loc_vec);
+
+    for (const auto & segment : chamber.me0Matches) {
+      LocalPoint seg_loc_coord(segment.x, segment.y, 0);
+      GlobalPoint seg_glb_coord = me0chamber->toGlobal(seg_loc_coord);
+      double segDPhi;
+      if (storedSegmentBend) {
+        segDPhi = segment.me0SegmentRef->deltaPhi();
+      } else {
+        LocalVector seg_loc_vec(segment.dXdZ, segment.dYdZ, 1);
+        segDPhi = me0chamber->computeDeltaPhi(seg_loc_coord, seg_loc_vec);
+      }
+
+      matches_.push_back({std::abs(trk_glb_coord.eta() - seg_glb_coord.eta()),
+                          std::abs(trk_glb_coord.phi() - seg_glb_coord.phi()),
+                          std::abs(segDPhi - trackDPhi)});
+    }
+  }
+}
+
+bool
+ME0MatchSummary::passes(const WorkingPoint & wp) const
+{
+  if (matches_.empty()) return false;
+  return passes(wp.dEta,
+                std::min(std::max(1.2/p_,1.2/100),wp.dPhiMax),
+                std::min(std::max(0.2/p_,0.2/100),wp.dPhiBendMax));
+}
+
+bool
+ME0MatchSummary::passes(double dEtaCut, double dPhiCut, double dPhiBendCut) const
+{
+  for (const auto & match : matches_)
+    if (match.deltaEta < dEtaCut && match.deltaPhi < dPhiCut && match.deltaPhiBend < dPhiBendCut) return true;
+  return false;
+}
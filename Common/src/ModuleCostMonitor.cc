@@ -0,0 +1,148 @@
+#include "PhaseTwoAnalysis/Common/interface/ModuleCostMonitor.h"
+
+#include "FWCore/MessageLogger/interface/MessageLogger.h"
+#include "FWCore/ParameterSet/interface/ConfigurationDescriptions.h"
+#include "FWCore/ParameterSet/interface/ParameterSetDescription.h"
+#include "FWCore/ServiceRegistry/interface/ActivityRegistry.h"
+#include "FWCore/ServiceRegistry/interface/ModuleCallingContext.h"
+#include "FWCore/ServiceRegistry/interface/StreamContext.h"
+#include "FWCore/Utilities/interface/Exception.h"
+#include "DataFormats/Provenance/interface/ModuleDescription.h"
+
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <vector>
+
+namespace {
+
+  struct Call
+  {
+    std::chrono::steady_clock::time_point start;
+    int64_t rssKB;
+  };
+
+  // calls in progress on this thread, innermost last
+  thread_local std::vector<Call> calls;
+
+  int64_t residentKB()
+  {
+    static const int64_t pageKB = sysconf(_SC_PAGESIZE) / 1024;
+    std::ifstream statm("/proc/self/statm");
+    int64_t size = 0, resident = 0;
+    statm >> size >> resident;
+    return resident * pageKB;
+  }
+
+  int64_t peakResidentKB()
+  {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+  }
+
+}
+
+ModuleCostMonitor::ModuleCostMonitor(const edm::ParameterSet & iConfig, edm::ActivityRegistry & iRegistry) :
+  fileName_(iConfig.getUntrackedParameter<std::string>("fileName")),
+  events_(0)
+{
+  iRegistry.watchPreModuleEvent(this, &ModuleCostMonitor::preModuleEvent);
+  iRegistry.watchPostModuleEvent(this, &ModuleCostMonitor::postModuleEvent);
+  iRegistry.watchPostEvent(this, &ModuleCostMonitor::postEvent);
+  iRegistry.watchPostEndJob(this, &ModuleCostMonitor::postEndJob);
+}
+
+void
+ModuleCostMonitor::fillDescriptions(edm::ConfigurationDescriptions & descriptions)
+{
+  edm::ParameterSetDescription desc;
+  desc.addUntracked<std::string>("fileName", "ModuleCosts.json");
+  descriptions.add("ModuleCostMonitor", desc);
+}
+
+void
+ModuleCostMonitor::addCollectionSize(const std::string & name, size_t size)
+{
+  std::lock_guard<std::mutex> guard(mutex_);
+  Collection & collection = collections_[name];
+  collection.entries++;
+  collection.sum += size;
+  collection.max = std::max<uint64_t>(collection.max, size);
+}
+
+void
+ModuleCostMonitor::preModuleEvent(const edm::StreamContext &, const edm::ModuleCallingContext &)
+{
+  // the /proc read is kept out of the timed interval: the RSS is read before
+  // the start time here, and after the stop time in postModuleEvent
+  const int64_t rssKB = residentKB();
+  calls.push_back(Call{std::chrono::steady_clock::now(), rssKB});
+}
+
+void
+ModuleCostMonitor::postModuleEvent(const edm::StreamContext &, const edm::ModuleCallingContext & mcc)
+{
+  const auto stop = std::chrono::steady_clock::now();
+  const int64_t rssKB = residentKB();
+  const Call call = calls.back();
+  calls.pop_back();
+  const uint64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(stop - call.start).count();
+
+  std::lock_guard<std::mutex> guard(mutex_);
+  Module & module = modules_[mcc.moduleDescription()->moduleLabel()];
+  if (module.type.empty()) module.type = mcc.moduleDescription()->moduleName();
+  module.calls++;
+  module.totalNs += ns;
+  module.maxNs = std::max(module.maxNs, ns);
+  module.rssGrowthKB += rssKB - call.rssKB;
+  module.maxRssKB = std::max(module.maxRssKB, rssKB);
+}
+
+void
+ModuleCostMonitor::postEvent(const edm::StreamContext &)
+{
+  std::lock_guard<std::mutex> guard(mutex_);
+  events_++;
+}
+
+void
+ModuleCostMonitor::postEndJob()
+{
+  std::lock_guard<std::mutex> guard(mutex_);
+  std::ofstream out(fileName_.c_str());
+  if (!out)
+    throw cms::Exception("ModuleCostMonitor") << "cannot write the module costs to " << fileName_;
+
+  const double nEvents = std::max<uint64_t>(events_, 1);
+  out << "{\n  \"events\": " << events_ << ",\n  \"peakRssMB\": " << peakResidentKB() / 1024. << ",\n  \"modules\": {";
+  bool first = true;
+  for (const auto & m : modules_) {
+    const Module & module = m.second;
+    out << (first ? "\n" : ",\n") << "    \"" << m.first << "\": {"
+        << "\"type\": \"" << module.type << "\", "
+        << "\"calls\": " << module.calls << ", "
+        << "\"msPerEvent\": " << module.totalNs * 1e-6 / nEvents << ", "
+        << "\"msPerCall\": " << module.totalNs * 1e-6 / std::max<uint64_t>(module.calls, 1) << ", "
+        << "\"maxMsPerCall\": " << module.maxNs * 1e-6 << ", "
+        << "\"rssGrowthMB\": " << module.rssGrowthKB / 1024. << ", "
+        << "\"maxRssMB\": " << module.maxRssKB / 1024. << "}";
+    first = false;
+  }
+  out << "\n  },\n  \"collections\": {";
+  first = true;
+  for (const auto & c : collections_) {
+    const Collection & collection = c.second;
+    out << (first ? "\n" : ",\n") << "    \"" << c.first << "\": {"
+        << "\"mean\": " << collection.sum / double(std::max<uint64_t>(collection.entries, 1)) << ", "
+        << "\"max\": " << collection.max << "}";
+    first = false;
+  }
+  out << "\n  }\n}\n";
+
+  edm::LogInfo("ModuleCostMonitor") << "Costs of " << modules_.size() << " modules over " << events_
+                                    << " events written to " << fileName_;
+}
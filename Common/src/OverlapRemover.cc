@@ -0,0 +1,45 @@
+#include "PhaseTwoAnalysis/Common/interface/OverlapRemover.h"
+#include "PhaseTwoAnalysis/Common/interface/DeltaRKernels.h"
+
+#include <algorithm>
+#include <numeric>
+
+void
+OverlapRemover::clear()
+{
+  eta_.clear();
+  phi_.clear();
+  pt_.clear();
+}
+
+void
+OverlapRemover::add(float eta, float phi, float pt)
+{
+  eta_.push_back(eta);
+  phi_.push_back(phi);
+  pt_.push_back(pt);
+}
+
+void
+OverlapRemover::build()
+{
+  const size_t n = eta_.size();
+  order_.resize(n);
+  std::iota(order_.begin(), order_.end(), 0);
+  std::sort(order_.begin(), order_.end(), [this](unsigned int a, unsigned int b) { return eta_[a] < eta_[b]; });
+
+  buffer_.resize(n);
+  for (std::vector<float> *column : {&eta_, &phi_, &pt_}) {
+    for (size_t i = 0; i < n; i++) buffer_[i] = (*column)[order_[i]];
+    column->swap(buffer_);
+  }
+}
+
+bool
+OverlapRemover::overlaps(float eta, float phi, float pt) const
+{
+  auto begin = std::lower_bound(eta_.begin(), eta_.end(), eta - dR_);
+  auto end = std::upper_bound(begin, eta_.end(), eta + dR_);
+  const size_t first = begin - eta_.begin(), n = end - begin;
+  return drkernels::anyOverlap(eta, phi, pt, eta_.data() + first, phi_.data() + first, pt_.data() + first, n, dR_, relPt_);
+}
@@ -0,0 +1,129 @@
+#include "PhaseTwoAnalysis/Common/interface/StageTimer.h"
+#include "PhaseTwoAnalysis/Common/interface/LabelSummaryRegistry.h"
+
+#include "FWCore/MessageLogger/interface/MessageLogger.h"
+#include "FWCore/ServiceRegistry/interface/Service.h"
+#include "CommonTools/UtilAlgos/interface/TFileService.h"
+
+#include "TH1.h"
+
+#include <cmath>
+#include <iomanip>
+#include <sstream>
+
+namespace {
+
+  struct Summary
+  {
+    std::vector<std::string> stages;
+    uint64_t events = 0;
+    std::vector<uint64_t> totalNs, calls;
+    std::vector<std::vector<uint64_t>> counts;
+  };
+
+  LabelSummaryRegistry<Summary> summaries;
+
+  void write(const std::string & label, const Summary & summary)
+  {
+    const size_t nStages = summary.stages.size();
+    const double nEvents = std::max<uint64_t>(summary.events, 1);
+
+    std::ostringstream out;
+    out << "Stage timing of " << label << " over " << summary.events << " events\n"
+        << std::setw(24) << "stage" << std::setw(14) << "ms/event" << std::setw(14) << "us/call" << std::setw(12) << "calls\n";
+    uint64_t sumNs = 0;
+    for (size_t s = 0; s < nStages; s++) {
+      sumNs += summary.totalNs[s];
+      out << std::setw(24) << summary.stages[s]
+          << std::setw(14) << std::fixed << std::setprecision(4) << summary.totalNs[s]*1e-6/nEvents
+          << std::setw(14) << std::setprecision(3) << (summary.calls[s] > 0 ? summary.totalNs[s]*1e-3/summary.calls[s] : 0.)
+          << std::setw(12) << summary.calls[s] << "\n";
+    }
+    out << std::setw(24) << "total" << std::setw(14) << std::setprecision(4) << sumNs*1e-6/nEvents;
+    edm::LogInfo("StageTimer") << out.str();
+
+    edm::Service<TFileService> fs;
+    if (!fs.isAvailable()) return;
+    TFileDirectory dir = fs->mkdir("timing");
+
+    TH1D *h_stages = dir.make<TH1D>("stages", ";;mean time per event (ms)", nStages, 0., nStages);
+    for (size_t s = 0; s < nStages; s++) {
+      h_stages->GetXaxis()->SetBinLabel(s+1, summary.stages[s].c_str());
+      h_stages->SetBinContent(s+1, summary.totalNs[s]*1e-6/nEvents);
+    }
+    h_stages->SetEntries(summary.events);
+
+    const int nBins = StageTimer::kBinsPerDecade*StageTimer::kDecades;
+    std::vector<double> edges(nBins+1);
+    for (int b = 0; b <= nBins; b++) edges[b] = StageTimer::kMinMs*std::pow(10., double(b)/StageTimer::kBinsPerDecade);
+    for (size_t s = 0; s <= nStages; s++) {
+      const std::string name = (s < nStages ? summary.stages[s] : std::string("total"));
+      TH1D *h = dir.make<TH1D>(name.c_str(), ";time per event (ms);events", nBins, edges.data());
+      for (int b = 0; b < nBins+2; b++) h->SetBinContent(b, summary.counts[s][b]);
+      h->SetEntries(summary.events);
+    }
+  }
+
+}
+
+StageTimer::StageTimer(const edm::ParameterSet & iConfig, const std::vector<std::string> & stages) :
+  enabled_(iConfig.getUntrackedParameter<bool>("timing", false)),
+  finished_(false),
+  label_(iConfig.getParameter<std::string>("@module_label")),
+  stages_(stages),
+  events_(0),
+  eventNs_(stages.size(), 0),
+  totalNs_(stages.size(), 0),
+  calls_(stages.size(), 0),
+  counts_(stages.size()+1, std::vector<uint64_t>(kBinsPerDecade*kDecades+2, 0))
+{
+  if (!enabled_) return;
+  summaries.registerInstance(label_, [this](Summary & summary) {
+      summary.stages = stages_;
+      summary.totalNs.assign(stages_.size(), 0);
+      summary.calls.assign(stages_.size(), 0);
+      summary.counts = counts_;
+    });
+}
+
+int
+StageTimer::bin(uint64_t ns)
+{
+  if (ns == 0) return 0;
+  double b = std::floor(kBinsPerDecade*std::log10(ns*1e-6/kMinMs));
+  if (b < 0) return 0;
+  if (b >= kBinsPerDecade*kDecades) return kBinsPerDecade*kDecades+1;
+  return int(b)+1;
+}
+
+void
+StageTimer::endEvent()
+{
+  if (!enabled_) return;
+  events_++;
+  uint64_t sum = 0;
+  for (size_t s = 0; s < stages_.size(); s++) {
+    counts_[s][bin(eventNs_[s])]++;
+    totalNs_[s] += eventNs_[s];
+    sum += eventNs_[s];
+    eventNs_[s] = 0;
+  }
+  counts_[stages_.size()][bin(sum)]++;
+}
+
+void
+StageTimer::finish()
+{
+  if (!enabled_ || finished_) return;
+  finished_ = true;
+
+  summaries.merge(label_, [this](Summary & summary) {
+      summary.events += events_;
+      for (size_t s = 0; s < stages_.size(); s++) {
+        summary.totalNs[s] += totalNs_[s];
+        summary.calls[s] += calls_[s];
+      }
+      for (size_t s = 0; s < counts_.size(); s++)
+        for (size_t b = 0; b < counts_[s].size(); b++) summary.counts[s][b] += counts_[s][b];
+    }, write);
+}
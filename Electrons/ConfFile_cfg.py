@@ -22,6 +22,7 @@ process.load("FWCore.MessageService.MessageLogger_cfi")
 process.MessageLogger.cerr.FwkReport.reportEvery = 1000
 process.MessageLogger.cerr.threshold = 'INFO'
 process.MessageLogger.categories.append('MyAna')
+process.MessageLogger.categories.append('ElectronIDPipeline')
 process.MessageLogger.cerr.INFO = cms.untracked.PSet(
         limit = cms.untracked.int32(-1)
 )
@@ -54,10 +55,8 @@ process.load("RecoParticleFlow.PFClusterProducer.particleFlowRecHitHGC_cff")
 
 # jurassic track isolation
 # https://indico.cern.ch/event/27568/contributions/1618615/attachments/499629/690192/080421.Isolation.Update.RecHits.pdf
-process.load("RecoEgamma.EgammaIsolationAlgos.electronTrackIsolationLcone_cfi")
-process.electronTrackIsolationLcone.electronProducer = cms.InputTag("ecalDrivenGsfElectrons")
-process.electronTrackIsolationLcone.intRadiusBarrel = 0.04
-process.electronTrackIsolationLcone.intRadiusEndcap = 0.04
+# (Lcone: electronTrackIsolationLcone with the inner radius 0.04, in one pass over the tracks)
+process.load("PhaseTwoAnalysis.Electrons.electronTrackIsolationCones_cfi")
 
 # producer
 moduleName = "PatElectronFilter"    
@@ -66,7 +65,9 @@ if (options.inputFormat.lower() == "reco"):
 process.electronfilter = cms.EDProducer(moduleName)
 process.load("PhaseTwoAnalysis.Electrons."+moduleName+"_cfi")
 if (options.inputFormat.lower() == "reco"):
-    process.electronfilter.pfCandsNoLep = "puppiNoLep"
+    process.load("PhaseTwoAnalysis.Common.PrimaryVertexSelector_cfi")
+    process.load("PhaseTwoAnalysis.Electrons.RecoElectronIDProducer_cfi")
+    process.recoElectronID.pfCandsNoLep = "puppiNoLep"
 
 process.out = cms.OutputModule("PoolOutputModule",
     outputCommands = cms.untracked.vstring('keep *_*_*_*',
@@ -76,7 +77,7 @@ process.out = cms.OutputModule("PoolOutputModule",
 )
   
 if (options.inputFormat.lower() == "reco"):
-    process.p = cms.Path(process.electronTrackIsolationLcone * process.particleFlowRecHitHGCSeq * process.puSequence * process.electronfilter)
+    process.p = cms.Path(process.electronTrackIsolationCones * process.particleFlowRecHitHGCSeq * process.puSequence * process.primaryVertexSelector * process.recoElectronID * process.electronfilter)
 else:
     process.p = cms.Path(process.electronfilter)
 
@@ -38,6 +38,11 @@ Implementation:
 #include "DataFormats/PatCandidates/interface/Electron.h"
 #include "RecoEgamma/EgammaTools/interface/ConversionTools.h"
 
+#include "PhaseTwoAnalysis/Common/interface/ConversionIndex.h"
+#include "PhaseTwoAnalysis/Common/interface/SelectedObjects.h"
+#include "PhaseTwoAnalysis/Common/interface/CutFlow.h"
+#include "PhaseTwoAnalysis/Common/interface/StageTimer.h"
+
 #include <vector>
 
 //
@@ -56,9 +61,9 @@ class PatElectronFilter : public edm::stream::EDProducer<> {
         virtual void produce(edm::Event&, const edm::EventSetup&) override;
         virtual void endStream() override;
 
-        bool isLooseElec(const pat::Electron & patEl, edm::Handle<reco::ConversionCollection> conversions, const reco::BeamSpot beamspot); 
-        bool isMediumElec(const pat::Electron & patEl, edm::Handle<reco::ConversionCollection> conversions, const reco::BeamSpot beamspot); 
-        bool isTightElec(const pat::Electron & patEl, edm::Handle<reco::ConversionCollection> conversions, const reco::BeamSpot beamspot); 
+        bool isLooseElec(const pat::Electron & patEl, const ConversionIndex & conversions); 
+        bool isMediumElec(const pat::Electron & patEl, const ConversionIndex & conversions); 
+        bool isTightElec(const pat::Electron & patEl, const ConversionIndex & conversions); 
 
         //virtual void beginRun(edm::Run const&, edm::EventSetup const&) override;
         //virtual void endRun(edm::Run const&, edm::EventSetup const&) override;
@@ -70,6 +75,13 @@ class PatElectronFilter : public edm::stream::EDProducer<> {
         edm::EDGetTokenT<std::vector<pat::Electron>> elecsToken_;
         edm::EDGetTokenT<reco::BeamSpot> bsToken_;
         edm::EDGetTokenT<std::vector<reco::Conversion>> convToken_;
+        ConversionIndex conversionIndex_;
+        bool outputPtrs_;
+
+        enum Stage {kInputs = 0, kElectrons, kPut};
+        StageTimer timer_;
+        enum Cut {kPt = 0, kEta, kLoose, kMedium, kTight};
+        CutFlow cutFlow_;
 };
 
 //
@@ -87,14 +99,24 @@ class PatElectronFilter : public edm::stream::EDProducer<> {
 PatElectronFilter::PatElectronFilter(const edm::ParameterSet& iConfig):
     elecsToken_(consumes<std::vector<pat::Electron>>(iConfig.getParameter<edm::InputTag>("electrons"))),
     bsToken_(consumes<reco::BeamSpot>(iConfig.getParameter<edm::InputTag>("beamspot"))),
-    convToken_(consumes<std::vector<reco::Conversion>>(iConfig.getParameter<edm::InputTag>("conversions")))  
+    convToken_(consumes<std::vector<reco::Conversion>>(iConfig.getParameter<edm::InputTag>("conversions"))),
+    outputPtrs_(iConfig.getParameter<bool>("outputPtrs")),
+    timer_(iConfig, {"inputs", "electrons", "put"}),
+    cutFlow_(iConfig, "electrons", {"pt", "eta", "loose", "medium", "tight"})
 {
-    produces<std::vector<pat::Electron>>("LooseElectrons");
-    produces<std::vector<double>>("LooseElectronRelIso");
-    produces<std::vector<pat::Electron>>("MediumElectrons");
-    produces<std::vector<double>>("MediumElectronRelIso");
-    produces<std::vector<pat::Electron>>("TightElectrons");
-    produces<std::vector<double>>("TightElectronRelIso");
+    if (outputPtrs_) {
+      produces<edm::PtrVector<pat::Electron>>("LooseElectrons");
+      produces<edm::PtrVector<pat::Electron>>("MediumElectrons");
+      produces<edm::PtrVector<pat::Electron>>("TightElectrons");
+      produces<edm::ValueMap<double>>("ElectronRelIso");
+    } else {
+      produces<std::vector<pat::Electron>>("LooseElectrons");
+      produces<std::vector<double>>("LooseElectronRelIso");
+      produces<std::vector<pat::Electron>>("MediumElectrons");
+      produces<std::vector<double>>("MediumElectronRelIso");
+      produces<std::vector<pat::Electron>>("TightElectrons");
+      produces<std::vector<double>>("TightElectronRelIso");
+    }
 
 }
 
@@ -117,6 +139,9 @@ PatElectronFilter::~PatElectronFilter()
 PatElectronFilter::produce(edm::Event& iEvent, const edm::EventSetup& iSetup)
 {
     using namespace edm;
+
+    StageTimer::Scope timing(timer_, kInputs);
+
     Handle<std::vector<pat::Electron>> elecs;
     iEvent.getByToken(elecsToken_, elecs);
     Handle<reco::ConversionCollection> conversions;
@@ -124,55 +149,51 @@ PatElectronFilter::produce(edm::Event& iEvent, const edm::EventSetup& iSetup)
     Handle<reco::BeamSpot> bsHandle;
     iEvent.getByToken(bsToken_, bsHandle);
     const reco::BeamSpot &beamspot = *bsHandle.product();  
-    std::unique_ptr<std::vector<pat::Electron>> filteredLooseElectrons;
-    std::unique_ptr<std::vector<double>> filteredLooseElectronRelIso;
-    std::unique_ptr<std::vector<pat::Electron>> filteredMediumElectrons;
-    std::unique_ptr<std::vector<double>> filteredMediumElectronRelIso;
-    std::unique_ptr<std::vector<pat::Electron>> filteredTightElectrons;
-    std::unique_ptr<std::vector<double>> filteredTightElectronRelIso;
-    std::vector<pat::Electron> looseVec;
-    std::vector<double> looseIsoVec;
-    std::vector<pat::Electron> mediumVec;
-    std::vector<double> mediumIsoVec;
-    std::vector<pat::Electron> tightVec;
-    std::vector<double> tightIsoVec;
+    conversionIndex_.fill(*conversions, beamspot.position());
+    std::vector<unsigned int> looseIdx, mediumIdx, tightIdx;
+    std::vector<double> looseIsoVec, mediumIsoVec, tightIsoVec;
+    std::vector<double> relIsoValues(outputPtrs_ ? elecs->size() : 0, -1.);
+    timing.next(kElectrons);
     for (size_t i = 0; i < elecs->size(); i++) {
-        if (elecs->at(i).pt() < 10.) continue;
-        if (fabs(elecs->at(i).eta()) > 3.) continue;
+        CutFlow::Object cuts(cutFlow_);
+        if (!cuts(kPt, elecs->at(i).pt() >= 10.)) continue;
+        if (!cuts(kEta, fabs(elecs->at(i).eta()) <= 3.)) continue;
 
-        bool isLoose = isLooseElec(elecs->at(i),conversions,beamspot);    
-        bool isMedium = isMediumElec(elecs->at(i),conversions,beamspot);    
-        bool isTight = isTightElec(elecs->at(i),conversions,beamspot);    
+        bool isLoose = isLooseElec(elecs->at(i),conversionIndex_);    
+        bool isMedium = isMediumElec(elecs->at(i),conversionIndex_);    
+        bool isTight = isTightElec(elecs->at(i),conversionIndex_);    
 
         double relIso = (elecs->at(i).puppiNoLeptonsChargedHadronIso() + elecs->at(i).puppiNoLeptonsNeutralHadronIso() + elecs->at(i).puppiNoLeptonsPhotonIso()) / elecs->at(i).pt();
+        if (outputPtrs_) relIsoValues[i] = relIso;
 
-        if (!isLoose) continue;
-        looseVec.push_back(elecs->at(i));
+        if (!cuts(kLoose, isLoose)) continue;
+        looseIdx.push_back(i);
         looseIsoVec.push_back(relIso);
 
-        if (!isMedium) continue;
-        mediumVec.push_back(elecs->at(i));
+        if (!cuts(kMedium, isMedium)) continue;
+        mediumIdx.push_back(i);
         mediumIsoVec.push_back(relIso);
 
-        if (!isTight) continue;
-        tightVec.push_back(elecs->at(i));
+        if (!cuts(kTight, isTight)) continue;
+        tightIdx.push_back(i);
         tightIsoVec.push_back(relIso);
 
     }
 
-    filteredLooseElectrons.reset(new std::vector<pat::Electron>(looseVec));
-    filteredLooseElectronRelIso.reset(new std::vector<double>(looseIsoVec));
-    filteredMediumElectrons.reset(new std::vector<pat::Electron>(mediumVec));
-    filteredMediumElectronRelIso.reset(new std::vector<double>(mediumIsoVec));
-    filteredTightElectrons.reset(new std::vector<pat::Electron>(tightVec));
-    filteredTightElectronRelIso.reset(new std::vector<double>(tightIsoVec));
+    timing.next(kPut);
+    selectedobjects::put<pat::Electron>(iEvent, elecs, looseIdx, outputPtrs_, "LooseElectrons");
+    selectedobjects::put<pat::Electron>(iEvent, elecs, mediumIdx, outputPtrs_, "MediumElectrons");
+    selectedobjects::put<pat::Electron>(iEvent, elecs, tightIdx, outputPtrs_, "TightElectrons");
+    if (outputPtrs_) {
+      selectedobjects::putValueMap(iEvent, elecs, relIsoValues, "ElectronRelIso");
+    } else {
+      iEvent.put(std::unique_ptr<std::vector<double>>(new std::vector<double>(std::move(looseIsoVec))), "LooseElectronRelIso");
+      iEvent.put(std::unique_ptr<std::vector<double>>(new std::vector<double>(std::move(mediumIsoVec))), "MediumElectronRelIso");
+      iEvent.put(std::unique_ptr<std::vector<double>>(new std::vector<double>(std::move(tightIsoVec))), "TightElectronRelIso");
+    }
 
-    iEvent.put(std::move(filteredLooseElectrons), "LooseElectrons");
-    iEvent.put(std::move(filteredLooseElectronRelIso), "LooseElectronRelIso");
-    iEvent.put(std::move(filteredMediumElectrons), "MediumElectrons");
-    iEvent.put(std::move(filteredMediumElectronRelIso), "MediumElectronRelIso");
-    iEvent.put(std::move(filteredTightElectrons), "TightElectrons");
-    iEvent.put(std::move(filteredTightElectronRelIso), "TightElectronRelIso");
+    timing.stop();
+    timer_.endEvent();
 
     return;
 }
@@ -186,11 +207,13 @@ PatElectronFilter::beginStream(edm::StreamID)
 // ------------ method called once each stream after processing all runs, lumis and events  ------------
 void
 PatElectronFilter::endStream() {
+    timer_.finish();
+    cutFlow_.finish();
 }
 
 // ------------ method check that an e passes loose ID ----------------------------------
     bool
-PatElectronFilter::isLooseElec(const pat::Electron & patEl, edm::Handle<reco::ConversionCollection> conversions, const reco::BeamSpot beamspot) 
+PatElectronFilter::isLooseElec(const pat::Electron & patEl, const ConversionIndex & conversions) 
 {
     if (fabs(patEl.superCluster()->eta()) > 1.479 && fabs(patEl.superCluster()->eta()) < 1.556) return false;
     if (patEl.full5x5_sigmaIetaIeta() > 0.02992) return false;
@@ -203,13 +226,13 @@ PatElectronFilter::isLooseElec(const pat::Electron & patEl, edm::Handle<reco::Co
     else if (!std::isfinite(patEl.ecalEnergy())) Ooemoop = 998.;
     else Ooemoop = fabs(1./patEl.ecalEnergy() - patEl.eSuperClusterOverP()/patEl.ecalEnergy());
     if (Ooemoop > 73.76) return false;
-    if (ConversionTools::hasMatchedConversion(patEl, conversions, beamspot.position())) return false;
+    if (conversions.hasMatchedConversion(patEl)) return false;
     return true;
 }
 
 // ------------ method check that an e passes medium ID ----------------------------------
     bool
-PatElectronFilter::isMediumElec(const pat::Electron & patEl, edm::Handle<reco::ConversionCollection> conversions, const reco::BeamSpot beamspot) 
+PatElectronFilter::isMediumElec(const pat::Electron & patEl, const ConversionIndex & conversions) 
 {
     if (fabs(patEl.superCluster()->eta()) > 1.479 && fabs(patEl.superCluster()->eta()) < 1.556) return false;
     if (patEl.full5x5_sigmaIetaIeta() > 0.01609) return false;
@@ -222,13 +245,13 @@ PatElectronFilter::isMediumElec(const pat::Electron & patEl, edm::Handle<reco::C
     else if (!std::isfinite(patEl.ecalEnergy())) Ooemoop = 998.;
     else Ooemoop = fabs(1./patEl.ecalEnergy() - patEl.eSuperClusterOverP()/patEl.ecalEnergy());
     if (Ooemoop > 22.6) return false;
-    if (ConversionTools::hasMatchedConversion(patEl, conversions, beamspot.position())) return false;
+    if (conversions.hasMatchedConversion(patEl)) return false;
     return true;
 }
 
 // ------------ method check that an e passes tight ID ----------------------------------
     bool
-PatElectronFilter::isTightElec(const pat::Electron & patEl, edm::Handle<reco::ConversionCollection> conversions, const reco::BeamSpot beamspot) 
+PatElectronFilter::isTightElec(const pat::Electron & patEl, const ConversionIndex & conversions) 
 {
     if (fabs(patEl.superCluster()->eta()) > 1.479 && fabs(patEl.superCluster()->eta()) < 1.556) return false;
     if (patEl.full5x5_sigmaIetaIeta() > 0.01614) return false;
@@ -241,7 +264,7 @@ PatElectronFilter::isTightElec(const pat::Electron & patEl, edm::Handle<reco::Co
     else if (!std::isfinite(patEl.ecalEnergy())) Ooemoop = 998.;
     else Ooemoop = fabs(1./patEl.ecalEnergy() - patEl.eSuperClusterOverP()/patEl.ecalEnergy());
     if (Ooemoop > 18.26) return false;
-    if (ConversionTools::hasMatchedConversion(patEl, conversions, beamspot.position())) return false;
+    if (conversions.hasMatchedConversion(patEl)) return false;
     return true;
 }
 
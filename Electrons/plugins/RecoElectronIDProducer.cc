@@ -0,0 +1,274 @@
+// -*- C++ -*-
+//
+// Package:    PhaseTwoAnalysis/Electrons
+// Class:      RecoElectronIDProducer
+//
+/**\class RecoElectronIDProducer RecoElectronIDProducer.cc PhaseTwoAnalysis/Electrons/plugins/RecoElectronIDProducer.cc
+
+Description: computes the ID and isolation of the reco electrons once per
+event for RecoElectronFilter, MiniFromReco and BasicRecoDistrib
+
+Implementation:
+- electron ID comes from https://indico.cern.ch/event/623893/contributions/2531742/attachments/1436144/2208665/UPSG_EGM_Workshop_Mar29.pdf
+- the electrons go through the ElectronIDPipeline, the HGCal shower shapes
+  and the endcap BDT are only computed for the endcap candidates
+- ValueMaps keyed on the input electrons, electrons failing the pt/eta
+  preselection (pT > 10 GeV, |eta| < 3) are given 0 / -1:
+    "ID"          bitmask of the ElectronIDEvaluator working points passed,
+                  each working point on its own (not nested)
+    "MVA"         endcap BDT output, -1 if not computed
+    "RelIso"      PF no-lepton cone sum (dR < 0.4) / pT, only computed for
+                  the electrons passing a working point (-1 otherwise)
+    "TrackRelIso" jurassic track isolation / pT (BDT input)
+*/
+
+
+// system include files
+#include <memory>
+#include <cmath>
+
+// user include files
+#include "FWCore/Framework/interface/Frameworkfwd.h"
+#include "FWCore/Framework/interface/stream/EDProducer.h"
+
+#include "FWCore/Framework/interface/Event.h"
+#include "FWCore/Framework/interface/MakerMacros.h"
+
+#include "FWCore/ParameterSet/interface/ParameterSet.h"
+#include "FWCore/ParameterSet/interface/FileInPath.h"
+#include "FWCore/Utilities/interface/StreamID.h"
+#include "FWCore/Utilities/interface/InputTag.h"
+#include "DataFormats/Common/interface/Handle.h"
+
+#include "DataFormats/EgammaCandidates/interface/GsfElectron.h"
+#include "DataFormats/Common/interface/ValueMap.h"
+#include "RecoEgamma/Phase2InterimID/interface/HGCalIDTool.h"
+#include "DataFormats/Common/interface/Ptr.h"
+#include "DataFormats/Math/interface/deltaPhi.h"
+#include "DataFormats/ParticleFlowCandidate/interface/PFCandidate.h"
+#include "DataFormats/VertexReco/interface/Vertex.h"
+#include "PhaseTwoAnalysis/Common/interface/ElectronIDPipeline.h"
+#include "PhaseTwoAnalysis/Common/interface/EtaPhiGrid.h"
+#include "PhaseTwoAnalysis/Common/interface/FlatBDT.h"
+#include "PhaseTwoAnalysis/Common/interface/SelectedObjects.h"
+#include "PhaseTwoAnalysis/Common/interface/StageTimer.h"
+
+#include <vector>
+
+//
+// class declaration
+//
+
+class RecoElectronIDProducer : public edm::stream::EDProducer<> {
+  public:
+    explicit RecoElectronIDProducer(const edm::ParameterSet&);
+    ~RecoElectronIDProducer() {}
+
+    static void fillDescriptions(edm::ConfigurationDescriptions& descriptions);
+
+  private:
+    virtual void produce(edm::Event&, const edm::EventSetup&) override;
+    virtual void endStream() override;
+
+    bool fillMVAInputsElec(const reco::GsfElectron & recoEl, const reco::Vertex & recoVtx, double isoEl, std::vector<float> & inputs);
+
+    // ----------member data ---------------------------
+    std::unique_ptr<HGCalIDTool> hgcEmId_;
+    std::shared_ptr<const FlatBDT> electronBDT_;
+    ConversionIndex conversionIndex_;
+    ElectronIDPipeline electronID_;
+    EtaPhiGrid pfCandsNoLepGrid_;
+    std::vector<float> mvaInputs_;
+    std::vector<double> mvaValues_;
+
+    edm::EDGetTokenT<std::vector<reco::GsfElectron>> elecsToken_;
+    edm::EDGetTokenT<reco::BeamSpot> bsToken_;
+    edm::EDGetTokenT<std::vector<reco::Conversion>> convToken_;
+    edm::EDGetTokenT<edm::ValueMap<double>> trackIsoValueMapToken_;
+    edm::EDGetTokenT<std::vector<reco::PFCandidate>> pfCandsNoLepToken_;
+    edm::EDGetTokenT<std::vector<reco::Vertex>> verticesToken_;
+    edm::EDGetTokenT<int> primaryVertexToken_;
+
+    enum Stage {kInputs = 0, kElectronMVA, kElectrons, kPut};
+    StageTimer timer_;
+};
+
+//
+// constructors and destructor
+//
+RecoElectronIDProducer::RecoElectronIDProducer(const edm::ParameterSet& iConfig):
+  electronID_(iConfig, ElectronIDEvaluator::kAll, false),
+  elecsToken_(consumes<std::vector<reco::GsfElectron>>(iConfig.getParameter<edm::InputTag>("electrons"))),
+  bsToken_(consumes<reco::BeamSpot>(iConfig.getParameter<edm::InputTag>("beamspot"))),
+  convToken_(consumes<std::vector<reco::Conversion>>(iConfig.getParameter<edm::InputTag>("conversions"))),
+  trackIsoValueMapToken_(consumes<edm::ValueMap<double>>(iConfig.getParameter<edm::InputTag>("trackIsoValueMap"))),
+  pfCandsNoLepToken_(consumes<std::vector<reco::PFCandidate>>(iConfig.getParameter<edm::InputTag>("pfCandsNoLep"))),
+  verticesToken_(consumes<std::vector<reco::Vertex>>(iConfig.getParameter<edm::InputTag>("vertices"))),
+  primaryVertexToken_(consumes<int>(iConfig.getParameter<edm::InputTag>("primaryVertex"))),
+  timer_(iConfig, {"inputs", "electronMVA", "electrons", "put"})
+{
+  produces<edm::ValueMap<int>>("ID");
+  produces<edm::ValueMap<double>>("MVA");
+  produces<edm::ValueMap<double>>("RelIso");
+  produces<edm::ValueMap<double>>("TrackRelIso");
+
+  const edm::ParameterSet& hgcIdCfg = iConfig.getParameterSet("HGCalIDToolConfig");
+  auto cc = consumesCollector();
+  hgcEmId_.reset( new HGCalIDTool(hgcIdCfg, cc) );
+
+  electronBDT_ = FlatBDT::get(iConfig.getParameter<edm::FileInPath>("electronMVAWeights").fullPath(), {
+      "hgcId_startPosition",
+      "hgcId_lengthCompatibility",
+      "hgcId_sigmaietaieta",
+      "abs(hgcId_deltaEtaStartPosition)",
+      "abs(hgcId_deltaPhiStartPosition)",
+      "hOverE_hgcalSafe",
+      "hgcId_cosTrackShowerAngle",
+      "trackIsoR04jurassic_D_pt := trackIsoR04jurassic/pt",
+      "abs(ooEmooP)",
+      "abs(d0)",
+      "abs(dz)",
+      "expectedMissingInnerHits"});
+
+}
+
+
+//
+// member functions
+//
+
+// ------------ method called to produce the data  ------------
+  void
+RecoElectronIDProducer::produce(edm::Event& iEvent, const edm::EventSetup& iSetup)
+{
+  using namespace edm;
+
+  StageTimer::Scope timing(timer_, kInputs);
+
+  hgcEmId_->getEventSetup(iSetup);
+  hgcEmId_->getEvent(iEvent);
+
+  Handle<std::vector<reco::Vertex>> vertices;
+  iEvent.getByToken(verticesToken_, vertices);
+  // Primary vertex, -1 if none
+  Handle<int> primaryVertex;
+  iEvent.getByToken(primaryVertexToken_, primaryVertex);
+  const int prVtx = *primaryVertex;
+
+  Handle<std::vector<reco::GsfElectron>> elecs;
+  iEvent.getByToken(elecsToken_, elecs);
+  Handle<reco::ConversionCollection> conversions;
+  iEvent.getByToken(convToken_, conversions);
+  Handle<reco::BeamSpot> bsHandle;
+  iEvent.getByToken(bsToken_, bsHandle);
+  const reco::BeamSpot &beamspot = *bsHandle.product();
+  conversionIndex_.fill(*conversions, beamspot.position());
+  Handle<ValueMap<double>> trackIsoValueMap;
+  iEvent.getByToken(trackIsoValueMapToken_, trackIsoValueMap);
+  Handle<std::vector<reco::PFCandidate>> pfCandsNoLep;
+  iEvent.getByToken(pfCandsNoLepToken_, pfCandsNoLep);
+  pfCandsNoLepGrid_.fill(*pfCandsNoLep);
+
+  std::vector<int> idValues(elecs->size(), 0);
+  std::vector<double> mvaValues(elecs->size(), -1.);
+  std::vector<double> relIsoValues(elecs->size(), -1.);
+  std::vector<double> trackRelIsoValues(elecs->size(), -1.);
+
+  timing.next(kElectronMVA);
+  // Cheap cuts first; the HGCal shower shapes and the endcap electron MVA
+  // only for the endcap candidates, the MVA evaluated in one go for all of them
+  electronID_.beginEvent(elecs->size());
+  std::vector<int> mvaIndex(elecs->size(), -1);
+  int nMVA = 0;
+  mvaInputs_.clear();
+  for (size_t i = 0; i < elecs->size(); i++) {
+    const bool needsMVA = electronID_.preselect(i, elecs->at(i), conversionIndex_);
+    if (!electronID_.preselected(i)) continue;
+    Ptr<const reco::GsfElectron> el4iso(elecs,i);
+    trackRelIsoValues[i] = (*trackIsoValueMap)[el4iso]/elecs->at(i).pt();
+    if (!needsMVA || prVtx < 0) continue;
+    if (fillMVAInputsElec(elecs->at(i), vertices->at(prVtx), trackRelIsoValues[i], mvaInputs_))
+      mvaIndex[i] = nMVA++;
+  }
+  mvaValues_.resize(nMVA);
+  electronBDT_->evaluate(mvaInputs_.data(), nMVA, mvaValues_.data());
+  for (size_t i = 0; i < elecs->size(); i++) {
+    if (!electronID_.needsMVA(i)) continue;
+    if (mvaIndex[i] >= 0) mvaValues[i] = mvaValues_[mvaIndex[i]];
+    electronID_.setMVA(i, mvaValues[i], mvaIndex[i] >= 0);
+  }
+  timing.next(kElectrons);
+
+  for(size_t i = 0; i < elecs->size(); i++) {
+    if (!electronID_.preselected(i)) continue;
+    idValues[i] = electronID_.passed(i);
+    // the isolation is only used with a working point
+    if (!idValues[i]) continue;
+
+    double relIso = pfCandsNoLepGrid_.coneSum(elecs->at(i).eta(), elecs->at(i).phi(), 0.4);
+    if (elecs->at(i).pt() > 0.) relIso = relIso / elecs->at(i).pt();
+    else relIso = -1.;
+    relIsoValues[i] = relIso;
+  }
+
+  timing.next(kPut);
+  selectedobjects::putValueMap(iEvent, elecs, idValues, "ID");
+  selectedobjects::putValueMap(iEvent, elecs, mvaValues, "MVA");
+  selectedobjects::putValueMap(iEvent, elecs, relIsoValues, "RelIso");
+  selectedobjects::putValueMap(iEvent, elecs, trackRelIsoValues, "TrackRelIso");
+
+  timing.stop();
+  timer_.endEvent();
+}
+
+// ------------ method called once each stream after processing all runs, lumis and events  ------------
+void
+RecoElectronIDProducer::endStream() {
+  electronID_.finish();
+  timer_.finish();
+}
+
+// ------------ HGCal electron MVA inputs --------------
+// Appends the BDT inputs of an endcap electron to inputs, in the order of the
+// weights file. Returns false (nothing appended) when no MVA value is
+// computed, i.e. outside the HGCal acceptance or without an HGCal cluster.
+bool
+RecoElectronIDProducer::fillMVAInputsElec(const reco::GsfElectron & recoEl, const reco::Vertex & recoVtx, double isoEl, std::vector<float> & inputs) {
+
+  if (fabs(recoEl.superCluster()->eta()) < 1.556) return false;
+  if (!hgcEmId_->setElectronPtr(&recoEl)) return false;
+
+  double ooEmooP = 1e30;
+  if (recoEl.ecalEnergy() == 0) ooEmooP = 1e30;
+  else if (!std::isfinite(recoEl.ecalEnergy())) ooEmooP = 1e30;
+  else ooEmooP = fabs(1.0/recoEl.ecalEnergy() - recoEl.eSuperClusterOverP()/recoEl.ecalEnergy());
+
+  // d0 and dz are passed signed, as they were to the TMVA::Reader
+  inputs.push_back(std::abs(hgcEmId_->getClusterStartPosition().z()));
+  inputs.push_back(hgcEmId_->getClusterLengthCompatibility());
+  inputs.push_back(hgcEmId_->getClusterSigmaEtaEta());
+  inputs.push_back(recoEl.trackPositionAtCalo().eta() - hgcEmId_->getClusterStartPosition().eta());
+  inputs.push_back(reco::deltaPhi(recoEl.trackPositionAtCalo().phi(), hgcEmId_->getClusterStartPosition().phi()));
+  inputs.push_back(hgcEmId_->getClusterHadronFraction());
+  inputs.push_back(recoEl.trackMomentumOut().Unit().Dot(hgcEmId_->getClusterShowerAxis().Unit()));
+  inputs.push_back((float)isoEl);
+  inputs.push_back(ooEmooP);
+  inputs.push_back(recoEl.gsfTrack()->dxy(recoVtx.position()));
+  inputs.push_back(recoEl.gsfTrack()->dz(recoVtx.position()));
+  inputs.push_back((float)recoEl.gsfTrack()->hitPattern().numberOfHits(reco::HitPattern::MISSING_INNER_HITS));
+
+  return true;
+}
+
+// ------------ method fills 'descriptions' with the allowed parameters for the module  ------------
+void
+RecoElectronIDProducer::fillDescriptions(edm::ConfigurationDescriptions& descriptions) {
+  //The following says we do not know what parameters are allowed so do no validation
+  // Please change this to state exactly what you do use, even if it is no parameters
+  edm::ParameterSetDescription desc;
+  desc.setUnknown();
+  descriptions.addDefault(desc);
+}
+
+//define this as a plug-in
+DEFINE_FWK_MODULE(RecoElectronIDProducer);
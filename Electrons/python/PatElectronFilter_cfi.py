@@ -4,4 +4,6 @@ electronfilter = cms.EDProducer('PatElectronFilter',
         electrons     = cms.InputTag("slimmedElectrons"),
         beamspot      = cms.InputTag("offlineBeamSpot"),
         conversions   = cms.InputTag("reducedEgamma", "reducedConversions", "PAT"),
+        outputPtrs    = cms.bool(False),
+        timing        = cms.untracked.bool(False),
 )
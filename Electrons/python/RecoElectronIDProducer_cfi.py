@@ -0,0 +1,21 @@
+import FWCore.ParameterSet.Config as cms
+
+recoElectronID = cms.EDProducer('RecoElectronIDProducer',
+        electrons    = cms.InputTag("ecalDrivenGsfElectrons"),
+        beamspot     = cms.InputTag("offlineBeamSpot"),
+        conversions  = cms.InputTag("particleFlowEGamma"),
+        trackIsoValueMap = cms.InputTag("electronTrackIsolationCones","Lcone"),
+        pfCandsNoLep = cms.InputTag("particleFlow"),
+        vertices     = cms.InputTag("offlinePrimaryVertices"),
+        primaryVertex = cms.InputTag("primaryVertexSelector"),
+        electronMVAWeights = cms.FileInPath("PhaseTwoAnalysis/Common/data/TMVAClassification_BDT.weights.xml"),
+        HGCalIDToolConfig = cms.PSet(
+            HGCBHInput = cms.InputTag("HGCalRecHit","HGCHEBRecHits"),
+            HGCEEInput = cms.InputTag("HGCalRecHit","HGCEERecHits"),
+            HGCFHInput = cms.InputTag("HGCalRecHit","HGCHEFRecHits"),
+            HGCPFRecHits = cms.InputTag("particleFlowRecHitHGC"),
+            withPileup = cms.bool(True),
+            debug = cms.bool(False),
+        ),
+        timing       = cms.untracked.bool(False),
+)
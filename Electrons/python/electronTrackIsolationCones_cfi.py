@@ -0,0 +1,33 @@
+import FWCore.ParameterSet.Config as cms
+
+# jurassic track isolation in several cones from a single pass over the tracks,
+# one ValueMap<double> per cone labelled by its name, e.g.
+# cms.InputTag("electronTrackIsolationCones","Lcone")
+electronTrackIsolationCones = cms.EDProducer("EgammaElectronTkMultiIsolationProducer",
+    electronProducer = cms.InputTag("ecalDrivenGsfElectrons"),
+    trackProducer    = cms.InputTag("generalTracks"),
+    BeamspotProducer = cms.InputTag("offlineBeamSpot"),
+    ptMin            = cms.double(0.7),
+    maxVtxDist       = cms.double(0.2),
+    maxVtxDistXY     = cms.double(9999.0),
+    cones = cms.VPSet(
+        # as electronTrackIsolationLcone with the inner radius used by the filters and ntuplers
+        cms.PSet(
+            label           = cms.string("Lcone"),
+            extRadius       = cms.double(0.4),
+            intRadiusBarrel = cms.double(0.04),
+            intRadiusEndcap = cms.double(0.04),
+            stripBarrel     = cms.double(0.015),
+            stripEndcap     = cms.double(0.015),
+        ),
+        # as electronTrackIsolationScone
+        cms.PSet(
+            label           = cms.string("Scone"),
+            extRadius       = cms.double(0.3),
+            intRadiusBarrel = cms.double(0.015),
+            intRadiusEndcap = cms.double(0.015),
+            stripBarrel     = cms.double(0.015),
+            stripEndcap     = cms.double(0.015),
+        ),
+    ),
+)
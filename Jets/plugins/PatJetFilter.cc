@@ -39,6 +39,11 @@ Implementation:
 #include "DataFormats/PatCandidates/interface/Jet.h"
 #include "PhysicsTools/SelectorUtils/interface/PFJetIDSelectionFunctor.h"
 
+#include "PhaseTwoAnalysis/Common/interface/OverlapRemover.h"
+#include "PhaseTwoAnalysis/Common/interface/SelectedObjects.h"
+#include "PhaseTwoAnalysis/Common/interface/CutFlow.h"
+#include "PhaseTwoAnalysis/Common/interface/StageTimer.h"
+
 #include <vector>
 
 //
@@ -70,6 +75,14 @@ class PatJetFilter : public edm::stream::EDProducer<> {
     PFJetIDSelectionFunctor jetIDLoose_;
     double mvaThres_[3];
     double deepThres_[3];
+    bool outputPtrs_;
+
+    enum Stage {kInputs = 0, kCleaning, kJets, kPut};
+    StageTimer timer_;
+    enum Cut {kPt = 0, kEta, kOverlap, kLooseID};
+    CutFlow cutFlow_;
+
+    OverlapRemover jetOverlapLeptons_;
 };
 
 //
@@ -89,15 +102,28 @@ PatJetFilter::PatJetFilter(const edm::ParameterSet& iConfig):
   elecsToken_(consumes<std::vector<pat::Electron>>(iConfig.getParameter<edm::InputTag>("electrons"))),
   muonsToken_(consumes<std::vector<pat::Muon>>(iConfig.getParameter<edm::InputTag>("muons"))),
   jetsToken_(consumes<std::vector<pat::Jet>>(iConfig.getParameter<edm::InputTag>("jets"))),
-  jetIDLoose_(PFJetIDSelectionFunctor::FIRSTDATA, PFJetIDSelectionFunctor::LOOSE) 
+  jetIDLoose_(PFJetIDSelectionFunctor::FIRSTDATA, PFJetIDSelectionFunctor::LOOSE),
+  outputPtrs_(iConfig.getParameter<bool>("outputPtrs")),
+  timer_(iConfig, {"inputs", "cleaning", "jets", "put"}),
+  cutFlow_(iConfig, "jets", {"pt", "eta", "overlap", "looseID"})
 {
-  produces<std::vector<pat::Jet>>("Jets");
-  produces<std::vector<pat::Jet>>("LooseMVAv2Jets");
-  produces<std::vector<pat::Jet>>("MediumMVAv2Jets");
-  produces<std::vector<pat::Jet>>("TightMVAv2Jets");
-  produces<std::vector<pat::Jet>>("LooseDeepCSVJets");
-  produces<std::vector<pat::Jet>>("MediumDeepCSVJets");
-  produces<std::vector<pat::Jet>>("TightDeepCSVJets");
+  if (outputPtrs_) {
+    produces<edm::PtrVector<pat::Jet>>("Jets");
+    produces<edm::PtrVector<pat::Jet>>("LooseMVAv2Jets");
+    produces<edm::PtrVector<pat::Jet>>("MediumMVAv2Jets");
+    produces<edm::PtrVector<pat::Jet>>("TightMVAv2Jets");
+    produces<edm::PtrVector<pat::Jet>>("LooseDeepCSVJets");
+    produces<edm::PtrVector<pat::Jet>>("MediumDeepCSVJets");
+    produces<edm::PtrVector<pat::Jet>>("TightDeepCSVJets");
+  } else {
+    produces<std::vector<pat::Jet>>("Jets");
+    produces<std::vector<pat::Jet>>("LooseMVAv2Jets");
+    produces<std::vector<pat::Jet>>("MediumMVAv2Jets");
+    produces<std::vector<pat::Jet>>("TightMVAv2Jets");
+    produces<std::vector<pat::Jet>>("LooseDeepCSVJets");
+    produces<std::vector<pat::Jet>>("MediumDeepCSVJets");
+    produces<std::vector<pat::Jet>>("TightDeepCSVJets");
+  }
 
   if (pileup_ == 0) {
      mvaThres_[0] = -0.694;
@@ -150,6 +176,8 @@ PatJetFilter::produce(edm::Event& iEvent, const edm::EventSetup& iSetup)
 {
   using namespace edm;
 
+  StageTimer::Scope timing(timer_, kInputs);
+
   Handle<std::vector<pat::Muon>> muons;
   iEvent.getByToken(muonsToken_, muons);
   Handle<std::vector<pat::Electron>> elecs;
@@ -157,76 +185,55 @@ PatJetFilter::produce(edm::Event& iEvent, const edm::EventSetup& iSetup)
   Handle<std::vector<pat::Jet>> jets;
   iEvent.getByToken(jetsToken_, jets);
 
-  std::unique_ptr<std::vector<pat::Jet>> filteredJets;
-  std::unique_ptr<std::vector<pat::Jet>> filteredLooseMVAv2Jets;
-  std::unique_ptr<std::vector<pat::Jet>> filteredMediumMVAv2Jets;
-  std::unique_ptr<std::vector<pat::Jet>> filteredTightMVAv2Jets;
-  std::unique_ptr<std::vector<pat::Jet>> filteredLooseDeepCSVJets;
-  std::unique_ptr<std::vector<pat::Jet>> filteredMediumDeepCSVJets;
-  std::unique_ptr<std::vector<pat::Jet>> filteredTightDeepCSVJets;
-  std::vector<pat::Jet> Vec;
-  std::vector<pat::Jet> looseMVAv2Vec;
-  std::vector<pat::Jet> mediumMVAv2Vec;
-  std::vector<pat::Jet> tightMVAv2Vec;
-  std::vector<pat::Jet> looseDeepCSVVec;
-  std::vector<pat::Jet> mediumDeepCSVVec;
-  std::vector<pat::Jet> tightDeepCSVVec;
+  std::vector<unsigned int> jetIdx;
+  std::vector<unsigned int> looseMVAv2Idx, mediumMVAv2Idx, tightMVAv2Idx;
+  std::vector<unsigned int> looseDeepCSVIdx, mediumDeepCSVIdx, tightDeepCSVIdx;
+
+  timing.next(kCleaning);
+  jetOverlapLeptons_.clear();
+  for (size_t j = 0; j < elecs->size(); j++) jetOverlapLeptons_.add(elecs->at(j));
+  for (size_t j = 0; j < muons->size(); j++) jetOverlapLeptons_.add(muons->at(j));
+  jetOverlapLeptons_.build();
 
+  timing.next(kJets);
   for (size_t i = 0; i < jets->size(); i++) {
-    if (jets->at(i).pt() < 20.) continue;
-    if (fabs(jets->at(i).eta()) > 5) continue;
-
-    bool overlaps = false;
-    for (size_t j = 0; j < elecs->size(); j++) {
-      if (fabs(jets->at(i).pt()-elecs->at(j).pt()) < 0.01*elecs->at(j).pt() && ROOT::Math::VectorUtil::DeltaR(elecs->at(j).p4(),jets->at(i).p4()) < 0.01) {
-        overlaps = true;
-        break;
-      }
-    }
-    if (overlaps) continue;
-    for (size_t j = 0; j < muons->size(); j++) {
-      if (fabs(jets->at(i).pt()-muons->at(j).pt()) < 0.01*muons->at(j).pt() && ROOT::Math::VectorUtil::DeltaR(muons->at(j).p4(),jets->at(i).p4()) < 0.01) {
-        overlaps = true;
-        break;
-      }
-    }
-    if (overlaps) continue;
+    CutFlow::Object cuts(cutFlow_);
+    if (!cuts(kPt, jets->at(i).pt() >= 20.)) continue;
+    if (!cuts(kEta, fabs(jets->at(i).eta()) <= 5)) continue;
+
+    if (!cuts(kOverlap, !jetOverlapLeptons_.overlaps(jets->at(i)))) continue;
 
     pat::strbitset retLoose = jetIDLoose_.getBitTemplate();
     retLoose.set(false);
     bool isLoose = jetIDLoose_(jets->at(i), retLoose);
 
-    if (!isLoose) continue;
-    Vec.push_back(jets->at(i));
+    if (!cuts(kLooseID, isLoose)) continue;
+    jetIdx.push_back(i);
 
     double mvav2   = jets->at(i).bDiscriminator("pfCombinedMVAV2BJetTags"); 
-    if (mvav2 > mvaThres_[0]) looseMVAv2Vec.push_back(jets->at(i));
-    if (mvav2 > mvaThres_[1]) mediumMVAv2Vec.push_back(jets->at(i));
-    if (mvav2 > mvaThres_[2]) tightMVAv2Vec.push_back(jets->at(i));
+    if (mvav2 > mvaThres_[0]) looseMVAv2Idx.push_back(i);
+    if (mvav2 > mvaThres_[1]) mediumMVAv2Idx.push_back(i);
+    if (mvav2 > mvaThres_[2]) tightMVAv2Idx.push_back(i);
 
     double deepcsv = jets->at(i).bDiscriminator("pfDeepCSVJetTags:probb") +
       jets->at(i).bDiscriminator("pfDeepCSVJetTags:probbb");
-    if (deepcsv > deepThres_[0]) looseDeepCSVVec.push_back(jets->at(i));
-    if (deepcsv > deepThres_[1]) mediumDeepCSVVec.push_back(jets->at(i));
-    if (deepcsv > deepThres_[2]) tightDeepCSVVec.push_back(jets->at(i));
+    if (deepcsv > deepThres_[0]) looseDeepCSVIdx.push_back(i);
+    if (deepcsv > deepThres_[1]) mediumDeepCSVIdx.push_back(i);
+    if (deepcsv > deepThres_[2]) tightDeepCSVIdx.push_back(i);
 
   }
 
-  filteredJets.reset(new std::vector<pat::Jet>(Vec));
-  filteredLooseMVAv2Jets.reset(new std::vector<pat::Jet>(looseMVAv2Vec));
-  filteredMediumMVAv2Jets.reset(new std::vector<pat::Jet>(mediumMVAv2Vec));
-  filteredTightMVAv2Jets.reset(new std::vector<pat::Jet>(tightMVAv2Vec));
-  filteredLooseDeepCSVJets.reset(new std::vector<pat::Jet>(looseDeepCSVVec));
-  filteredMediumDeepCSVJets.reset(new std::vector<pat::Jet>(mediumDeepCSVVec));
-  filteredTightDeepCSVJets.reset(new std::vector<pat::Jet>(tightDeepCSVVec));
-
-  iEvent.put(std::move(filteredJets), "Jets");
-  iEvent.put(std::move(filteredLooseMVAv2Jets), "LooseMVAv2Jets");
-  iEvent.put(std::move(filteredMediumMVAv2Jets), "MediumMVAv2Jets");
-  iEvent.put(std::move(filteredTightMVAv2Jets), "TightMVAv2Jets");
-  iEvent.put(std::move(filteredLooseDeepCSVJets), "LooseDeepCSVJets");
-  iEvent.put(std::move(filteredMediumDeepCSVJets), "MediumDeepCSVJets");
-  iEvent.put(std::move(filteredTightDeepCSVJets), "TightDeepCSVJets");
+  timing.next(kPut);
+  selectedobjects::put<pat::Jet>(iEvent, jets, jetIdx, outputPtrs_, "Jets");
+  selectedobjects::put<pat::Jet>(iEvent, jets, looseMVAv2Idx, outputPtrs_, "LooseMVAv2Jets");
+  selectedobjects::put<pat::Jet>(iEvent, jets, mediumMVAv2Idx, outputPtrs_, "MediumMVAv2Jets");
+  selectedobjects::put<pat::Jet>(iEvent, jets, tightMVAv2Idx, outputPtrs_, "TightMVAv2Jets");
+  selectedobjects::put<pat::Jet>(iEvent, jets, looseDeepCSVIdx, outputPtrs_, "LooseDeepCSVJets");
+  selectedobjects::put<pat::Jet>(iEvent, jets, mediumDeepCSVIdx, outputPtrs_, "MediumDeepCSVJets");
+  selectedobjects::put<pat::Jet>(iEvent, jets, tightDeepCSVIdx, outputPtrs_, "TightDeepCSVJets");
+
+  timing.stop();
+  timer_.endEvent();
 
   return;
 }
@@ -240,6 +247,8 @@ PatJetFilter::beginStream(edm::StreamID)
 // ------------ method called once each stream after processing all runs, lumis and events  ------------
 void
 PatJetFilter::endStream() {
+  timer_.finish();
+  cutFlow_.finish();
 }
 
 // ------------ method called when starting to processes a run  ------------
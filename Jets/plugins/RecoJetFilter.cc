@@ -38,8 +38,12 @@ Implementation:
 #include "DataFormats/EgammaCandidates/interface/GsfElectron.h"
 #include "DataFormats/JetReco/interface/PFJet.h"
 
+#include "PhaseTwoAnalysis/Common/interface/OverlapRemover.h"
+#include "PhaseTwoAnalysis/Common/interface/SelectedObjects.h"
+#include "PhaseTwoAnalysis/Common/interface/CutFlow.h"
+#include "PhaseTwoAnalysis/Common/interface/StageTimer.h"
+
 #include <vector>
-#include "Math/GenVector/VectorUtil.h"
 
 //
 // class declaration
@@ -66,6 +70,14 @@ class RecoJetFilter : public edm::stream::EDProducer<> {
     edm::EDGetTokenT<std::vector<reco::GsfElectron>> elecsToken_;
     edm::EDGetTokenT<std::vector<reco::Muon>> muonsToken_;
     edm::EDGetTokenT<std::vector<reco::PFJet>> jetsToken_;
+    bool outputPtrs_;
+
+    enum Stage {kInputs = 0, kCleaning, kJets, kPut};
+    StageTimer timer_;
+    enum Cut {kPt = 0, kEta, kOverlap};
+    CutFlow cutFlow_;
+
+    OverlapRemover jetOverlapLeptons_;
 
 };
 
@@ -84,9 +96,13 @@ class RecoJetFilter : public edm::stream::EDProducer<> {
 RecoJetFilter::RecoJetFilter(const edm::ParameterSet& iConfig):
   elecsToken_(consumes<std::vector<reco::GsfElectron>>(iConfig.getParameter<edm::InputTag>("electrons"))),
   muonsToken_(consumes<std::vector<reco::Muon>>(iConfig.getParameter<edm::InputTag>("muons"))),
-  jetsToken_(consumes<std::vector<reco::PFJet>>(iConfig.getParameter<edm::InputTag>("jets")))
+  jetsToken_(consumes<std::vector<reco::PFJet>>(iConfig.getParameter<edm::InputTag>("jets"))),
+  outputPtrs_(iConfig.getParameter<bool>("outputPtrs")),
+  timer_(iConfig, {"inputs", "cleaning", "jets", "put"}),
+  cutFlow_(iConfig, "jets", {"pt", "eta", "overlap"})
 {
-  produces<std::vector<reco::PFJet>>("Jets");
+  if (outputPtrs_) produces<edm::PtrVector<reco::PFJet>>("Jets");
+  else produces<std::vector<reco::PFJet>>("Jets");
 
 }
 
@@ -110,6 +126,8 @@ RecoJetFilter::produce(edm::Event& iEvent, const edm::EventSetup& iSetup)
 {
   using namespace edm;
 
+  StageTimer::Scope timing(timer_, kInputs);
+
   Handle<std::vector<reco::Muon>> muons;
   iEvent.getByToken(muonsToken_, muons);
   Handle<std::vector<reco::GsfElectron>> elecs;
@@ -117,34 +135,30 @@ RecoJetFilter::produce(edm::Event& iEvent, const edm::EventSetup& iSetup)
   Handle<std::vector<reco::PFJet>> jets;
   iEvent.getByToken(jetsToken_, jets);
 
-  std::unique_ptr<std::vector<reco::PFJet>> filteredJets;
-  std::vector<reco::PFJet> Vec;
+  std::vector<unsigned int> jetIdx;
+
+  timing.next(kCleaning);
+  jetOverlapLeptons_.clear();
+  for (size_t j = 0; j < elecs->size(); j++) jetOverlapLeptons_.add(elecs->at(j));
+  for (size_t j = 0; j < muons->size(); j++) jetOverlapLeptons_.add(muons->at(j));
+  jetOverlapLeptons_.build();
+
+  timing.next(kJets);
   for(size_t i = 0; i < jets->size(); i++){
-    if (jets->at(i).pt() < 20.) continue;
-    if (fabs(jets->at(i).eta()) > 5) continue;
-
-    bool overlaps = false;
-    for (size_t j = 0; j < elecs->size(); j++) {
-      if (fabs(jets->at(i).pt()-elecs->at(j).pt()) < 0.01*elecs->at(j).pt() && ROOT::Math::VectorUtil::DeltaR(elecs->at(j).p4(),jets->at(i).p4()) < 0.01) {
-        overlaps = true;
-        break;
-      }
-    }
-    if (overlaps) continue;
-    for (size_t j = 0; j < muons->size(); j++) {
-      if (fabs(jets->at(i).pt()-muons->at(j).pt()) < 0.01*muons->at(j).pt() && ROOT::Math::VectorUtil::DeltaR(muons->at(j).p4(),jets->at(i).p4()) < 0.01) {
-        overlaps = true;
-        break;
-      }
-    }
-    if (overlaps) continue;
-    Vec.push_back(jets->at(i));
+    CutFlow::Object cuts(cutFlow_);
+    if (!cuts(kPt, jets->at(i).pt() >= 20.)) continue;
+    if (!cuts(kEta, fabs(jets->at(i).eta()) <= 5)) continue;
+
+    if (!cuts(kOverlap, !jetOverlapLeptons_.overlaps(jets->at(i)))) continue;
+    jetIdx.push_back(i);
 
   }
 
-  filteredJets.reset(new std::vector<reco::PFJet>(Vec));
+  timing.next(kPut);
+  selectedobjects::put<reco::PFJet>(iEvent, jets, jetIdx, outputPtrs_, "Jets");
 
-  iEvent.put(std::move(filteredJets), "Jets");
+  timing.stop();
+  timer_.endEvent();
 
   return;
 }
@@ -158,6 +172,8 @@ RecoJetFilter::beginStream(edm::StreamID)
 // ------------ method called once each stream after processing all runs, lumis and events  ------------
 void
 RecoJetFilter::endStream() {
+  timer_.finish();
+  cutFlow_.finish();
 }
 
 // ------------ method called when starting to processes a run  ------------
@@ -5,4 +5,6 @@ jetfilter = cms.EDProducer('PatJetFilter',
         electrons     = cms.InputTag("slimmedElectrons"),
         muons         = cms.InputTag("slimmedMuons"),
         jets          = cms.InputTag("slimmedJetsPuppi"),
+        outputPtrs    = cms.bool(False),
+        timing        = cms.untracked.bool(False),
 )
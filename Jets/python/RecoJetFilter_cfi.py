@@ -4,4 +4,6 @@ jetfilter = cms.EDProducer('RecoJetFilter',
         electrons    = cms.InputTag("ecalDrivenGsfElectrons"),
         muons        = cms.InputTag("muons"),
         jets         = cms.InputTag("ak4PFJetsCHS"),
+        outputPtrs   = cms.bool(False),
+        timing       = cms.untracked.bool(False),
 )
@@ -63,6 +63,8 @@ if (options.inputFormat.lower() == "reco"):
     moduleName = "RecoMuonFilter"
 process.muonfilter = cms.EDProducer(moduleName)
 process.load("PhaseTwoAnalysis.Muons."+moduleName+"_cfi")
+process.load("PhaseTwoAnalysis.Common.PrimaryVertexSelector_cfi")
+process.primaryVertexSelector.vertices = process.muonfilter.vertices
 
 process.out = cms.OutputModule("PoolOutputModule",
     outputCommands = cms.untracked.vstring('keep *_*_*_*',
@@ -76,8 +78,8 @@ if (options.inputFormat.lower() == "reco"):
                          +process.puppi
                          +process.particleFlowNoLep+process.puppiNoLep
                          +process.offlineSlimmedPrimaryVertices+process.packedPFCandidates
-                         +process.muonIsolationPUPPI+process.muonIsolationPUPPINoLep * process.muonfilter)
+                         +process.muonIsolationPUPPI+process.muonIsolationPUPPINoLep * process.primaryVertexSelector * process.muonfilter)
 else:
-    process.p = cms.Path(process.muonfilter)
+    process.p = cms.Path(process.primaryVertexSelector * process.muonfilter)
 
 process.e = cms.EndPath(process.out)
@@ -44,6 +44,11 @@ Implementation:
 #include "Geometry/GEMGeometry/interface/ME0EtaPartitionSpecs.h"
 #include "Geometry/GEMGeometry/interface/ME0Geometry.h"
 
+#include "PhaseTwoAnalysis/Common/interface/ME0MatchSummary.h"
+#include "PhaseTwoAnalysis/Common/interface/SelectedObjects.h"
+#include "PhaseTwoAnalysis/Common/interface/CutFlow.h"
+#include "PhaseTwoAnalysis/Common/interface/StageTimer.h"
+
 #include <vector>
 #include "Math/GenVector/VectorUtil.h"
 
@@ -63,8 +68,7 @@ class RecoMuonFilter : public edm::stream::EDProducer<> {
     virtual void produce(edm::Event&, const edm::EventSetup&) override;
     virtual void endStream() override;
 
-    bool isME0MuonSel(reco::Muon muon, double pullXCut, double dXCut, double pullYCut, double dYCut, double dPhi);
-    bool isME0MuonSelNew(reco::Muon, double, double, double);
+    bool isME0MuonSel(const reco::Muon & muon, double pullXCut, double dXCut, double pullYCut, double dYCut, double dPhi);
 
     virtual void beginRun(edm::Run const&, edm::EventSetup const&) override;
     //virtual void endRun(edm::Run const&, edm::EventSetup const&) override;
@@ -73,13 +77,20 @@ class RecoMuonFilter : public edm::stream::EDProducer<> {
 
     // ----------member data ---------------------------
     edm::EDGetTokenT<std::vector<reco::Vertex>> verticesToken_;
+    edm::EDGetTokenT<int> primaryVertexToken_;
     edm::EDGetTokenT<edm::View<reco::Muon>> muonsToken_;
 
     edm::EDGetTokenT<edm::ValueMap<float> > PUPPINoLeptonsIsolation_charged_hadrons_;
     edm::EDGetTokenT<edm::ValueMap<float> > PUPPINoLeptonsIsolation_neutral_hadrons_;
     edm::EDGetTokenT<edm::ValueMap<float> > PUPPINoLeptonsIsolation_photons_;
+    bool outputPtrs_;
+
+    enum Stage {kInputs = 0, kMuons, kPut};
+    StageTimer timer_;
+    enum Cut {kPt = 0, kEta, kLoose, kMedium, kTight};
+    CutFlow cutFlow_;
   
-    const ME0Geometry* ME0Geometry_; 
+    ME0ChamberCache me0Chambers_;
 };
 
 //
@@ -96,18 +107,29 @@ class RecoMuonFilter : public edm::stream::EDProducer<> {
 //
 RecoMuonFilter::RecoMuonFilter(const edm::ParameterSet& iConfig):
   verticesToken_(consumes<std::vector<reco::Vertex>>(iConfig.getParameter<edm::InputTag>("vertices"))),
-  muonsToken_(consumes<edm::View<reco::Muon>>(iConfig.getParameter<edm::InputTag>("muons")))
+  primaryVertexToken_(consumes<int>(iConfig.getParameter<edm::InputTag>("primaryVertex"))),
+  muonsToken_(consumes<edm::View<reco::Muon>>(iConfig.getParameter<edm::InputTag>("muons"))),
+  outputPtrs_(iConfig.getParameter<bool>("outputPtrs")),
+  timer_(iConfig, {"inputs", "muons", "put"}),
+  cutFlow_(iConfig, "muons", {"pt", "eta", "loose", "medium", "tight"})
 {
   PUPPINoLeptonsIsolation_charged_hadrons_ = consumes<edm::ValueMap<float> >(iConfig.getParameter<edm::InputTag>("puppiNoLepIsolationChargedHadrons"));
   PUPPINoLeptonsIsolation_neutral_hadrons_ = consumes<edm::ValueMap<float> >(iConfig.getParameter<edm::InputTag>("puppiNoLepIsolationNeutralHadrons"));
   PUPPINoLeptonsIsolation_photons_ = consumes<edm::ValueMap<float> >(iConfig.getParameter<edm::InputTag>("puppiNoLepIsolationPhotons"));
   
-  produces<std::vector<reco::Muon>>("LooseMuons");
-  produces<std::vector<double>>("LooseMuonRelIso");
-  produces<std::vector<reco::Muon>>("MediumMuons");
-  produces<std::vector<double>>("MediumMuonRelIso");
-  produces<std::vector<reco::Muon>>("TightMuons");
-  produces<std::vector<double>>("TightMuonRelIso");
+  if (outputPtrs_) {
+    produces<edm::PtrVector<reco::Muon>>("LooseMuons");
+    produces<edm::PtrVector<reco::Muon>>("MediumMuons");
+    produces<edm::PtrVector<reco::Muon>>("TightMuons");
+    produces<edm::ValueMap<double>>("MuonRelIso");
+  } else {
+    produces<std::vector<reco::Muon>>("LooseMuons");
+    produces<std::vector<double>>("LooseMuonRelIso");
+    produces<std::vector<reco::Muon>>("MediumMuons");
+    produces<std::vector<double>>("MediumMuonRelIso");
+    produces<std::vector<reco::Muon>>("TightMuons");
+    produces<std::vector<double>>("TightMuonRelIso");
+  }
 }
 
 void
@@ -115,7 +137,7 @@ RecoMuonFilter::beginRun(edm::Run const& iRun, edm::EventSetup const& iSetup)
 {
   edm::ESHandle<ME0Geometry> hGeom;
   iSetup.get<MuonGeometryRecord>().get(hGeom);
-  ME0Geometry_ =( &*hGeom);
+  me0Chambers_.setGeometry(&*hGeom);
 }
 
 RecoMuonFilter::~RecoMuonFilter()
@@ -136,15 +158,14 @@ RecoMuonFilter::~RecoMuonFilter()
 RecoMuonFilter::produce(edm::Event& iEvent, const edm::EventSetup& iSetup)
 {
   using namespace edm;
+
+  StageTimer::Scope timing(timer_, kInputs);
   Handle<std::vector<reco::Vertex>> vertices;
   iEvent.getByToken(verticesToken_, vertices);
-  // Vertices
-  int prVtx = -1;
-  for (size_t i = 0; i < vertices->size(); i++) {
-    if (vertices->at(i).isFake()) continue;
-    if (vertices->at(i).ndof() <= 4) continue;
-    if (prVtx < 0) prVtx = i;
-  }
+  // Primary vertex, -1 if none
+  Handle<int> primaryVertex;
+  iEvent.getByToken(primaryVertexToken_, primaryVertex);
+  const int prVtx = *primaryVertex;
 
   Handle<View<reco::Muon> > muons;
   iEvent.getByToken(muonsToken_, muons);
@@ -156,36 +177,28 @@ RecoMuonFilter::produce(edm::Event& iEvent, const edm::EventSetup& iSetup)
   iEvent.getByToken(PUPPINoLeptonsIsolation_neutral_hadrons_, PUPPINoLeptonsIsolation_neutral_hadrons);
   iEvent.getByToken(PUPPINoLeptonsIsolation_photons_, PUPPINoLeptonsIsolation_photons);  
   
-  std::unique_ptr<std::vector<reco::Muon>> filteredLooseMuons;
-  std::unique_ptr<std::vector<double>> filteredLooseMuonRelIso;
-  std::unique_ptr<std::vector<reco::Muon>> filteredMediumMuons;
-  std::unique_ptr<std::vector<double>> filteredMediumMuonRelIso;
-  std::unique_ptr<std::vector<reco::Muon>> filteredTightMuons;
-  std::unique_ptr<std::vector<double>> filteredTightMuonRelIso;
-  std::vector<reco::Muon> looseVec;
-  std::vector<double> looseIsoVec;
-  std::vector<reco::Muon> mediumVec;
-  std::vector<double> mediumIsoVec;
-  std::vector<reco::Muon> tightVec;
-  std::vector<double> tightIsoVec;
+  std::vector<unsigned int> looseIdx, mediumIdx, tightIdx;
+  std::vector<double> looseIsoVec, mediumIsoVec, tightIsoVec;
+  std::vector<double> relIsoValues(outputPtrs_ ? muons->size() : 0, -1.);
 
+  timing.next(kMuons);
   for (size_t i = 0; i < muons->size(); i++) {
-    if (muons->at(i).pt() < 2.) continue;
-    if (std::abs(muons->at(i).eta()) > 2.8) continue;
+    CutFlow::Object cuts(cutFlow_);
+    if (!cuts(kPt, muons->at(i).pt() >= 2.)) continue;
+    if (!cuts(kEta, std::abs(muons->at(i).eta()) <= 2.8)) continue;
 
     edm::RefToBase<reco::Muon> muref = muons->refAt(i);
     
     auto priVertex = vertices->at(prVtx);
-    auto muon = muons->at(i);
+    const auto & muon = muons->at(i);
     
     bool isLoose = muon::isLooseMuon(muon);
     bool isMedium = muon::isMediumMuon(muon);
     bool isTight = (prVtx > -0.5 && muon::isTightMuon(muon,priVertex));
 
-    double mom = muon.p();
-    double dPhiCut_ = std::min(std::max(1.2/mom,1.2/100),0.056);
-    double dPhiBendCut_ = std::min(std::max(0.2/mom,0.2/100),0.0096);
-    bool isLooseME0 = isME0MuonSelNew(muon, 0.077, dPhiCut_, dPhiBendCut_);
+    // the bending of the RECO segment itself, as this filter always did
+    ME0MatchSummary me0Match(muon, me0Chambers_, true);
+    bool isLooseME0 = me0Match.passes(ME0MatchSummary::kLoose);
 
     bool ipxy = false, ipz = false, validPxlHit = false, highPurity = false;
     if (muon.innerTrack().isNonnull()){
@@ -195,48 +208,55 @@ RecoMuonFilter::produce(edm::Event& iEvent, const edm::EventSetup& iSetup)
       highPurity = muon.innerTrack()->quality(reco::Track::highPurity);
     }
     // isMediumME0 - just loose with track requirements for now, this needs to be updated
-    bool isMediumME0 = isME0MuonSelNew(muon, 0.077, dPhiCut_, dPhiBendCut_) && ipxy && validPxlHit && highPurity;
+    bool isMediumME0 = isLooseME0 && ipxy && validPxlHit && highPurity;
 
-    // tighter cuts for tight ME0
-    dPhiCut_ = std::min(std::max(1.2/mom,1.2/100),0.032);
-    dPhiBendCut_ = std::min(std::max(0.2/mom,0.2/100),0.0041);
-    bool isTightME0 = isME0MuonSelNew(muon, 0.048, dPhiCut_, dPhiBendCut_) && ipxy && ipz && validPxlHit && highPurity;
+    bool isTightME0 = me0Match.passes(ME0MatchSummary::kTight) && ipxy && ipz && validPxlHit && highPurity;
     
     double muon_puppiIsoNoLep_ChargedHadron = (*PUPPINoLeptonsIsolation_charged_hadrons)[muref];
     double muon_puppiIsoNoLep_NeutralHadron = (*PUPPINoLeptonsIsolation_neutral_hadrons)[muref];
     double muon_puppiIsoNoLep_Photon = (*PUPPINoLeptonsIsolation_photons)[muref];
     double relIso = (muon_puppiIsoNoLep_ChargedHadron+muon_puppiIsoNoLep_NeutralHadron+muon_puppiIsoNoLep_Photon)/muon.pt();
+    if (outputPtrs_) relIsoValues[i] = relIso;
     
-    if (isLoose || (std::abs(muon.eta()) > 2.4 && isLooseME0) ){
-      looseVec.push_back(muon);
+    bool passLoose = isLoose || (std::abs(muon.eta()) > 2.4 && isLooseME0);
+    bool passMedium = isMedium || (std::abs(muon.eta()) > 2.4 && isMediumME0);
+    bool passTight = isTight || (std::abs(muon.eta()) > 2.4 && isTightME0);
+    // the working points are not nested, the flow follows them as if they were
+    cuts(kLoose, passLoose);
+    cuts(kMedium, passMedium);
+    cuts(kTight, passTight);
+
+    if (passLoose){
+      looseIdx.push_back(i);
       looseIsoVec.push_back(relIso);
     }
 
-    if (isMedium || (std::abs(muon.eta()) > 2.4 && isMediumME0) ){
-      mediumVec.push_back(muon);
+    if (passMedium){
+      mediumIdx.push_back(i);
       mediumIsoVec.push_back(relIso);
     }
     
-    if (isTight || (std::abs(muon.eta()) > 2.4 && isTightME0) ){
-      tightVec.push_back(muon);
+    if (passTight){
+      tightIdx.push_back(i);
       tightIsoVec.push_back(relIso);
     }
 
   }
 
-  filteredLooseMuons.reset(new std::vector<reco::Muon>(looseVec));
-  filteredLooseMuonRelIso.reset(new std::vector<double>(looseIsoVec));
-  filteredMediumMuons.reset(new std::vector<reco::Muon>(mediumVec));
-  filteredMediumMuonRelIso.reset(new std::vector<double>(mediumIsoVec));
-  filteredTightMuons.reset(new std::vector<reco::Muon>(tightVec));
-  filteredTightMuonRelIso.reset(new std::vector<double>(tightIsoVec));
+  timing.next(kPut);
+  selectedobjects::put<reco::Muon>(iEvent, muons, looseIdx, outputPtrs_, "LooseMuons");
+  selectedobjects::put<reco::Muon>(iEvent, muons, mediumIdx, outputPtrs_, "MediumMuons");
+  selectedobjects::put<reco::Muon>(iEvent, muons, tightIdx, outputPtrs_, "TightMuons");
+  if (outputPtrs_) {
+    selectedobjects::putValueMap(iEvent, muons, relIsoValues, "MuonRelIso");
+  } else {
+    iEvent.put(std::unique_ptr<std::vector<double>>(new std::vector<double>(std::move(looseIsoVec))), "LooseMuonRelIso");
+    iEvent.put(std::unique_ptr<std::vector<double>>(new std::vector<double>(std::move(mediumIsoVec))), "MediumMuonRelIso");
+    iEvent.put(std::unique_ptr<std::vector<double>>(new std::vector<double>(std::move(tightIsoVec))), "TightMuonRelIso");
+  }
 
-  iEvent.put(std::move(filteredLooseMuons), "LooseMuons");
-  iEvent.put(std::move(filteredLooseMuonRelIso), "LooseMuonRelIso");
-  iEvent.put(std::move(filteredMediumMuons), "MediumMuons");
-  iEvent.put(std::move(filteredMediumMuonRelIso), "MediumMuonRelIso");
-  iEvent.put(std::move(filteredTightMuons), "TightMuons");
-  iEvent.put(std::move(filteredTightMuonRelIso), "TightMuonRelIso");
+  timing.stop();
+  timer_.endEvent();
 
   return;
 }
@@ -250,11 +270,13 @@ RecoMuonFilter::beginStream(edm::StreamID)
 // ------------ method called once each stream after processing all runs, lumis and events  ------------
 void
 RecoMuonFilter::endStream() {
+  timer_.finish();
+  cutFlow_.finish();
 }
 
 // ------------ method to improve ME0 muon ID ----------------
   bool 
-RecoMuonFilter::isME0MuonSel(reco::Muon muon, double pullXCut, double dXCut, double pullYCut, double dYCut, double dPhi)
+RecoMuonFilter::isME0MuonSel(const reco::Muon & muon, double pullXCut, double dXCut, double pullYCut, double dYCut, double dPhi)
 {
 
   bool result = false;
@@ -299,53 +321,6 @@ RecoMuonFilter::isME0MuonSel(reco::Muon muon, double pullXCut, double dXCut, dou
 
 }
 
-bool RecoMuonFilter::isME0MuonSelNew(reco::Muon muon, double dEtaCut, double dPhiCut, double dPhiBendCut)
-{
-    
-    bool result = false;
-    bool isME0 = muon.isME0Muon();
-    
-    if(isME0){
-        
-        double deltaEta = 999;
-        double deltaPhi = 999;
-        double deltaPhiBend = 999;
-
-        const std::vector<reco::MuonChamberMatch>& chambers = muon.matches();
-        for( std::vector<reco::MuonChamberMatch>::const_iterator chamber = chambers.begin(); chamber != chambers.end(); ++chamber ){
-            
-            if (chamber->detector() == 5){
-            
-                for ( std::vector<reco::MuonSegmentMatch>::const_iterator segment = chamber->me0Matches.begin(); segment != chamber->me0Matches.end(); ++segment ){
-                
-                    LocalPoint trk_loc_coord(chamber->x, chamber->y, 0);
-                    LocalPoint seg_loc_coord(segment->x, segment->y, 0);
-                    LocalVector trk_loc_vec(chamber->dXdZ, chamber->dYdZ, 1);
-                    
-                    const ME0Chamber * me0chamber = ME0Geometry_->chamber(chamber->id);
-                    
-                    GlobalPoint trk_glb_coord = me0chamber->toGlobal(trk_loc_coord);
-                    GlobalPoint seg_glb_coord = me0chamber->toGlobal(seg_loc_coord);
-                    
-                    double segDPhi = segment->me0SegmentRef->deltaPhi();
-                    double trackDPhi = me0chamber->computeDeltaPhi(trk_loc_coord, trk_loc_vec);
-                    
-                    deltaEta = std::abs(trk_glb_coord.eta() - seg_glb_coord.eta() );
-                    deltaPhi = std::abs(trk_glb_coord.phi() - seg_glb_coord.phi() );
-                    deltaPhiBend = std::abs(segDPhi - trackDPhi);
-                    
-                    if (deltaEta < dEtaCut && deltaPhi < dPhiCut && deltaPhiBend < dPhiBendCut) result = true;
-                    
-                }
-            }
-        }
-        
-    }
-    
-    return result;
-    
-}
-
 // ------------ method called when starting to processes a run  ------------
 /*
    void
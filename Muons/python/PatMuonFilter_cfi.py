@@ -2,5 +2,8 @@ import FWCore.ParameterSet.Config as cms
 
 muonfilter = cms.EDProducer('PatMuonFilter',
         vertices      = cms.InputTag("offlineSlimmedPrimaryVertices"),
+        primaryVertex = cms.InputTag("primaryVertexSelector"),
         muons         = cms.InputTag("slimmedMuons"),
+        outputPtrs    = cms.bool(False),
+        timing        = cms.untracked.bool(False),
 )
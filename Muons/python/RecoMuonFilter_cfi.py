@@ -2,10 +2,13 @@ import FWCore.ParameterSet.Config as cms
 
 muonfilter = cms.EDProducer('RecoMuonFilter',
         vertices      = cms.InputTag("offlinePrimaryVertices"),
+        primaryVertex = cms.InputTag("primaryVertexSelector"),
         muons         = cms.InputTag("muons"),
         puppiNoLepIsolationChargedHadrons = cms.InputTag("muonIsolationPUPPINoLep","h+-DR040-ThresholdVeto000-ConeVeto000"),
         puppiNoLepIsolationNeutralHadrons = cms.InputTag("muonIsolationPUPPINoLep","h0-DR040-ThresholdVeto000-ConeVeto001"),
         puppiNoLepIsolationPhotons        = cms.InputTag("muonIsolationPUPPINoLep","gamma-DR040-ThresholdVeto000-ConeVeto001"),    
+        outputPtrs    = cms.bool(False),
+        timing        = cms.untracked.bool(False),
 )
 
 IsoConeDefinitions = cms.VPSet(
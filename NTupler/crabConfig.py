@@ -9,8 +9,6 @@ config.section_("JobType")
 config.JobType.pluginName = 'Analysis'
 config.JobType.psetName = 'scripts/produceNtuples_cfg.py'
 config.JobType.pyCfgParams= ['skim=False','inputFormat=PAT','outFileName=MiniEvents.root']
-# Uncomment the following line when running on PAT events
-#config.JobType.inputFiles = ['TMVAClassification_BDT.weights.xml']
 config.JobType.outputFiles = ['MiniEvents.root']
 
 config.section_("Data")
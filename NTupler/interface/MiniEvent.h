@@ -8,41 +8,103 @@
 
 #include "TTree.h"
 
+#include <deque>
+#include <vector>
+
+// The collections are stored in vectors that only grow when a stream needs
+// more entries than it ever had, so that the per-stream buffers stay small.
+// Every collection has a fixed capacity (kMax*), which is also the size of
+// the buffer bound to the branches by MiniEventWriter: the add*() methods
+// return false once it is reached and the dropped object is counted in
+// ntrunc instead of being written past the end of the arrays.
 struct MiniEvent_t
 {
+  static const int kMaxGenParticles = 50, kMaxGenJets = 200, kMaxVertices = 200;
+  static const int kMaxLeptons = 50, kMaxJets = 200, kMaxMET = 10;
+
   MiniEvent_t()
   {
-    ngl=0; ngj=0;  
+    reset();
+  }
+
+  void reset()
+  {
+    ngl=0; ngj=0; nvtx=0;
     nle=0; nte = 0; nlm=0; ntm=0; nj=0; nmet=0;
+    ntrunc=0;
   }
 
-  Int_t run,event,lumi;
+  // make room for one more entry at index n*, false if the collection is full
+  bool addGenParticle();
+  bool addGenJet();
+  bool addVertex();
+  bool addLooseElectron();
+  bool addTightElectron();
+  bool addLooseMuon();
+  bool addTightMuon();
+  bool addJet();
+  bool addMET();
 
+  // size all the collections to their capacity, for a buffer bound to branches
+  void allocate();
+  // copy the filled entries into a buffer sized by allocate()
+  void copyTo(MiniEvent_t &ev) const;
+
+  Int_t run,event,lumi;
+  Int_t ntrunc;
 
   //gen level event
   Int_t ng,ngj,ngl;
-  Float_t gl_p[50], gl_px[50], gl_py[50], gl_pz[50], gl_nrj[50], gl_pt[50], gl_eta[50], gl_phi[50], gl_mass[50], gl_relIso[50];
-  Int_t gl_pid[50], gl_ch[50], gl_st[50];
-  Float_t gj_pt[200], gj_eta[200], gj_phi[200], gj_mass[200];
+  std::vector<Float_t> gl_p, gl_px, gl_py, gl_pz, gl_nrj, gl_pt, gl_eta, gl_phi, gl_mass, gl_relIso;
+  std::vector<Int_t> gl_pid, gl_ch, gl_st;
+  std::vector<Float_t> gj_pt, gj_eta, gj_phi, gj_mass;
 
   //reco level event
   Int_t nvtx;
-  Float_t v_pt2[200];
+  std::vector<Float_t> v_pt2;
   Int_t nle, nte, nlm, ntm, nj, nmet;
-  Int_t le_ch[50], le_g[50];
-  Float_t le_pt[50], le_eta[50], le_phi[50], le_mass[50], le_relIso[50];
-  Int_t te_ch[50], te_g[50];
-  Float_t te_pt[50], te_eta[50], te_phi[50], te_mass[50], te_relIso[50];
-  Int_t lm_ch[50], lm_g[50];
-  Float_t lm_pt[50], lm_eta[50], lm_phi[50], lm_mass[50], lm_relIso[50];
-  Int_t tm_ch[50], tm_g[50];
-  Float_t tm_pt[50], tm_eta[50], tm_phi[50], tm_mass[50], tm_relIso[50];
-  Int_t j_id[200], j_g[200], j_mvav2[200], j_deepcsv[200], j_flav[200], j_hadflav[200], j_pid[200];
-  Float_t j_pt[200], j_eta[200], j_phi[200], j_mass[200];
-  Float_t met_pt[10], met_eta[10], met_phi[10];
+  std::vector<Int_t> le_ch, le_g;
+  std::vector<Float_t> le_pt, le_eta, le_phi, le_mass, le_relIso;
+  std::vector<Int_t> te_ch, te_g;
+  std::vector<Float_t> te_pt, te_eta, te_phi, te_mass, te_relIso;
+  std::vector<Int_t> lm_ch, lm_g;
+  std::vector<Float_t> lm_pt, lm_eta, lm_phi, lm_mass, lm_relIso;
+  std::vector<Int_t> tm_ch, tm_g;
+  std::vector<Float_t> tm_pt, tm_eta, tm_phi, tm_mass, tm_relIso;
+  std::vector<Int_t> j_id, j_g, j_mvav2, j_deepcsv, j_flav, j_hadflav, j_pid;
+  std::vector<Float_t> j_pt, j_eta, j_phi, j_mass;
+  std::vector<Float_t> met_pt, met_eta, met_phi;
+
+};
 
+// Compact layout of the trees: the pseudorapidities, masses and isolations
+// are stored as Float16_t with a 10-bit mantissa and the azimuthal angles
+// as Float16_t over [-pi, pi] with 12 bits (ROOT >= 6.16, full floats
+// before), and the bit flags and small integers (charges, jet ID, b-tag
+// working points, flavours) as Char_t. The Char_t branches are bound to
+// 8-bit copies of the Int_t columns, which update() refreshes before the
+// trees are filled.
+class MiniEventCompactColumns
+{
+ public:
+  Char_t * add(const std::vector<Int_t> & from, const Int_t * size);
+  void update();
+
+ private:
+  struct Column
+  {
+    const std::vector<Int_t> * from;
+    const Int_t * size;
+    std::vector<Char_t> to;
+  };
+  // stable addresses, the buffers are bound to branches
+  std::deque<Column> columns_;
 };
 
-void createMiniEventTree(TTree *t_event_, TTree *t_genParts_, TTree *t_vertices_, TTree *t_genJets_, TTree *t_looseElecs_, TTree *t_tightElecs_, TTree *t_looseMuons_, TTree *t_tightMuons_, TTree *t_puppiJets_, TTree *t_puppiMET_,MiniEvent_t &ev);
+void createMiniEventTree(TTree *t_event_, TTree *t_genParts_, TTree *t_vertices_, TTree *t_genJets_, TTree *t_looseElecs_, TTree *t_tightElecs_, TTree *t_looseMuons_, TTree *t_tightMuons_, TTree *t_puppiJets_, TTree *t_puppiMET_,MiniEvent_t &ev, MiniEventCompactColumns *compact = 0);
+// single-tree layout: all collections in one tree, branch names prefixed by the collection name
+void createMiniEventTree(TTree *t_event_, MiniEvent_t &ev, MiniEventCompactColumns *compact = 0);
+// both bind the branches to the vectors of ev, which must be allocate()d
+// first; with compact, the branches use the compact layout
 
 #endif
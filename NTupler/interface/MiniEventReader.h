@@ -0,0 +1,122 @@
+#ifndef _minieventreader_h_
+#define _minieventreader_h_
+// -*- C++ -*-
+//
+// Package:     PhaseTwoAnalysis/NTupler
+// Class:       MiniEventReader
+// Description: compiled columnar reader of the MiniEvent ntuples
+//
+// The columns an analysis needs are declared once, by collection and branch
+// name as booked by createMiniEventTree, and only those branches are read.
+// run() calls the analysis once per event with an Entry giving the columns
+// of the event as typed spans; with nThreads > 1 the events are processed
+// cluster by cluster on ROOT's implicit multithreading pool
+// (TTreeProcessorMT, ROOT >= 6.12), with one Entry per task, so the analysis
+// must only touch thread-local or synchronized state.
+//
+//   MiniEventReader reader({"MiniEvents.root"});
+//   auto pt  = reader.column<Float_t>("ElectronTight", "PT");
+//   auto eta = reader.column<Float_t>("ElectronTight", "Eta");
+//   reader.run([&](const MiniEventReader::Entry & ev) {
+//     MiniEventReader::Span<Float_t> elPt = ev.get(pt);
+//     for (size_t i = 0; i < elPt.size(); i++) ...
+//   }, 8);
+//
+// Both layouts are read: the single "Events" tree of singleTree=True
+// ("ElectronTight_PT"), and the per-collection trees joined by entry as
+// friends of the "Event" tree ("ElectronTight.PT"). Multithreading needs
+// the single-tree layout: the per-collection trees, the default of the
+// ntuplers, are always read sequentially whatever nThreads. The RNTuple
+// backend is not read.
+// The columns are read with their stored type: Int_t and Float_t, or Char_t
+// for the flags of the compact layout.
+
+#include "Rtypes.h"
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+class TTreeReader;
+template <typename T> class TTreeReaderArray;
+template <typename T> class TTreeReaderValue;
+
+class MiniEventReader
+{
+ public:
+  // the ntuplers write into the directory of their module label
+  explicit MiniEventReader(const std::vector<std::string> & files, const std::string & directory = "ntuple");
+  ~MiniEventReader();
+
+  template <class T> struct Column
+  {
+    unsigned int index;
+  };
+
+  template <class T> class Span
+  {
+   public:
+    Span(const T *data, size_t size) : data_(data), size_(size) {}
+    const T * begin() const { return data_; }
+    const T * end() const { return data_ + size_; }
+    const T & operator[](size_t i) const { return data_[i]; }
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+   private:
+    const T *data_;
+    size_t size_;
+  };
+
+  // declare a column, before run()
+  template <class T> Column<T> column(const std::string & collection, const std::string & name);
+
+  // the columns of the current event, in one thread
+  class Entry
+  {
+   public:
+    Entry(TTreeReader & reader, const MiniEventReader & owner);
+    ~Entry();
+
+    bool next();
+    Int_t run() const;
+    Int_t event() const;
+    Int_t lumi() const;
+
+    Span<Int_t> get(Column<Int_t> column) const;
+    Span<Float_t> get(Column<Float_t> column) const;
+    Span<Char_t> get(Column<Char_t> column) const;
+
+   private:
+    void checkSetup() const;
+
+    TTreeReader & reader_;
+    const MiniEventReader & owner_;
+    bool checked_;
+    std::unique_ptr<TTreeReaderValue<Int_t>> run_, event_, lumi_;
+    std::vector<std::unique_ptr<TTreeReaderArray<Int_t>>> ints_;
+    std::vector<std::unique_ptr<TTreeReaderArray<Float_t>>> floats_;
+    std::vector<std::unique_ptr<TTreeReaderArray<Char_t>>> chars_;
+  };
+
+  // calls process for every event, on nThreads threads if > 1 and the
+  // ntuples have the single-tree layout; returns the number of events
+  unsigned long run(const std::function<void(const Entry &)> & process, unsigned int nThreads = 1) const;
+
+ private:
+  std::string branch(const std::string & collection, const std::string & name) const;
+
+  std::vector<std::string> files_;
+  std::string directory_;
+  bool singleTree_;
+  std::vector<std::string> collections_;
+  std::vector<std::string> intBranches_, floatBranches_, charBranches_;
+};
+
+template <> MiniEventReader::Column<Int_t> MiniEventReader::column<Int_t>(const std::string & collection, const std::string & name);
+template <> MiniEventReader::Column<Float_t> MiniEventReader::column<Float_t>(const std::string & collection, const std::string & name);
+template <> MiniEventReader::Column<Char_t> MiniEventReader::column<Char_t>(const std::string & collection, const std::string & name);
+
+#endif
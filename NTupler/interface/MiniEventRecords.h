@@ -0,0 +1,57 @@
+#ifndef _minieventrecords_h_
+#define _minieventrecords_h_
+// -*- C++ -*-
+//
+// Package:     PhaseTwoAnalysis/NTupler
+// Class:       MiniEventRecords
+// Description: one entry of each MiniEvent collection, for the RNTuple output
+//
+// With the RNTuple backend of MiniEventWriter every collection is a
+// std::vector of these records ("ElectronLoose.PT" instead of the
+// "PT[ElectronLoose_size]" leaflist of the trees); the members are named
+// after the branches of createMiniEventTree. The dictionaries are declared
+// in src/classes_def.xml.
+
+#include "Rtypes.h"
+
+#include <vector>
+
+namespace minievent {
+
+  struct Particle
+  {
+    Int_t PID, Charge, Status;
+    Float_t P, Px, Py, Pz, E, PT, Eta, Phi, Mass, IsolationVar;
+  };
+
+  struct GenJet
+  {
+    Float_t PT, Eta, Phi, Mass;
+  };
+
+  struct Vertex
+  {
+    Float_t SumPT2;
+  };
+
+  struct Lepton
+  {
+    Int_t Charge, Particle;
+    Float_t PT, Eta, Phi, Mass, IsolationVar;
+  };
+
+  struct Jet
+  {
+    Int_t ID, GenJet;
+    Float_t PT, Eta, Phi, Mass;
+    Int_t MVAv2, DeepCSV, PartonFlavor, HadronFlavor, GenPartonPID;
+  };
+
+  struct MissingET
+  {
+    Float_t MET, Phi, Eta;
+  };
+
+}
+
+#endif
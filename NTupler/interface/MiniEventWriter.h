@@ -0,0 +1,93 @@
+#ifndef _minieventwriter_h_
+#define _minieventwriter_h_
+// -*- C++ -*-
+//
+// Package:     PhaseTwoAnalysis/NTupler
+// Class:       MiniEventWriter
+// Description: serialized output path for the MiniEvent trees
+//
+// One instance is shared by all the streams of a MiniFromReco/MiniFromPat
+// module (as its edm::GlobalCache). The trees are booked once in the
+// TFileService; each stream fills its own MiniEvent_t and hands it over to
+// fill(), which copies it into the buffer bound to the branches and fills
+// the trees under a lock. Only this copy and the TTree::Fill calls are
+// serialized, the object selection runs concurrently in the streams.
+//
+// The layout and the I/O settings come from the "output" PSet of the module:
+//   backend              - "TTree" (default) or "RNTuple": one "Events"
+//                          RNTuple with a vector-of-records field per
+//                          collection (see MiniEventRecords.h), available
+//                          with ROOT >= 6.34
+//   compact              - reduced-precision floats and 8-bit flags, see
+//                          MiniEventCompactColumns in MiniEvent.h
+//   singleTree           - one "Events" tree with prefixed branch names
+//                          instead of one tree per collection
+//   basketSize           - basket size in bytes of every branch (0: ROOT default)
+//   autoFlush            - cluster size, >0 in entries, <0 in bytes (0: ROOT default)
+//   compressionAlgorithm - "ZLIB", "LZMA" or "LZ4" ("": output file setting)
+//   compressionLevel     - compression level used with compressionAlgorithm
+//   checkpointLumis      - write the output file every this many luminosity
+//                          blocks (0: only at the end of the job)
+// compact, basketSize and singleTree only apply to the trees; with the RNTuple a
+// negative autoFlush is the approximate compressed size of the clusters.
+//
+// Every completed luminosity block is recorded in the "Lumis" tree (Run,
+// Lumi, and the number of Events written). With checkpointLumis, the whole
+// output file (trees, Lumis and the histograms of the other modules, e.g.
+// the event weights) is written at the end of the luminosity blocks, so
+// that the file of a job that stops early is readable and holds exactly the
+// events of the luminosity blocks listed in Lumis at its last checkpoint;
+// another job can then skip them (resumeFrom in produceNtuples_cfg.py).
+// This assumes that the luminosity blocks are processed one at a time, as
+// the TFileService requires. The RNTuple is only readable once committed at
+// the end of the job, it cannot be checkpointed.
+
+#include "PhaseTwoAnalysis/NTupler/interface/MiniEvent.h"
+
+#include "FWCore/ParameterSet/interface/ParameterSet.h"
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+class MiniEventWriter
+{
+ public:
+  explicit MiniEventWriter(const edm::ParameterSet& iConfig);
+  ~MiniEventWriter();
+
+  // the events of a luminosity block, counted by the streams
+  struct LumiSummary
+  {
+    unsigned long events = 0;
+  };
+
+  void fill(const MiniEvent_t & ev) const;
+  // records a completed luminosity block, and checkpoints the output file
+  void endLuminosityBlock(int run, int lumi, unsigned long events) const;
+  // warn about the events in which a collection exceeded its capacity
+  void report() const;
+  // commits the RNTuple, to be called before the TFileService closes the file
+  void close() const;
+
+ private:
+  struct RNTupleOutput;
+
+  void configure(TTree *tree, const edm::ParameterSet& outputConfig);
+  void bookRNTuple(const edm::ParameterSet& outputConfig);
+  void checkpoint() const;
+
+  mutable std::mutex mutex_;
+  mutable MiniEvent_t ev_;
+  mutable MiniEventCompactColumns compact_;
+  mutable unsigned long nTruncatedEvents_, nTruncatedObjects_;
+
+  std::vector<TTree *> trees_;
+  TTree *lumis_;
+  mutable Int_t lumiRun_, lumiLumi_, lumiEvents_;
+  int checkpointLumis_;
+  mutable int lumisSinceCheckpoint_;
+  mutable std::unique_ptr<RNTupleOutput> rntuple_;
+};
+
+#endif
@@ -0,0 +1,592 @@
+#ifndef _minianalyzercore_h_
+#define _minianalyzercore_h_
+// -*- C++ -*-
+//
+// Package:     PhaseTwoAnalysis/NTupler
+// Class:       MiniAnalyzerCore
+// Description: flat ntupler shared by MiniFromReco and MiniFromPat
+//
+// The gen analysis, the vertex, muon and jet selections, the jet-lepton
+// cleaning, the gen matching of the selected objects and the filling of the
+// trees are written once, for an input-format policy given as template
+// argument: RecoFormat (MiniFromReco.cc) or PatFormat (MiniFromPat.cc). The
+// policy holds the collection types, the gen-level thresholds and the parts
+// that depend on the format (its own inputs, the muon isolation, the
+// electron ID and isolation, the jet ID and b tagging), so that both paths
+// are generated at compile time without any branching on the format.
+//
+// A policy provides
+//   typedefs Electron, Muon, Jet, MET, GenParticle
+//   static constexpr double genJetPtMin, genLeptonPtMin
+//   static double genLeptonIsoCone(int absPdgId)
+//   static constexpr const char * metParameter    name of the MET InputTag
+//   Format(const edm::ParameterSet&, edm::ConsumesCollector&&)
+//   void getEvent(const edm::Event&, const edm::EventSetup&)
+//   double muonIso(const edm::Handle<std::vector<Muon>>&, size_t i)
+//   void prepareElectrons(const edm::Handle<std::vector<Electron>>&, const reco::Vertex&, const ConversionIndex&)
+//   unsigned int electronID(size_t i)             ElectronIDEvaluator::kLoose/kTight bits
+//   double electronIso(size_t i)                  called for the stored electrons only
+//   void fillJet(const Jet&, MiniEvent_t&, int j) ID, b tagging and flavour of jet j
+//   void endStream()
+//
+//   typedef MiniAnalyzerCore<RecoFormat> MiniFromReco;
+//   DEFINE_FWK_MODULE(MiniFromReco);
+//
+// With the looseMuons, looseElectrons and cleanedJets InputTags, the
+// edm::PtrVectors of the object filters run in the same job (outputPtrs),
+// the ntupler starts from the objects they selected instead of the whole
+// input collections: their pT, eta, loose ID and jet-lepton cleaning are not
+// redone, only the tight ID and the jet ID and b tagging are evaluated on
+// top, and the ntuples hold the loose leptons and the jets of the filters.
+// The PtrVectors must point into the input collections of the ntupler.
+
+#include "FWCore/Framework/interface/Frameworkfwd.h"
+#include "FWCore/Framework/interface/ConsumesCollector.h"
+#include "FWCore/Framework/interface/stream/EDAnalyzer.h"
+#include "FWCore/Framework/interface/Event.h"
+#include "FWCore/Framework/interface/LuminosityBlock.h"
+#include "FWCore/Framework/interface/ESHandle.h"
+#include "FWCore/ParameterSet/interface/ParameterSet.h"
+#include "FWCore/ParameterSet/interface/ConfigurationDescriptions.h"
+#include "FWCore/ParameterSet/interface/ParameterSetDescription.h"
+#include "FWCore/Utilities/interface/Exception.h"
+
+#include "DataFormats/BeamSpot/interface/BeamSpot.h"
+#include "DataFormats/Common/interface/PtrVector.h"
+#include "DataFormats/EgammaCandidates/interface/Conversion.h"
+#include "DataFormats/JetReco/interface/GenJet.h"
+#include "DataFormats/MuonReco/interface/Muon.h"
+#include "DataFormats/MuonReco/interface/MuonSelectors.h"
+#include "DataFormats/VertexReco/interface/Vertex.h"
+#include "Geometry/Records/interface/MuonGeometryRecord.h"
+#include "Geometry/GEMGeometry/interface/ME0Geometry.h"
+
+#include "PhaseTwoAnalysis/NTupler/interface/MiniEvent.h"
+#include "PhaseTwoAnalysis/NTupler/interface/MiniEventWriter.h"
+#include "PhaseTwoAnalysis/Common/interface/ConversionIndex.h"
+#include "PhaseTwoAnalysis/Common/interface/CutFlow.h"
+#include "PhaseTwoAnalysis/Common/interface/DeltaRKernels.h"
+#include "PhaseTwoAnalysis/Common/interface/ElectronIDEvaluator.h"
+#include "PhaseTwoAnalysis/Common/interface/GenTruthTable.h"
+#include "PhaseTwoAnalysis/Common/interface/JetConstituentSoA.h"
+#include "PhaseTwoAnalysis/Common/interface/ME0MatchSummary.h"
+#include "PhaseTwoAnalysis/Common/interface/OverlapRemover.h"
+#include "PhaseTwoAnalysis/Common/interface/StageTimer.h"
+
+#include <cmath>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Stream module: every stream owns its MiniEvent_t buffer and selection
+// tools, the trees are owned by the MiniEventWriter shared by all streams.
+// The events of each luminosity block are summed over the streams, and the
+// completed block handed to the writer (Lumis tree and checkpoints).
+
+template <class Format>
+class MiniAnalyzerCore : public edm::stream::EDAnalyzer<edm::GlobalCache<MiniEventWriter>, edm::LuminosityBlockSummaryCache<MiniEventWriter::LumiSummary>>  {
+  public:
+    explicit MiniAnalyzerCore(const edm::ParameterSet&, const MiniEventWriter*);
+
+    static std::unique_ptr<MiniEventWriter> initializeGlobalCache(const edm::ParameterSet&);
+    static std::shared_ptr<MiniEventWriter::LumiSummary> globalBeginLuminosityBlockSummary(const edm::LuminosityBlock&, const edm::EventSetup&, const LuminosityBlockContext*);
+    static void globalEndLuminosityBlockSummary(const edm::LuminosityBlock&, const edm::EventSetup&, const LuminosityBlockContext*, MiniEventWriter::LumiSummary*);
+    static void globalEndJob(const MiniEventWriter*);
+    static void fillDescriptions(edm::ConfigurationDescriptions& descriptions);
+
+  private:
+    virtual void beginRun(edm::Run const&, edm::EventSetup const&) override;
+    void genAnalysis(const edm::Event& iEvent, const edm::EventSetup& iSetup);
+    void recoAnalysis(const edm::Event& iEvent, const edm::EventSetup& iSetup);
+    virtual void analyze(const edm::Event&, const edm::EventSetup&) override;
+    virtual void beginLuminosityBlock(edm::LuminosityBlock const&, edm::EventSetup const&) override;
+    virtual void endLuminosityBlockSummary(edm::LuminosityBlock const&, edm::EventSetup const&, MiniEventWriter::LumiSummary*) const override;
+    virtual void endRun(edm::Run const&, edm::EventSetup const&) override;
+    virtual void endStream() override;
+
+    // the indices of the objects to select: all those of the collection, or
+    // the ones selected by the filters
+    template <class T>
+    void candidates(const edm::Event&, const edm::Handle<std::vector<T>>&, const edm::EDGetTokenT<edm::PtrVector<T>>&, std::vector<size_t>&) const;
+
+    typedef typename Format::Electron Electron;
+    typedef typename Format::Muon Muon;
+    typedef typename Format::Jet Jet;
+    typedef typename Format::MET MET;
+    typedef typename Format::GenParticle GenParticle;
+
+    // ----------member data ---------------------------
+
+    enum Stage {kGen = 0, kInputs, kMuons, kElectrons, kJets, kMET, kFill};
+    StageTimer timer_;
+    // the "stored" cuts count the objects dropped when the buffers of the
+    // event are full (Truncated)
+    enum MuonCut {kMuonPt = 0, kMuonEta, kMuonLoose, kMuonLooseStored, kMuonTight, kMuonTightStored};
+    enum ElectronCut {kElectronLoose = 0, kElectronLooseStored, kElectronTight, kElectronTightStored};
+    enum JetCut {kJetPt = 0, kJetEta, kJetOverlap, kJetStored};
+    CutFlow muonFlow_, electronFlow_, jetFlow_;
+
+    Format format_;
+
+    edm::EDGetTokenT<std::vector<reco::Vertex>> verticesToken_;
+    edm::EDGetTokenT<int> primaryVertexToken_;
+    edm::EDGetTokenT<std::vector<double>> vertexPt2Token_;
+    edm::EDGetTokenT<std::vector<Electron>> elecsToken_;
+    edm::EDGetTokenT<reco::BeamSpot> bsToken_;
+    edm::EDGetTokenT<std::vector<reco::Conversion>> convToken_;
+    edm::EDGetTokenT<std::vector<Muon>> muonsToken_;
+    edm::EDGetTokenT<std::vector<Jet>> jetsToken_;
+    edm::EDGetTokenT<std::vector<MET>> metToken_;
+    edm::EDGetTokenT<std::vector<GenParticle>> genPartsToken_;
+    edm::EDGetTokenT<std::vector<reco::GenJet>> genJetsToken_;
+    // objects of the filters, with fromFilters_
+    bool fromFilters_;
+    edm::EDGetTokenT<edm::PtrVector<Muon>> looseMuonsToken_;
+    edm::EDGetTokenT<edm::PtrVector<Electron>> looseElectronsToken_;
+    edm::EDGetTokenT<edm::PtrVector<Jet>> cleanedJetsToken_;
+    std::vector<size_t> muonIndices_, electronIndices_, jetIndices_;
+
+    ConversionIndex conversionIndex_;
+    GenTruthTable genTruth_;
+    ME0ChamberCache me0Chambers_;
+    JetConstituentSoA genJetConstituents_;
+    OverlapRemover jetOverlapLeptons_, genJetOverlapLeptons_;
+
+    MiniEvent_t ev_;
+    // events of the current luminosity block in this stream
+    unsigned long lumiEvents_;
+};
+
+//
+// constructors and destructor
+//
+template <class Format>
+MiniAnalyzerCore<Format>::MiniAnalyzerCore(const edm::ParameterSet& iConfig, const MiniEventWriter*):
+  timer_(iConfig, {"gen", "inputs", "muons", "electrons", "jets", "met", "fill"}),
+  muonFlow_(iConfig, "muons", {"pt", "eta", "loose", "loose stored", "tight", "tight stored"}),
+  electronFlow_(iConfig, "electrons", {"loose", "loose stored", "tight", "tight stored"}),
+  jetFlow_(iConfig, "jets", {"pt", "eta", "overlap", "stored"}),
+  format_(iConfig, consumesCollector()),
+  verticesToken_(consumes<std::vector<reco::Vertex>>(iConfig.getParameter<edm::InputTag>("vertices"))),
+  primaryVertexToken_(consumes<int>(iConfig.getParameter<edm::InputTag>("primaryVertex"))),
+  vertexPt2Token_(consumes<std::vector<double>>(edm::InputTag(iConfig.getParameter<edm::InputTag>("primaryVertex").label(), "Pt2",
+                                                              iConfig.getParameter<edm::InputTag>("primaryVertex").process()))),
+  elecsToken_(consumes<std::vector<Electron>>(iConfig.getParameter<edm::InputTag>("electrons"))),
+  bsToken_(consumes<reco::BeamSpot>(iConfig.getParameter<edm::InputTag>("beamspot"))),
+  convToken_(consumes<std::vector<reco::Conversion>>(iConfig.getParameter<edm::InputTag>("conversions"))),
+  muonsToken_(consumes<std::vector<Muon>>(iConfig.getParameter<edm::InputTag>("muons"))),
+  jetsToken_(consumes<std::vector<Jet>>(iConfig.getParameter<edm::InputTag>("jets"))),
+  metToken_(consumes<std::vector<MET>>(iConfig.getParameter<edm::InputTag>(Format::metParameter))),
+  genPartsToken_(consumes<std::vector<GenParticle>>(iConfig.getParameter<edm::InputTag>("genParts"))),
+  genJetsToken_(consumes<std::vector<reco::GenJet>>(iConfig.getParameter<edm::InputTag>("genJets"))),
+  fromFilters_(false),
+  lumiEvents_(0)
+{
+  const edm::InputTag looseMuons = iConfig.getParameter<edm::InputTag>("looseMuons");
+  const edm::InputTag looseElectrons = iConfig.getParameter<edm::InputTag>("looseElectrons");
+  const edm::InputTag cleanedJets = iConfig.getParameter<edm::InputTag>("cleanedJets");
+  fromFilters_ = !looseMuons.label().empty();
+  if (looseElectrons.label().empty() == fromFilters_ || cleanedJets.label().empty() == fromFilters_)
+    throw cms::Exception("Configuration") << "looseMuons, looseElectrons and cleanedJets must be set together";
+  if (fromFilters_) {
+    looseMuonsToken_ = consumes<edm::PtrVector<Muon>>(looseMuons);
+    looseElectronsToken_ = consumes<edm::PtrVector<Electron>>(looseElectrons);
+    cleanedJetsToken_ = consumes<edm::PtrVector<Jet>>(cleanedJets);
+  }
+}
+
+//
+// member functions
+//
+
+// ------------ objects to select -------------
+template <class Format>
+template <class T>
+  void
+MiniAnalyzerCore<Format>::candidates(const edm::Event& iEvent, const edm::Handle<std::vector<T>>& collection,
+                                     const edm::EDGetTokenT<edm::PtrVector<T>>& selectedToken, std::vector<size_t>& indices) const
+{
+  indices.clear();
+  if (!fromFilters_) {
+    for (size_t i = 0; i < collection->size(); i++) indices.push_back(i);
+    return;
+  }
+
+  edm::Handle<edm::PtrVector<T>> selected;
+  iEvent.getByToken(selectedToken, selected);
+  for (size_t k = 0; k < selected->size(); k++) {
+    const edm::Ptr<T> ptr = (*selected)[k];
+    if (ptr.id() != collection.id())
+      throw cms::Exception("Configuration") << "the objects of the filters do not point into the input collections of the ntupler (product "
+                                            << ptr.id() << " instead of " << collection.id() << ")";
+    indices.push_back(ptr.key());
+  }
+}
+
+// ------------ method to fill gen level event -------------
+template <class Format>
+  void
+MiniAnalyzerCore<Format>::genAnalysis(const edm::Event& iEvent, const edm::EventSetup& iSetup)
+{
+  using namespace edm;
+
+  Handle<std::vector<GenParticle>> genParts;
+  iEvent.getByToken(genPartsToken_, genParts);
+
+  Handle<std::vector<reco::GenJet>> genJets;
+  iEvent.getByToken(genJetsToken_, genJets);
+
+  // electrons and muons of the gen collection, read once for the jet
+  // cleaning and the lepton loop
+  genTruth_.build(*genParts);
+
+  // Jets, not overlapping with a gen electron or muon, whose constituents
+  // are also kept for the lepton isolation
+  genJetOverlapLeptons_.clear();
+  for (const GenTruthTable::Lepton & lepton : genTruth_.leptons())
+    genJetOverlapLeptons_.add(lepton.eta, lepton.phi, lepton.pt);
+  genJetOverlapLeptons_.build();
+  genJetConstituents_.clear();
+  ev_.ngj = 0;
+  for (size_t i = 0; i < genJets->size(); i++) {
+    if (genJets->at(i).pt() < Format::genJetPtMin) continue;
+    if (fabs(genJets->at(i).eta()) > 5) continue;
+
+    if (genJetOverlapLeptons_.overlaps(genJets->at(i))) continue;
+    genJetConstituents_.addJet(genJets->at(i));
+    if (!ev_.addGenJet()) continue;
+
+    ev_.gj_pt[ev_.ngj]   = genJets->at(i).pt();
+    ev_.gj_phi[ev_.ngj]  = genJets->at(i).phi();
+    ev_.gj_eta[ev_.ngj]  = genJets->at(i).eta();
+    ev_.gj_mass[ev_.ngj] = genJets->at(i).mass();
+    ev_.ngj++;
+  }
+
+  // Leptons
+  ev_.ngl = 0;
+  for (const GenTruthTable::Lepton & lepton : genTruth_.leptons()) {
+    const size_t i = lepton.index;
+    if (genParts->at(i).pt() < Format::genLeptonPtMin) continue;
+    if (fabs(genParts->at(i).eta()) > 3.) continue;
+    double genIso = genJetConstituents_.coneSum(genParts->at(i).eta(), genParts->at(i).phi(), 0.7, 0.01, Format::genLeptonIsoCone(abs(genParts->at(i).pdgId())));
+    genIso = genIso / genParts->at(i).pt();
+    if (!ev_.addGenParticle()) continue;
+    ev_.gl_pid[ev_.ngl]    = genParts->at(i).pdgId();
+    ev_.gl_ch[ev_.ngl]     = genParts->at(i).charge();
+    ev_.gl_st[ev_.ngl]     = genParts->at(i).status();
+    ev_.gl_p[ev_.ngl]      = genParts->at(i).p();
+    ev_.gl_px[ev_.ngl]     = genParts->at(i).px();
+    ev_.gl_py[ev_.ngl]     = genParts->at(i).py();
+    ev_.gl_pz[ev_.ngl]     = genParts->at(i).pz();
+    ev_.gl_nrj[ev_.ngl]    = genParts->at(i).energy();
+    ev_.gl_pt[ev_.ngl]     = genParts->at(i).pt();
+    ev_.gl_phi[ev_.ngl]    = genParts->at(i).phi();
+    ev_.gl_eta[ev_.ngl]    = genParts->at(i).eta();
+    ev_.gl_mass[ev_.ngl]   = genParts->at(i).mass();
+    ev_.gl_relIso[ev_.ngl] = genIso;
+    ev_.ngl++;
+  }
+
+}
+
+// ------------ method to fill reco level event -------------
+template <class Format>
+  void
+MiniAnalyzerCore<Format>::recoAnalysis(const edm::Event& iEvent, const edm::EventSetup& iSetup)
+{
+  using namespace edm;
+
+  StageTimer::Scope timing(timer_, kInputs);
+
+  format_.getEvent(iEvent, iSetup);
+
+  Handle<std::vector<reco::Vertex>> vertices;
+  iEvent.getByToken(verticesToken_, vertices);
+  Handle<int> primaryVertex;
+  iEvent.getByToken(primaryVertexToken_, primaryVertex);
+  Handle<std::vector<double>> vertexPt2;
+  iEvent.getByToken(vertexPt2Token_, vertexPt2);
+
+  Handle<std::vector<Electron>> elecs;
+  iEvent.getByToken(elecsToken_, elecs);
+  Handle<reco::ConversionCollection> conversions;
+  iEvent.getByToken(convToken_, conversions);
+  Handle<reco::BeamSpot> bsHandle;
+  iEvent.getByToken(bsToken_, bsHandle);
+  const reco::BeamSpot &beamspot = *bsHandle.product();
+  conversionIndex_.fill(*conversions, beamspot.position());
+
+  Handle<std::vector<Muon>> muons;
+  iEvent.getByToken(muonsToken_, muons);
+
+  Handle<std::vector<Jet>> jets;
+  iEvent.getByToken(jetsToken_, jets);
+
+  Handle<std::vector<MET>> met;
+  iEvent.getByToken(metToken_, met);
+
+  // Vertices, selected by the PrimaryVertexSelector
+  const int prVtx = *primaryVertex;
+  ev_.nvtx = 0;
+  for (double pt2 : *vertexPt2) {
+    if (!ev_.addVertex()) continue;
+    ev_.v_pt2[ev_.nvtx] = pt2;
+    ev_.nvtx++;
+  }
+  if (prVtx < 0) return;
+
+  // Muons
+  timing.next(kMuons);
+  ev_.nlm = 0;
+  ev_.ntm = 0;
+
+  // pT, eta and loose ID already applied by the muon filter with fromFilters_
+  candidates(iEvent, muons, looseMuonsToken_, muonIndices_);
+  for (size_t i : muonIndices_) {
+    CutFlow::Object cuts(muonFlow_);
+    if (!cuts(kMuonPt, fromFilters_ || muons->at(i).pt() >= 2.)) continue;
+    if (!cuts(kMuonEta, fromFilters_ || fabs(muons->at(i).eta()) <= 2.8)) continue;
+
+    // Loose ID
+    ME0MatchSummary me0Match(muons->at(i), me0Chambers_);
+    bool isLoose = fromFilters_ || (fabs(muons->at(i).eta()) < 2.4 && muon::isLooseMuon(muons->at(i))) || (fabs(muons->at(i).eta()) > 2.4 && me0Match.passes(ME0MatchSummary::kLoose));
+
+    // Medium ID -- needs to be updated
+    bool ipxy = false, ipz = false, validPxlHit = false, highPurity = false;
+    if (muons->at(i).innerTrack().isNonnull()){
+    	ipxy = std::abs(muons->at(i).muonBestTrack()->dxy(vertices->at(prVtx).position())) < 0.2;
+    	ipz = std::abs(muons->at(i).muonBestTrack()->dz(vertices->at(prVtx).position())) < 0.5;
+    	validPxlHit = muons->at(i).innerTrack()->hitPattern().numberOfValidPixelHits() > 0;
+    	highPurity = muons->at(i).innerTrack()->quality(reco::Track::highPurity);
+    }
+    // bool isMedium = (fabs(muons->at(i).eta()) < 2.4 && muon::isMediumMuon(muons->at(i))) || (fabs(muons->at(i).eta()) > 2.4 && me0Match.passes(ME0MatchSummary::kLoose) && ipxy && ipz && validPxlHit && highPurity);
+
+    // Tight ID
+    bool isTight = (fabs(muons->at(i).eta()) < 2.4 && vertices->size() > 0 && muon::isTightMuon(muons->at(i),vertices->at(prVtx))) || (fabs(muons->at(i).eta()) > 2.4 && me0Match.passes(ME0MatchSummary::kTight) && ipxy && ipz && validPxlHit && highPurity);
+
+    if (!cuts(kMuonLoose, isLoose)) continue;
+    if (!cuts(kMuonLooseStored, ev_.addLooseMuon())) continue;
+
+    double isoMu = format_.muonIso(muons, i);
+    ev_.lm_ch[ev_.nlm]     = muons->at(i).charge();
+    ev_.lm_pt[ev_.nlm]     = muons->at(i).pt();
+    ev_.lm_phi[ev_.nlm]    = muons->at(i).phi();
+    ev_.lm_eta[ev_.nlm]    = muons->at(i).eta();
+    ev_.lm_mass[ev_.nlm]   = muons->at(i).mass();
+    ev_.lm_relIso[ev_.nlm] = isoMu;
+    ev_.lm_g[ev_.nlm] = drkernels::lastWithin(ev_.lm_eta[ev_.nlm], ev_.lm_phi[ev_.nlm], ev_.gl_eta.data(), ev_.gl_phi.data(), ev_.ngl, 0.4, ev_.gl_pid.data(), 13);
+    ev_.nlm++;
+
+    if (!cuts(kMuonTight, isTight)) continue;
+    if (!cuts(kMuonTightStored, ev_.addTightMuon())) continue;
+
+    ev_.tm_ch[ev_.ntm]     = muons->at(i).charge();
+    ev_.tm_pt[ev_.ntm]     = muons->at(i).pt();
+    ev_.tm_phi[ev_.ntm]    = muons->at(i).phi();
+    ev_.tm_eta[ev_.ntm]    = muons->at(i).eta();
+    ev_.tm_mass[ev_.ntm]   = muons->at(i).mass();
+    ev_.tm_relIso[ev_.ntm] = isoMu;
+    ev_.tm_g[ev_.ntm] = drkernels::lastWithin(ev_.tm_eta[ev_.ntm], ev_.tm_phi[ev_.ntm], ev_.gl_eta.data(), ev_.gl_phi.data(), ev_.ngl, 0.4, ev_.gl_pid.data(), 13);
+    ev_.ntm++;
+  }
+
+  // Electrons
+  timing.next(kElectrons);
+  format_.prepareElectrons(elecs, vertices->at(prVtx), conversionIndex_);
+
+  ev_.nle = 0;
+  ev_.nte = 0;
+
+  // loose electrons of the electron filter with fromFilters_
+  candidates(iEvent, elecs, looseElectronsToken_, electronIndices_);
+  for (size_t i : electronIndices_) {
+    CutFlow::Object cuts(electronFlow_);
+    unsigned int elId = format_.electronID(i);
+    bool isLoose  = fromFilters_ || (elId & ElectronIDEvaluator::kLoose);
+    bool isTight  = elId & ElectronIDEvaluator::kTight;
+
+    if (!cuts(kElectronLoose, isLoose)) continue;
+    if (!cuts(kElectronLooseStored, ev_.addLooseElectron())) continue;
+
+    double isoEl = format_.electronIso(i);
+    ev_.le_ch[ev_.nle]     = elecs->at(i).charge();
+    ev_.le_pt[ev_.nle]     = elecs->at(i).pt();
+    ev_.le_phi[ev_.nle]    = elecs->at(i).phi();
+    ev_.le_eta[ev_.nle]    = elecs->at(i).eta();
+    ev_.le_mass[ev_.nle]   = elecs->at(i).mass();
+    ev_.le_relIso[ev_.nle] = isoEl;
+    ev_.le_g[ev_.nle] = drkernels::lastWithin(ev_.le_eta[ev_.nle], ev_.le_phi[ev_.nle], ev_.gl_eta.data(), ev_.gl_phi.data(), ev_.ngl, 0.4, ev_.gl_pid.data(), 11);
+    ev_.nle++;
+
+    if (!cuts(kElectronTight, isTight)) continue;
+    if (!cuts(kElectronTightStored, ev_.addTightElectron())) continue;
+
+    ev_.te_ch[ev_.nte]     = elecs->at(i).charge();
+    ev_.te_pt[ev_.nte]     = elecs->at(i).pt();
+    ev_.te_phi[ev_.nte]    = elecs->at(i).phi();
+    ev_.te_eta[ev_.nte]    = elecs->at(i).eta();
+    ev_.te_mass[ev_.nte]   = elecs->at(i).mass();
+    ev_.te_relIso[ev_.nte] = isoEl;
+    ev_.te_g[ev_.nte] = drkernels::lastWithin(ev_.te_eta[ev_.nte], ev_.te_phi[ev_.nte], ev_.gl_eta.data(), ev_.gl_phi.data(), ev_.ngl, 0.4, ev_.gl_pid.data(), 11);
+    ev_.nte++;
+  }
+
+  // Jets, not overlapping with any electron or muon
+  timing.next(kJets);
+  // (already cleaned by the jet filter with fromFilters_)
+  if (!fromFilters_) {
+    jetOverlapLeptons_.clear();
+    for (size_t j = 0; j < elecs->size(); j++) jetOverlapLeptons_.add(elecs->at(j));
+    for (size_t j = 0; j < muons->size(); j++) jetOverlapLeptons_.add(muons->at(j));
+    jetOverlapLeptons_.build();
+  }
+  ev_.nj = 0;
+  candidates(iEvent, jets, cleanedJetsToken_, jetIndices_);
+  for (size_t i : jetIndices_) {
+    CutFlow::Object cuts(jetFlow_);
+    if (!cuts(kJetPt, fromFilters_ || jets->at(i).pt() >= 20.)) continue;
+    if (!cuts(kJetEta, fromFilters_ || fabs(jets->at(i).eta()) <= 5)) continue;
+
+    if (!cuts(kJetOverlap, fromFilters_ || !jetOverlapLeptons_.overlaps(jets->at(i)))) continue;
+
+    if (!cuts(kJetStored, ev_.addJet())) continue;
+    format_.fillJet(jets->at(i), ev_, ev_.nj);
+    ev_.j_pt[ev_.nj]      = jets->at(i).pt();
+    ev_.j_phi[ev_.nj]     = jets->at(i).phi();
+    ev_.j_eta[ev_.nj]     = jets->at(i).eta();
+    ev_.j_mass[ev_.nj]    = jets->at(i).mass();
+    ev_.j_g[ev_.nj] = drkernels::firstWithin(ev_.j_eta[ev_.nj], ev_.j_phi[ev_.nj], ev_.gj_eta.data(), ev_.gj_phi.data(), ev_.ngj, 0.4);
+    ev_.nj++;
+
+  }
+
+  // MET
+  timing.next(kMET);
+  ev_.nmet = 0;
+  if (met->size() > 0 && ev_.addMET()) {
+    ev_.met_pt[ev_.nmet]  = met->at(0).pt();
+    ev_.met_eta[ev_.nmet] = met->at(0).eta();
+    ev_.met_phi[ev_.nmet] = met->at(0).phi();
+    ev_.nmet++;
+  }
+
+}
+
+// ------------ method called for each event  ------------
+template <class Format>
+  void
+MiniAnalyzerCore<Format>::analyze(const edm::Event& iEvent, const edm::EventSetup& iSetup)
+{
+
+  //analyze the event
+  ev_.reset();
+  if(!iEvent.isRealData()) {
+    StageTimer::Scope timing(timer_, kGen);
+    genAnalysis(iEvent, iSetup);
+  }
+  recoAnalysis(iEvent, iSetup);
+
+  //save event if at least one lepton at gen or reco level
+  ev_.run     = iEvent.id().run();
+  ev_.lumi    = iEvent.luminosityBlock();
+  ev_.event   = iEvent.id().event();
+  {
+    StageTimer::Scope timing(timer_, kFill);
+    globalCache()->fill(ev_);
+  }
+  lumiEvents_++;
+  timer_.endEvent();
+
+}
+
+// ------------ method called once each job, before the streams are constructed  ------------
+template <class Format>
+  std::unique_ptr<MiniEventWriter>
+MiniAnalyzerCore<Format>::initializeGlobalCache(const edm::ParameterSet& iConfig)
+{
+  return std::unique_ptr<MiniEventWriter>(new MiniEventWriter(iConfig));
+}
+
+// ------------ method called once each run ----------------
+template <class Format>
+  void
+MiniAnalyzerCore<Format>::beginRun(edm::Run const& iRun, edm::EventSetup const& iSetup)
+{
+  edm::ESHandle<ME0Geometry> hGeom;
+  iSetup.get<MuonGeometryRecord>().get(hGeom);
+  me0Chambers_.setGeometry(&*hGeom);
+}
+
+// ------------ method called when starting to process a luminosity block  ------------
+template <class Format>
+  void
+MiniAnalyzerCore<Format>::beginLuminosityBlock(edm::LuminosityBlock const&, edm::EventSetup const&)
+{
+  lumiEvents_ = 0;
+}
+
+// ------------ method adding the events of the stream to the luminosity block  ------------
+template <class Format>
+  void
+MiniAnalyzerCore<Format>::endLuminosityBlockSummary(edm::LuminosityBlock const&, edm::EventSetup const&, MiniEventWriter::LumiSummary* summary) const
+{
+  summary->events += lumiEvents_;
+}
+
+// ------------ method called once each luminosity block, before the streams  ------------
+template <class Format>
+  std::shared_ptr<MiniEventWriter::LumiSummary>
+MiniAnalyzerCore<Format>::globalBeginLuminosityBlockSummary(const edm::LuminosityBlock&, const edm::EventSetup&, const LuminosityBlockContext*)
+{
+  return std::make_shared<MiniEventWriter::LumiSummary>();
+}
+
+// ------------ method called once each luminosity block, after all the streams  ------------
+template <class Format>
+  void
+MiniAnalyzerCore<Format>::globalEndLuminosityBlockSummary(const edm::LuminosityBlock& iLumi, const edm::EventSetup&, const LuminosityBlockContext* iContext, MiniEventWriter::LumiSummary* summary)
+{
+  iContext->global()->endLuminosityBlock(iLumi.run(), iLumi.luminosityBlock(), summary->events);
+}
+
+// ------------ method called when ending the processing of a run  ------------
+template <class Format>
+  void
+MiniAnalyzerCore<Format>::endRun(edm::Run const&, edm::EventSetup const&)
+{
+}
+
+// ------------ method called once each stream after the event loop  ------------
+template <class Format>
+  void
+MiniAnalyzerCore<Format>::endStream()
+{
+  format_.endStream();
+  timer_.finish();
+  muonFlow_.finish();
+  electronFlow_.finish();
+  jetFlow_.finish();
+}
+
+// ------------ method called once each job just after ending the event loop  ------------
+template <class Format>
+  void
+MiniAnalyzerCore<Format>::globalEndJob(const MiniEventWriter* writer)
+{
+  writer->report();
+  writer->close();
+}
+
+// ------------ method fills 'descriptions' with the allowed parameters for the module  ------------
+template <class Format>
+void
+MiniAnalyzerCore<Format>::fillDescriptions(edm::ConfigurationDescriptions& descriptions) {
+  //The following says we do not know what parameters are allowed so do no validation
+  // Please change this to state exactly what you do use, even if it is no parameters
+  edm::ParameterSetDescription desc;
+  desc.setUnknown();
+  descriptions.addDefault(desc);
+}
+
+#endif
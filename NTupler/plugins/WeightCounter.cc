@@ -8,7 +8,15 @@
 Description: save the total number of events in then gen dataset
 
 Implementation:
-  the sum of the input weights is stored in a TH1F
+  the sum of the input weights is stored in a TH1F: the first bin holds the
+  sum of the event weights, bin i+1 the sum of the i-th entry of
+  GenEventInfoProduct::weights() for i >= 1 (entries beyond the last bin go
+  to the overflow), so that all the weight variations are normalised in the
+  same job. The bin errors are the square roots of the sums of the squared
+  weights. The sums are accumulated by each stream in its own cache and
+  merged at the end of every luminosity block, when the histogram is
+  refreshed, so that a checkpoint of the output file (checkpointLumis of
+  the ntupler) holds the weights of the events it contains.
 */
 //
 // Original Author:  Mirena Ivova Paneva
@@ -18,11 +26,15 @@ Implementation:
 
 
 // system include files
+#include <algorithm>
+#include <cmath>
 #include <memory>
+#include <mutex>
+#include <vector>
 
 // user include files
 #include "FWCore/Framework/interface/Frameworkfwd.h"
-#include "FWCore/Framework/interface/EDAnalyzer.h"
+#include "FWCore/Framework/interface/global/EDAnalyzer.h"
 
 #include "FWCore/Framework/interface/Event.h"
 #include "FWCore/Framework/interface/MakerMacros.h"
@@ -32,14 +44,27 @@ Implementation:
 
 #include "FWCore/ServiceRegistry/interface/Service.h"
 #include "CommonTools/UtilAlgos/interface/TFileService.h"
-#include "TTree.h"
+#include "TH1F.h"
 
 
 //
 // class declaration
 //
 
-class WeightCounter : public edm::EDAnalyzer {
+namespace weightcounter {
+  // sums per histogram bin, underflow and overflow included
+  struct Sums {
+    explicit Sums(size_t nBins) : events(0), sumW(nBins+2, 0.), sumW2(nBins+2, 0.) {}
+    void add(int bin, double w) { sumW[bin] += w; sumW2[bin] += w*w; }
+    void add(const Sums & other);
+    void clear();
+
+    unsigned long long events;
+    std::vector<double> sumW, sumW2;
+  };
+}
+
+class WeightCounter : public edm::global::EDAnalyzer<edm::StreamCache<weightcounter::Sums>> {
   public:
     explicit WeightCounter(const edm::ParameterSet&);
     ~WeightCounter();
@@ -49,12 +74,21 @@ class WeightCounter : public edm::EDAnalyzer {
 
   private:
     virtual void beginJob() override;
-    virtual void analyze(const edm::Event&, const edm::EventSetup&) override;
-    virtual void endJob() override;
+    virtual std::unique_ptr<weightcounter::Sums> beginStream(edm::StreamID) const override;
+    virtual void analyze(edm::StreamID, const edm::Event&, const edm::EventSetup&) const override;
+    virtual void streamEndLuminosityBlock(edm::StreamID, const edm::LuminosityBlock&, const edm::EventSetup&) const override;
+    virtual void endStream(edm::StreamID) const override;
+
+    // merges the sums of a stream, with mutex_ held
+    void merge(edm::StreamID) const;
 
     // ----------member data ---------------------------
+    static const int nBins_ = 1000;
     TH1F* weight;
-    float T_Event_weight;
+
+    // sums of the completed luminosity blocks, filled in the histogram
+    mutable std::mutex mutex_;
+    mutable weightcounter::Sums total_;
 
     //tokens
     edm::EDGetTokenT<GenEventInfoProduct> genEventInfoToken_;
@@ -73,6 +107,8 @@ class WeightCounter : public edm::EDAnalyzer {
 // constructors and destructor
 //
 WeightCounter::WeightCounter(const edm::ParameterSet& iConfig) : 
+  weight(nullptr),
+  total_(nBins_),
   genEventInfoToken_(consumes<GenEventInfoProduct>(edm::InputTag("generator")))
 {
   //now do what ever initialization is needed
@@ -93,22 +129,77 @@ WeightCounter::~WeightCounter()
 // member functions
 //
 
-// ------------ method called for each event  ------------
+void
+weightcounter::Sums::add(const Sums & other)
+{
+  events += other.events;
+  for (size_t i = 0; i < sumW.size(); i++) {
+    sumW[i] += other.sumW[i];
+    sumW2[i] += other.sumW2[i];
+  }
+}
+
+void
+weightcounter::Sums::clear()
+{
+  events = 0;
+  std::fill(sumW.begin(), sumW.end(), 0.);
+  std::fill(sumW2.begin(), sumW2.end(), 0.);
+}
+
   void
-WeightCounter::analyze(const edm::Event& iEvent, const edm::EventSetup& iSetup)
+WeightCounter::merge(edm::StreamID id) const
 {
-  using namespace edm;
+  weightcounter::Sums & sums = *streamCache(id);
+  total_.add(sums);
+  sums.clear();
+  for (int i = 0; i < nBins_+2; i++) {
+    weight->SetBinContent(i, total_.sumW[i]);
+    weight->SetBinError(i, std::sqrt(total_.sumW2[i]));
+  }
+  weight->SetEntries(total_.events);
+}
 
+// ------------ method called once each stream before processing any event  ------------
+std::unique_ptr<weightcounter::Sums>
+WeightCounter::beginStream(edm::StreamID) const
+{
+  return std::unique_ptr<weightcounter::Sums>(new weightcounter::Sums(nBins_));
+}
 
+// ------------ method called for each event  ------------
+  void
+WeightCounter::analyze(edm::StreamID id, const edm::Event& iEvent, const edm::EventSetup& iSetup) const
+{
+  using namespace edm;
 
   edm::Handle<GenEventInfoProduct> genEvtInfo;
   iEvent.getByToken(genEventInfoToken_, genEvtInfo);
 
-  T_Event_weight= genEvtInfo->weight();
+  weightcounter::Sums & sums = *streamCache(id);
+  ++sums.events;
+  // the weights are rounded to float as the TH1F they have always been filled in
+  sums.add(1, float(genEvtInfo->weight()));
+  const std::vector<double> & weights = genEvtInfo->weights();
+  for (size_t i = 1; i < weights.size(); i++)
+    sums.add(std::min(int(i)+1, nBins_+1), float(weights[i]));
 
+}
 
-  weight->Fill(0.,T_Event_weight);
+// ------------ method called once each stream at the end of a luminosity block  ------------
+  void
+WeightCounter::streamEndLuminosityBlock(edm::StreamID id, const edm::LuminosityBlock&, const edm::EventSetup&) const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  merge(id);
+}
 
+// ------------ method called once each stream after the last event  ------------
+  void
+WeightCounter::endStream(edm::StreamID id) const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  merge(id);
 }
 
 
@@ -117,18 +208,11 @@ WeightCounter::analyze(const edm::Event& iEvent, const edm::EventSetup& iSetup)
 WeightCounter::beginJob()
 {
   edm::Service<TFileService> fs;  
-  weight = fs->make<TH1F>("Event_weight",    ";Variation;Events", 1000, 0., 1000.); 
-
-
-}
+  weight = fs->make<TH1F>("Event_weight",    ";Variation;Events", nBins_, 0., nBins_); 
+  weight->Sumw2();
 
-// ------------ method called once each job just after ending the event loop  ------------
-  void 
-WeightCounter::endJob() 
-{
 }
 
-
 // ------------ method fills 'descriptions' with the allowed parameters for the module  ------------
 void
 WeightCounter::fillDescriptions(edm::ConfigurationDescriptions& descriptions) {
@@ -0,0 +1,21 @@
+def completedLumis(fileName, directory="ntuple"):
+    """Return the luminosity blocks recorded in the Lumis tree of an ntuple
+    file, e.g. the output of an interrupted job at its last checkpoint, as
+    run:lumi-run:lumi ranges for the lumisToSkip of a PoolSource."""
+    import ROOT
+    inFile = ROOT.TFile.Open(fileName)
+    if not inFile or inFile.IsZombie():
+        raise IOError("cannot open " + fileName)
+    lumiTree = inFile.Get(directory + "/Lumis")
+    if not lumiTree:
+        raise ValueError("no " + directory + "/Lumis tree in " + fileName)
+    lumis = sorted(set((entry.Run, entry.Lumi) for entry in lumiTree))
+    inFile.Close()
+
+    ranges = []
+    for run, lumi in lumis:
+        if ranges and ranges[-1][0] == run and ranges[-1][2] == lumi-1:
+            ranges[-1][2] = lumi
+        else:
+            ranges.append([run, lumi, lumi])
+    return ["%d:%d-%d:%d" % (run, first, run, last) for run, first, last in ranges]
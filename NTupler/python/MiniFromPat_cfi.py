@@ -3,6 +3,7 @@ import FWCore.ParameterSet.Config as cms
 ntuple = cms.EDAnalyzer('MiniFromPat',
         pileup        = cms.uint32(200),
         vertices      = cms.InputTag("offlineSlimmedPrimaryVertices"),
+        primaryVertex = cms.InputTag("primaryVertexSelector"),
         electrons     = cms.InputTag("slimmedElectrons"),
         beamspot      = cms.InputTag("offlineBeamSpot"),
         conversions   = cms.InputTag("reducedEgamma", "reducedConversions", "PAT"),
@@ -11,4 +12,19 @@ ntuple = cms.EDAnalyzer('MiniFromPat',
         mets          = cms.InputTag("slimmedMETsPuppi"),
         genParts      = cms.InputTag("packedGenParticles"),
         genJets       = cms.InputTag("slimmedGenJets"),
+        # edm::PtrVectors of the object filters (outputPtrs) to start from, empty: the whole collections
+        looseMuons     = cms.InputTag(""),
+        looseElectrons = cms.InputTag(""),
+        cleanedJets    = cms.InputTag(""),
+        output = cms.PSet(
+            backend = cms.string("TTree"),
+            compact = cms.bool(False),
+            singleTree = cms.bool(False),
+            basketSize = cms.int32(0),
+            autoFlush = cms.int64(0),
+            compressionAlgorithm = cms.string(""),
+            compressionLevel = cms.int32(0),
+            checkpointLumis = cms.int32(0),
+        ),
+        timing        = cms.untracked.bool(False),
 )
@@ -4,27 +4,32 @@ ntuple = cms.EDAnalyzer('MiniFromReco',
         electrons    = cms.InputTag("ecalDrivenGsfElectrons"),
         beamspot     = cms.InputTag("offlineBeamSpot"),
         conversions  = cms.InputTag("particleFlowEGamma"),
-        trackIsoValueMap = cms.InputTag("electronTrackIsolationLcone"),
+        electronID   = cms.InputTag("recoElectronID"),
         muons        = cms.InputTag("muons"),
         puppiNoLepIsolationChargedHadrons = cms.InputTag("muonIsolationPUPPINoLep","h+-DR040-ThresholdVeto000-ConeVeto000"),
         puppiNoLepIsolationNeutralHadrons = cms.InputTag("muonIsolationPUPPINoLep","h0-DR040-ThresholdVeto000-ConeVeto001"),
         puppiNoLepIsolationPhotons        = cms.InputTag("muonIsolationPUPPINoLep","gamma-DR040-ThresholdVeto000-ConeVeto001"),    
-        pfCandsNoLep = cms.InputTag("particleFlow"),
         jets         = cms.InputTag("ak4PFJetsCHS"),
         met          = cms.InputTag("pfMet"),
         genParts     = cms.InputTag("genParticles"),
         genJets      = cms.InputTag("ak4GenJets"),
         vertices     = cms.InputTag("offlinePrimaryVertices"),
-        HGCalIDToolConfig = cms.PSet(
-            HGCBHInput = cms.InputTag("HGCalRecHit","HGCHEBRecHits"),
-            HGCEEInput = cms.InputTag("HGCalRecHit","HGCEERecHits"),
-            HGCFHInput = cms.InputTag("HGCalRecHit","HGCHEFRecHits"),
-            HGCPFRecHits = cms.InputTag("particleFlowRecHitHGC::MiniAnalysis"),
-            withPileup = cms.bool(True),
-            debug = cms.bool(False),
+        primaryVertex = cms.InputTag("primaryVertexSelector"),
+        # edm::PtrVectors of the object filters (outputPtrs) to start from, empty: the whole collections
+        looseMuons     = cms.InputTag(""),
+        looseElectrons = cms.InputTag(""),
+        cleanedJets    = cms.InputTag(""),
+        output = cms.PSet(
+            backend = cms.string("TTree"),
+            compact = cms.bool(False),
+            singleTree = cms.bool(False),
+            basketSize = cms.int32(0),
+            autoFlush = cms.int64(0),
+            compressionAlgorithm = cms.string(""),
+            compressionLevel = cms.int32(0),
+            checkpointLumis = cms.int32(0),
         ),
-        
-
+        timing       = cms.untracked.bool(False),
 )
 
 IsoConeDefinitions = cms.VPSet(
@@ -0,0 +1,20 @@
+import FWCore.ParameterSet.Config as cms
+
+def addObjectFilters(process, inputFormat, outputPtrs=False):
+    """Add the electron, muon and jet filters of inputFormat (modules
+    electronfilter, muonfilter and jetfilter) to the process and return the
+    sequence running them. The primary vertex selector, and for RECO the
+    electron ID producer and the PUPPI sequence, have to run before it."""
+    prefix = "Pat"
+    if (inputFormat.lower() == "reco"):
+        prefix = "Reco"
+    process.load("PhaseTwoAnalysis.Electrons."+prefix+"ElectronFilter_cfi")
+    process.load("PhaseTwoAnalysis.Muons."+prefix+"MuonFilter_cfi")
+    process.load("PhaseTwoAnalysis.Jets."+prefix+"JetFilter_cfi")
+    if (inputFormat.lower() == "reco"):
+        process.muonfilter.pfCandsNoLep = "puppiNoLep"
+        process.jetfilter.jets = "ak4PUPPIJets"
+    process.electronfilter.outputPtrs = outputPtrs
+    process.muonfilter.outputPtrs = outputPtrs
+    process.jetfilter.outputPtrs = outputPtrs
+    return cms.Sequence(process.electronfilter * process.muonfilter * process.jetfilter)
@@ -17,6 +17,26 @@ options.register('skim', True,
                  VarParsing.varType.bool,
                  "skim events with one lepton and 2 jets"
                  )
+options.register('outputPtrs', False,
+                 VarParsing.multiplicity.singleton,
+                 VarParsing.varType.bool,
+                 "store the selected objects as edm::PtrVector into the input collections instead of copies"
+                 )
+options.register('timing', False,
+                 VarParsing.multiplicity.singleton,
+                 VarParsing.varType.bool,
+                 "report the time spent in each stage of the object filters"
+                 )
+options.register('cutFlow', '',
+                 VarParsing.multiplicity.singleton,
+                 VarParsing.varType.string,
+                 "count the objects reaching and failing each cut of the object filters, written to this ROOT file (empty: disabled)"
+                 )
+options.register('benchmark', '',
+                 VarParsing.multiplicity.singleton,
+                 VarParsing.varType.string,
+                 "write the time and RSS of each module and the input collection sizes to this JSON file (empty: disabled)"
+                 )
 options.parseArguments()
 
 process = cms.Process("EDMFilter")
@@ -39,12 +59,15 @@ process.load("FWCore.MessageService.MessageLogger_cfi")
 process.MessageLogger.cerr.FwkReport.reportEvery = 1000
 process.MessageLogger.cerr.threshold = 'INFO'
 process.MessageLogger.categories.append('MyAna')
+process.MessageLogger.categories.append('StageTimer')
+process.MessageLogger.categories.append('CutFlow')
+process.MessageLogger.categories.append('ElectronIDPipeline')
 process.MessageLogger.cerr.INFO = cms.untracked.PSet(
         limit = cms.untracked.int32(-1)
 )
 
 # Input
-process.maxEvents = cms.untracked.PSet( input = cms.untracked.int32(-1) ) 
+process.maxEvents = cms.untracked.PSet( input = cms.untracked.int32(options.maxEvents) )
 
 process.source = cms.Source("PoolSource",
     fileNames = cms.untracked.vstring(*(
@@ -56,6 +79,8 @@ if (options.inputFormat.lower() == "reco"):
         '/store/mc/PhaseIITDRSpring17DR/TTToSemiLepton_TuneCUETP8M1_14TeV-powheg-pythia8/AODSIM/PU200_91X_upgrade2023_realistic_v3-v1/120000/000CD008-7A58-E711-82DB-1CB72C0A3A61.root',
     ))
 process.source.inputCommands = cms.untracked.vstring("keep *")
+if options.inputFiles:
+    process.source.fileNames = cms.untracked.vstring(options.inputFiles)
 
 # run Puppi 
 process.load('CommonTools/PileupAlgos/Puppi_cff')
@@ -81,37 +106,35 @@ process.load("RecoParticleFlow.PFClusterProducer.particleFlowRecHitHGC_cff")
 
 # jurassic track isolation
 # https://indico.cern.ch/event/27568/contributions/1618615/attachments/499629/690192/080421.Isolation.Update.RecHits.pdf
-process.load("RecoEgamma.EgammaIsolationAlgos.electronTrackIsolationLcone_cfi")
-process.electronTrackIsolationLcone.electronProducer = cms.InputTag("ecalDrivenGsfElectrons")
-process.electronTrackIsolationLcone.intRadiusBarrel = 0.04
-process.electronTrackIsolationLcone.intRadiusEndcap = 0.04
+# (Lcone: electronTrackIsolationLcone with the inner radius 0.04, in one pass over the tracks)
+process.load("PhaseTwoAnalysis.Electrons.electronTrackIsolationCones_cfi")
 
-# electron producer
-moduleElecName = "PatElectronFilter"    
-if (options.inputFormat.lower() == "reco"):
-    moduleElecName = "RecoElectronFilter"
-process.electronfilter = cms.EDProducer(moduleElecName)
-process.load("PhaseTwoAnalysis.Electrons."+moduleElecName+"_cfi")
-if (options.inputFormat.lower() == "reco"):
-    process.electronfilter.pfCandsNoLep = "puppiNoLep"
+# primary vertex, selected once for all the producers
+process.load("PhaseTwoAnalysis.Common.PrimaryVertexSelector_cfi")
+if (options.inputFormat.lower() != "reco"):
+    process.primaryVertexSelector.vertices = "offlineSlimmedPrimaryVertices"
 
-# muon producer
-moduleMuonName = "PatMuonFilter"    
-if (options.inputFormat.lower() == "reco"):
-    moduleMuonName = "RecoMuonFilter"
-process.muonfilter = cms.EDProducer(moduleMuonName)
-process.load("PhaseTwoAnalysis.Muons."+moduleMuonName+"_cfi")
+# RECO electron ID, computed once per event
 if (options.inputFormat.lower() == "reco"):
-    process.muonfilter.pfCandsNoLep = "puppiNoLep"    
-
-# producer
-moduleJetName = "PatJetFilter"    
-if (options.inputFormat.lower() == "reco"):
-    moduleJetName = "RecoJetFilter"
-process.jetfilter = cms.EDProducer(moduleJetName)
-process.load("PhaseTwoAnalysis.Jets."+moduleJetName+"_cfi")
-if (options.inputFormat.lower() == "reco"):
-    process.jetfilter.jets = "ak4PUPPIJets"    
+    process.load("PhaseTwoAnalysis.Electrons.RecoElectronIDProducer_cfi")
+    process.recoElectronID.pfCandsNoLep = "puppiNoLep"
+    if options.timing:
+        process.recoElectronID.timing = cms.untracked.bool(True)
+
+# electron, muon and jet producers
+from PhaseTwoAnalysis.NTupler.ObjectFilters import addObjectFilters
+process.objectFilters = addObjectFilters(process, options.inputFormat, options.outputPtrs)
+if options.timing:
+    process.electronfilter.timing = cms.untracked.bool(True)
+    process.muonfilter.timing = cms.untracked.bool(True)
+    process.jetfilter.timing = cms.untracked.bool(True)
+if options.cutFlow:
+    process.electronfilter.cutFlow = cms.untracked.bool(True)
+    process.muonfilter.cutFlow = cms.untracked.bool(True)
+    process.jetfilter.cutFlow = cms.untracked.bool(True)
+    process.TFileService = cms.Service("TFileService",
+                                       fileName = cms.string(options.cutFlow)
+                                       )
         
 # output
 process.out = cms.OutputModule("PoolOutputModule",
@@ -126,12 +149,35 @@ process.out = cms.OutputModule("PoolOutputModule",
                                            ),    
     fileName = cms.untracked.string(options.outFilename)
 )
+if options.outputPtrs:
+    # only the products of the filters and the collections their PtrVectors
+    # point to (and the PUPPI MET of the RECO events) are kept
+    process.out.outputCommands = cms.untracked.vstring('drop *',
+                                                       'keep *_electronfilter_*_*',
+                                                       'keep *_muonfilter_*_*',
+                                                       'keep *_jetfilter_*_*',
+                                                       )
+    if (options.inputFormat.lower() == "reco"):
+        process.out.outputCommands.extend(['keep recoGsfElectrons_%s_*_*' % process.electronfilter.electrons.getModuleLabel(),
+                                           'keep recoMuons_%s_*_*' % process.muonfilter.muons.getModuleLabel(),
+                                           'keep recoPFJets_%s_*_*' % process.jetfilter.jets.getModuleLabel(),
+                                           'keep recoPFMETs_puppiMet_*_*',
+                                           ])
+    else:
+        process.out.outputCommands.extend(['keep patElectrons_%s_*_*' % process.electronfilter.electrons.getModuleLabel(),
+                                           'keep patMuons_%s_*_*' % process.muonfilter.muons.getModuleLabel(),
+                                           'keep patJets_%s_*_*' % process.jetfilter.jets.getModuleLabel(),
+                                           ])
 
 # run
 if (options.inputFormat.lower() == "reco"):
-    process.p = cms.Path(process.electronTrackIsolationLcone * process.particleFlowRecHitHGCSeq * process.puSequence * process.electronfilter * process.muonfilter * process.jetfilter)
+    process.p = cms.Path(process.electronTrackIsolationCones * process.particleFlowRecHitHGCSeq * process.puSequence * process.primaryVertexSelector * process.recoElectronID * process.objectFilters)
 else:
-    process.p = cms.Path(process.electronfilter * process.muonfilter * process.jetfilter)
+    process.p = cms.Path(process.primaryVertexSelector * process.objectFilters)
 
 process.e = cms.EndPath(process.out)
-    
+
+# per-module cost vs. input multiplicities
+if options.benchmark:
+    from PhaseTwoAnalysis.Common.PileupBenchmark import addPileupBenchmark
+    addPileupBenchmark(process, options.inputFormat, options.benchmark)
@@ -17,7 +17,76 @@ options.register('skim', True,
                  VarParsing.varType.bool,
                  "skim events with one lepton and 2 jets"
                  )
+options.register('fused', False,
+                 VarParsing.multiplicity.singleton,
+                 VarParsing.varType.bool,
+                 "run the object filters of edmFilter_cfg.py in this job, skim on the objects they select and ntuple them (needs skim=True)"
+                 )
+options.register('nThreads', 1,
+                 VarParsing.multiplicity.singleton,
+                 VarParsing.varType.int,
+                 "number of threads (one stream per thread)"
+                 )
+options.register('backend', 'TTree',
+                 VarParsing.multiplicity.singleton,
+                 VarParsing.varType.string,
+                 "format of the ntuples: TTree, or RNTuple (ROOT >= 6.34)"
+                 )
+options.register('compact', False,
+                 VarParsing.multiplicity.singleton,
+                 VarParsing.varType.bool,
+                 "store angles, masses and isolations as Float16_t and the flags as Char_t"
+                 )
+options.register('singleTree', False,
+                 VarParsing.multiplicity.singleton,
+                 VarParsing.varType.bool,
+                 "store all collections in a single Events tree"
+                 )
+options.register('basketSize', 0,
+                 VarParsing.multiplicity.singleton,
+                 VarParsing.varType.int,
+                 "basket size of the output branches in bytes (0: ROOT default)"
+                 )
+options.register('autoFlush', 0,
+                 VarParsing.multiplicity.singleton,
+                 VarParsing.varType.int,
+                 "cluster size of the output trees, >0 in entries, <0 in bytes (0: ROOT default)"
+                 )
+options.register('compression', '',
+                 VarParsing.multiplicity.singleton,
+                 VarParsing.varType.string,
+                 "compression of the output branches as ALGORITHM:level, e.g. LZ4:4 or LZMA:9 (empty: TFileService default)"
+                 )
+options.register('timing', False,
+                 VarParsing.multiplicity.singleton,
+                 VarParsing.varType.bool,
+                 "report the time spent in each stage of the ntupler (log and timing/ directory of the output file)"
+                 )
+options.register('cutFlow', False,
+                 VarParsing.multiplicity.singleton,
+                 VarParsing.varType.bool,
+                 "count the objects reaching and failing each cut of the ntupler (log and cutflow/ directory of the output file)"
+                 )
+options.register('checkpointLumis', 0,
+                 VarParsing.multiplicity.singleton,
+                 VarParsing.varType.int,
+                 "write the output file every this many luminosity blocks, so that an interrupted job keeps its work (0: at the end of the job)"
+                 )
+options.register('resumeFrom', '',
+                 VarParsing.multiplicity.singleton,
+                 VarParsing.varType.string,
+                 "output file of an interrupted job: skip the luminosity blocks it holds (empty: disabled)"
+                 )
+options.register('benchmark', '',
+                 VarParsing.multiplicity.singleton,
+                 VarParsing.varType.string,
+                 "write the time and RSS of each module and the input collection sizes to this JSON file (empty: disabled)"
+                 )
 options.parseArguments()
+if options.fused and not options.skim:
+    raise ValueError("fused=True skims on the objects of the filters and needs skim=True")
+if options.resumeFrom and options.resumeFrom == options.outFilename:
+    raise ValueError("resumeFrom needs another outFilename, the two files are merged afterwards")
 
 process = cms.Process("MiniAnalysis")
 
@@ -39,12 +108,22 @@ process.load("FWCore.MessageService.MessageLogger_cfi")
 process.MessageLogger.cerr.FwkReport.reportEvery = 1000
 process.MessageLogger.cerr.threshold = 'INFO'
 process.MessageLogger.categories.append('MyAna')
+process.MessageLogger.categories.append('StageTimer')
+process.MessageLogger.categories.append('CutFlow')
+process.MessageLogger.categories.append('ElectronIDPipeline')
+process.MessageLogger.categories.append('MiniEventWriter')
 process.MessageLogger.cerr.INFO = cms.untracked.PSet(
         limit = cms.untracked.int32(-1)
 )
 
+# Threading
+process.options = cms.untracked.PSet(
+        numberOfThreads = cms.untracked.uint32(options.nThreads),
+        numberOfStreams = cms.untracked.uint32(0)
+)
+
 # Input
-process.maxEvents = cms.untracked.PSet( input = cms.untracked.int32(-1) ) 
+process.maxEvents = cms.untracked.PSet( input = cms.untracked.int32(options.maxEvents) )
 
 process.source = cms.Source("PoolSource",
     fileNames = cms.untracked.vstring(*(
@@ -56,6 +135,12 @@ if (options.inputFormat.lower() == "reco"):
         '/store/mc/PhaseIITDRSpring17DR/TTToSemiLepton_TuneCUETP8M1_14TeV-powheg-pythia8/AODSIM/PU200_91X_upgrade2023_realistic_v3-v1/120000/000CD008-7A58-E711-82DB-1CB72C0A3A61.root',
     ))
 process.source.inputCommands = cms.untracked.vstring("keep *")
+if options.inputFiles:
+    process.source.fileNames = cms.untracked.vstring(options.inputFiles)
+if options.resumeFrom:
+    # the luminosity blocks of the last checkpoint of the interrupted job
+    from PhaseTwoAnalysis.NTupler.Checkpoints import completedLumis
+    process.source.lumisToSkip = cms.untracked.VLuminosityBlockRange(*completedLumis(options.resumeFrom))
 
 # Pre-skim weight counter
 process.weightCounter = cms.EDAnalyzer('WeightCounter')
@@ -94,6 +179,11 @@ process.countJets = cms.EDFilter("CandViewCountFilter",
                                  src = cms.InputTag("selectedJets"),
                                  minNumber = cms.uint32(2)
                                  )
+if options.fused:
+    # the loose leptons and the cleaned jets selected by the filters, in memory
+    process.selectedMuons.src = "muonfilter:LooseMuons"
+    process.selectedElectrons.src = "electronfilter:LooseElectrons"
+    process.selectedJets.src = "jetfilter:Jets"
 process.preYieldFilter = cms.Sequence(process.selectedMuons+process.selectedElectrons+process.allLeps+process.countLeps+process.selectedJets+process.countJets)
 
 
@@ -127,10 +217,8 @@ process.load("RecoParticleFlow.PFClusterProducer.particleFlowRecHitHGC_cff")
 
 # jurassic track isolation
 # https://indico.cern.ch/event/27568/contributions/1618615/attachments/499629/690192/080421.Isolation.Update.RecHits.pdf
-process.load("RecoEgamma.EgammaIsolationAlgos.electronTrackIsolationLcone_cfi")
-process.electronTrackIsolationLcone.electronProducer = cms.InputTag("ecalDrivenGsfElectrons")
-process.electronTrackIsolationLcone.intRadiusBarrel = 0.04
-process.electronTrackIsolationLcone.intRadiusEndcap = 0.04
+# (Lcone: electronTrackIsolationLcone with the inner radius 0.04, in one pass over the tracks)
+process.load("PhaseTwoAnalysis.Electrons.electronTrackIsolationCones_cfi")
 
 # analysis
 moduleName = "MiniFromPat"    
@@ -140,8 +228,46 @@ process.ntuple = cms.EDAnalyzer(moduleName)
 process.load("PhaseTwoAnalysis.NTupler."+moduleName+"_cfi")
 if (options.inputFormat.lower() == "reco"):
     process.ntuple.jets = "ak4PUPPIJets"
-    process.ntuple.pfCandsNoLep = "puppiNoLep"
     process.ntuple.met = "puppiMet"
+process.ntuple.output.backend = options.backend
+process.ntuple.output.compact = options.compact
+process.ntuple.output.singleTree = options.singleTree
+process.ntuple.output.basketSize = options.basketSize
+process.ntuple.output.autoFlush = options.autoFlush
+process.ntuple.output.checkpointLumis = options.checkpointLumis
+if options.compression:
+    algorithm, level = (options.compression.split(':') + ['4'])[:2]
+    process.ntuple.output.compressionAlgorithm = algorithm.upper()
+    process.ntuple.output.compressionLevel = int(level)
+process.ntuple.timing = cms.untracked.bool(options.timing)
+process.ntuple.cutFlow = cms.untracked.bool(options.cutFlow)
+
+# primary vertex, selected once for the whole path
+process.load("PhaseTwoAnalysis.Common.PrimaryVertexSelector_cfi")
+process.primaryVertexSelector.vertices = process.ntuple.vertices
+
+# electron ID and isolation, computed once per event (RECO)
+process.load("PhaseTwoAnalysis.Electrons.RecoElectronIDProducer_cfi")
+process.recoElectronID.pfCandsNoLep = "puppiNoLep"
+process.recoElectronID.timing = cms.untracked.bool(options.timing)
+
+# object filters, run in this job with fused=True
+if options.fused:
+    from PhaseTwoAnalysis.NTupler.ObjectFilters import addObjectFilters
+    process.objectFilters = addObjectFilters(process, options.inputFormat, outputPtrs=True)
+    process.electronfilter.timing = cms.untracked.bool(options.timing)
+    process.muonfilter.timing = cms.untracked.bool(options.timing)
+    process.jetfilter.timing = cms.untracked.bool(options.timing)
+    process.electronfilter.cutFlow = cms.untracked.bool(options.cutFlow)
+    process.muonfilter.cutFlow = cms.untracked.bool(options.cutFlow)
+    process.jetfilter.cutFlow = cms.untracked.bool(options.cutFlow)
+    # the ntupler starts from the objects of the filters, which point into its input collections
+    process.ntuple.looseMuons = "muonfilter:LooseMuons"
+    process.ntuple.looseElectrons = "electronfilter:LooseElectrons"
+    process.ntuple.cleanedJets = "jetfilter:Jets"
+    process.electronfilter.electrons = process.ntuple.electrons
+    process.muonfilter.muons = process.ntuple.muons
+    process.jetfilter.jets = process.ntuple.jets
 
 # output
 process.TFileService = cms.Service("TFileService",
@@ -151,13 +277,25 @@ process.TFileService = cms.Service("TFileService",
 # run
 process.puSequence = cms.Sequence(process.primaryVertexAssociation * process.pfNoLepPUPPI * process.puppi * process.particleFlowNoLep * process.puppiNoLep * process.offlineSlimmedPrimaryVertices * process.packedPFCandidates * process.muonIsolationPUPPI * process.muonIsolationPUPPINoLep * process.ak4PUPPIJets * process.puppiMet)
 
-if options.skim:
+if options.fused:
+    # the skim runs on the products of the filters, before the ntupler, and
+    # the ntuples are the only output of the job
     if (options.inputFormat.lower() == "reco"):
-        process.p = cms.Path(process.weightCounter * process.electronTrackIsolationLcone * process.particleFlowRecHitHGCSeq * process.puSequence * process.preYieldFilter * process.ntuple)
+        process.p = cms.Path(process.weightCounter * process.electronTrackIsolationCones * process.particleFlowRecHitHGCSeq * process.puSequence * process.primaryVertexSelector * process.recoElectronID * process.objectFilters * process.preYieldFilter * process.ntuple)
     else:
-        process.p = cms.Path(process.weightCounter*process.preYieldFilter*process.ntuple)
+        process.p = cms.Path(process.weightCounter * process.primaryVertexSelector * process.objectFilters * process.preYieldFilter * process.ntuple)
+elif options.skim:
+    if (options.inputFormat.lower() == "reco"):
+        process.p = cms.Path(process.weightCounter * process.electronTrackIsolationCones * process.particleFlowRecHitHGCSeq * process.puSequence * process.preYieldFilter * process.primaryVertexSelector * process.recoElectronID * process.ntuple)
+    else:
+        process.p = cms.Path(process.weightCounter*process.preYieldFilter*process.primaryVertexSelector*process.ntuple)
 else:
     if (options.inputFormat.lower() == "reco"):
-        process.p = cms.Path(process.electronTrackIsolationLcone * process.particleFlowRecHitHGCSeq * process.puSequence * process.ntuple)
+        process.p = cms.Path(process.electronTrackIsolationCones * process.particleFlowRecHitHGCSeq * process.puSequence * process.primaryVertexSelector * process.recoElectronID * process.ntuple)
     else:
-        process.p = cms.Path(process.ntuple)
+        process.p = cms.Path(process.primaryVertexSelector*process.ntuple)
+
+# per-module cost vs. input multiplicities
+if options.benchmark:
+    from PhaseTwoAnalysis.Common.PileupBenchmark import addPileupBenchmark
+    addPileupBenchmark(process, options.inputFormat, options.benchmark)
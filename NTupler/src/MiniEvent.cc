@@ -1,90 +1,356 @@
 #include "PhaseTwoAnalysis/NTupler/interface/MiniEvent.h"
 
-void createMiniEventTree(TTree *t_event_, TTree *t_genParts_, TTree *t_vertices_, TTree *t_genJets_, TTree *t_looseElecs_, TTree *t_tightElecs_, TTree *t_looseMuons_, TTree *t_tightMuons_, TTree *t_puppiJets_, TTree *t_puppiMET_,MiniEvent_t &ev)
+#include "RVersion.h"
+
+#include <algorithm>
+#include <string>
+
+namespace {
+
+  // Float16_t precision of a compact column: range and number of bits, or
+  // a truncated mantissa of nbits bits if min == max
+  struct Precision
+  {
+    const char *min, *max;
+    int nbits;
+  };
+  const Precision kMantissa = {"0", "0", 10};
+  const Precision kAngle = {"-3.1415927", "3.1415927", 12};
+
+  std::string float16(const Precision & precision)
+  {
+#if ROOT_VERSION_CODE >= ROOT_VERSION(6,16,0)
+    return std::string("f[") + precision.min + "," + precision.max + "," + std::to_string(precision.nbits) + "]";
+#else
+    return "F";
+#endif
+  }
+
+  // Books the branches of one collection. In the default layout every
+  // collection has its own tree and short branch names ("PT"); in the
+  // single-tree layout all collections share one tree and the branch names
+  // are prefixed with the collection name ("ElectronLoose_PT"). The size
+  // branches ("ElectronLoose_size") are named the same way in both layouts.
+  // With compact, the reduced() and flags() columns use the compact layout.
+  class MiniEventBooker
+  {
+    public:
+      MiniEventBooker(bool prefixed, MiniEventCompactColumns *compact) : prefixed_(prefixed), compact_(compact), tree_(0), sizeAddress_(0) {}
+
+      void collection(TTree *tree, const std::string & name)
+      {
+        tree_ = tree;
+        prefix_ = prefixed_ ? name + "_" : "";
+        size_ = name + "_size";
+      }
+
+      void size(Int_t *address)
+      {
+        sizeAddress_ = address;
+        tree_->Branch(size_.c_str(), address, (size_ + "/I").c_str());
+      }
+      void column(const std::string & name, std::vector<Int_t> & values)   { book(name, values.data(), "I"); }
+      void column(const std::string & name, std::vector<Float_t> & values) { book(name, values.data(), "F"); }
+      void reduced(const std::string & name, std::vector<Float_t> & values, const Precision & precision)
+      {
+        book(name, values.data(), compact_ ? float16(precision) : "F");
+      }
+      void flags(const std::string & name, std::vector<Int_t> & values)
+      {
+        if (compact_) book(name, compact_->add(values, sizeAddress_), "B");
+        else book(name, values.data(), "I");
+      }
+
+    private:
+      void book(const std::string & name, void *address, const std::string & type)
+      {
+        std::string branch = prefix_ + name;
+        tree_->Branch(branch.c_str(), address, (branch + "[" + size_ + "]/" + type).c_str());
+      }
+
+      bool prefixed_;
+      MiniEventCompactColumns *compact_;
+      TTree *tree_;
+      Int_t *sizeAddress_;
+      std::string prefix_, size_;
+  };
+
+  // grows the columns of a collection so that index n can be written
+  template<typename T>
+  void grow(size_t n, std::vector<T> & column)
+  {
+    if (column.size() <= n) column.resize(n+1);
+  }
+  template<typename T, typename... Columns>
+  void grow(size_t n, std::vector<T> & column, Columns &... columns)
+  {
+    grow(n, column);
+    grow(n, columns...);
+  }
+
+  template<typename T>
+  void copyColumn(const std::vector<T> & from, std::vector<T> & to, Int_t n)
+  {
+    std::copy_n(from.begin(), n, to.begin());
+  }
+
+  void bookMiniEvent(TTree *t_event_, TTree *t_genParts_, TTree *t_vertices_, TTree *t_genJets_, TTree *t_looseElecs_, TTree *t_tightElecs_, TTree *t_looseMuons_, TTree *t_tightMuons_, TTree *t_puppiJets_, TTree *t_puppiMET_, MiniEvent_t &ev, bool prefixed, MiniEventCompactColumns *compact)
+  {
+    MiniEventBooker b(prefixed, compact);
+
+    //event header
+    t_event_->Branch("Run",               &ev.run,        "Run/I");
+    t_event_->Branch("Event",             &ev.event,      "Event/I");
+    t_event_->Branch("Lumi",              &ev.lumi,       "Lumi/I");
+    t_event_->Branch("Truncated",         &ev.ntrunc,     "Truncated/I");
+
+    //gen level event
+    b.collection(t_genParts_, "Particle");
+    b.size(&ev.ngl);
+    b.column("PID",          ev.gl_pid);
+    b.flags("Charge",        ev.gl_ch);
+    b.column("Status",       ev.gl_st);
+    b.column("P",            ev.gl_p);
+    b.column("Px",           ev.gl_px);
+    b.column("Py",           ev.gl_py);
+    b.column("Pz",           ev.gl_pz);
+    b.column("E",            ev.gl_nrj);
+    b.column("PT",           ev.gl_pt);
+    b.reduced("Eta",         ev.gl_eta, kMantissa);
+    b.reduced("Phi",         ev.gl_phi, kAngle);
+    b.reduced("Mass",        ev.gl_mass, kMantissa);
+    // historically booked as a scalar in the Particle tree, kept as is there
+    if (prefixed) b.reduced("IsolationVar", ev.gl_relIso, kMantissa);
+    else t_genParts_->Branch("IsolationVar", ev.gl_relIso.data(), ("IsolationVar/" + (compact ? float16(kMantissa) : std::string("F"))).c_str());
+
+    b.collection(t_genJets_, "GenJet");
+    b.size(&ev.ngj);
+    b.column("PT",           ev.gj_pt);
+    b.reduced("Eta",         ev.gj_eta, kMantissa);
+    b.reduced("Phi",         ev.gj_phi, kAngle);
+    b.reduced("Mass",        ev.gj_mass, kMantissa);
+
+    //reco level event
+    b.collection(t_vertices_, "Vertex");
+    b.size(&ev.nvtx);
+    b.column("SumPT2",       ev.v_pt2);
+
+    b.collection(t_looseElecs_, "ElectronLoose");
+    b.size(&ev.nle);
+    b.flags("Charge",        ev.le_ch);
+    b.column("Particle",     ev.le_g);
+    b.column("PT",           ev.le_pt);
+    b.reduced("Eta",         ev.le_eta, kMantissa);
+    b.reduced("Phi",         ev.le_phi, kAngle);
+    b.reduced("Mass",        ev.le_mass, kMantissa);
+    b.reduced("IsolationVar", ev.le_relIso, kMantissa);
+
+    b.collection(t_tightElecs_, "ElectronTight");
+    b.size(&ev.nte);
+    b.flags("Charge",        ev.te_ch);
+    b.column("Particle",     ev.te_g);
+    b.column("PT",           ev.te_pt);
+    b.reduced("Eta",         ev.te_eta, kMantissa);
+    b.reduced("Phi",         ev.te_phi, kAngle);
+    b.reduced("Mass",        ev.te_mass, kMantissa);
+    b.reduced("IsolationVar", ev.te_relIso, kMantissa);
+
+    b.collection(t_looseMuons_, "MuonLoose");
+    b.size(&ev.nlm);
+    b.flags("Charge",        ev.lm_ch);
+    b.column("Particle",     ev.lm_g);
+    b.column("PT",           ev.lm_pt);
+    b.reduced("Eta",         ev.lm_eta, kMantissa);
+    b.reduced("Phi",         ev.lm_phi, kAngle);
+    b.reduced("Mass",        ev.lm_mass, kMantissa);
+    b.reduced("IsolationVar", ev.lm_relIso, kMantissa);
+
+    b.collection(t_tightMuons_, "MuonTight");
+    b.size(&ev.ntm);
+    b.flags("Charge",        ev.tm_ch);
+    b.column("Particle",     ev.tm_g);
+    b.column("PT",           ev.tm_pt);
+    b.reduced("Eta",         ev.tm_eta, kMantissa);
+    b.reduced("Phi",         ev.tm_phi, kAngle);
+    b.reduced("Mass",        ev.tm_mass, kMantissa);
+    b.reduced("IsolationVar", ev.tm_relIso, kMantissa);
+
+    b.collection(t_puppiJets_, "JetPUPPI");
+    b.size(&ev.nj);
+    b.flags("ID",            ev.j_id);
+    b.column("GenJet",       ev.j_g);
+    b.column("PT",           ev.j_pt);
+    b.reduced("Eta",         ev.j_eta, kMantissa);
+    b.reduced("Phi",         ev.j_phi, kAngle);
+    b.reduced("Mass",        ev.j_mass, kMantissa);
+    b.flags("MVAv2",         ev.j_mvav2);
+    b.flags("DeepCSV",       ev.j_deepcsv);
+    b.flags("PartonFlavor",  ev.j_flav);
+    b.flags("HadronFlavor",  ev.j_hadflav);
+    b.column("GenPartonPID", ev.j_pid);
+
+    b.collection(t_puppiMET_, "PuppiMissingET");
+    b.size(&ev.nmet);
+    b.column("MET",          ev.met_pt);
+    b.reduced("Phi",         ev.met_phi, kAngle);
+    b.reduced("Eta",         ev.met_eta, kMantissa);
+  }
+
+}
+
+void createMiniEventTree(TTree *t_event_, TTree *t_genParts_, TTree *t_vertices_, TTree *t_genJets_, TTree *t_looseElecs_, TTree *t_tightElecs_, TTree *t_looseMuons_, TTree *t_tightMuons_, TTree *t_puppiJets_, TTree *t_puppiMET_,MiniEvent_t &ev, MiniEventCompactColumns *compact)
 {
-  //event header
-  t_event_->Branch("Run",               &ev.run,        "Run/I");
-  t_event_->Branch("Event",             &ev.event,      "Event/I");
-  t_event_->Branch("Lumi",              &ev.lumi,       "Lumi/I");
-
-  //gen level event
-  t_genParts_->Branch("Particle_size",  &ev.ngl,        "Particle_size/I");
-  t_genParts_->Branch("PID",            ev.gl_pid,      "PID[Particle_size]/I");
-  t_genParts_->Branch("Charge",         ev.gl_ch,       "Charge[Particle_size]/I");
-  t_genParts_->Branch("Status",         ev.gl_st,       "Status[Particle_size]/I");
-  t_genParts_->Branch("P",              ev.gl_p,        "P[Particle_size]/F");
-  t_genParts_->Branch("Px",             ev.gl_px,       "Px[Particle_size]/F");
-  t_genParts_->Branch("Py",             ev.gl_py,       "Py[Particle_size]/F");
-  t_genParts_->Branch("Pz",             ev.gl_pz,       "Pz[Particle_size]/F");
-  t_genParts_->Branch("E",              ev.gl_nrj,      "E[Particle_size]/F");
-  t_genParts_->Branch("PT",             ev.gl_pt,       "PT[Particle_size]/F");
-  t_genParts_->Branch("Eta",            ev.gl_eta,      "Eta[Particle_size]/F");
-  t_genParts_->Branch("Phi",            ev.gl_phi,      "Phi[Particle_size]/F");
-  t_genParts_->Branch("Mass",           ev.gl_mass,     "Mass[Particle_size]/F");
-  t_genParts_->Branch("IsolationVar",   ev.gl_relIso,   "IsolationVar/F");
-
-  t_genJets_->Branch("GenJet_size",     &ev.ngj,        "GenJet_size/I");
-  t_genJets_->Branch("PT",              ev.gj_pt,       "PT[GenJet_size]/F");
-  t_genJets_->Branch("Eta",             ev.gj_eta,      "Eta[GenJet_size]/F");
-  t_genJets_->Branch("Phi",             ev.gj_phi,      "Phi[GenJet_size]/F");
-  t_genJets_->Branch("Mass",            ev.gj_mass,     "Mass[GenJet_size]/F");
-
-  //reco level event
-  t_vertices_->Branch("Vertex_size",    &ev.nvtx,       "Vertex_size/I");
-  t_vertices_->Branch("SumPT2",         &ev.v_pt2,      "SumPT2[Vertex_size]/F");
-
-  t_looseElecs_->Branch("ElectronLoose_size", &ev.nle,  "ElectronLoose_size/I");
-  t_looseElecs_->Branch("Charge",       ev.le_ch,       "Charge[ElectronLoose_size]/I");
-  t_looseElecs_->Branch("Particle",     ev.le_g,        "Particle[ElectronLoose_size]/I");
-  t_looseElecs_->Branch("PT",           ev.le_pt,       "PT[ElectronLoose_size]/F");
-  t_looseElecs_->Branch("Eta",          ev.le_eta,      "Eta[ElectronLoose_size]/F");
-  t_looseElecs_->Branch("Phi",          ev.le_phi,      "Phi[ElectronLoose_size]/F");
-  t_looseElecs_->Branch("Mass",         ev.le_mass,     "Mass[ElectronLoose_size]/F");
-  t_looseElecs_->Branch("IsolationVar", ev.le_relIso,   "IsolationVar[ElectronLoose_size]/F");
-
-  t_tightElecs_->Branch("ElectronTight_size", &ev.nte,  "ElectronTight_size/I");
-  t_tightElecs_->Branch("Charge",       ev.te_ch,       "Charge[ElectronTight_size]/I");
-  t_tightElecs_->Branch("Particle",     ev.te_g,        "Particle[ElectronTight_size]/I");
-  t_tightElecs_->Branch("PT",           ev.te_pt,       "PT[ElectronTight_size]/F");
-  t_tightElecs_->Branch("Eta",          ev.te_eta,      "Eta[ElectronTight_size]/F");
-  t_tightElecs_->Branch("Phi",          ev.te_phi,      "Phi[ElectronTight_size]/F");
-  t_tightElecs_->Branch("Mass",         ev.te_mass,     "Mass[ElectronTight_size]/F");
-  t_tightElecs_->Branch("IsolationVar", ev.te_relIso,   "IsolationVar[ElectronTight_size]/F");
-
-  t_looseMuons_->Branch("MuonLoose_size", &ev.nlm,      "MuonLoose_size/I");
-  t_looseMuons_->Branch("Charge",       ev.lm_ch,       "Charge[MuonLoose_size]/I");
-  t_looseMuons_->Branch("Particle",     ev.lm_g,        "Particle[MuonLoose_size]/I");
-  t_looseMuons_->Branch("PT",           ev.lm_pt,       "PT[MuonLoose_size]/F");
-  t_looseMuons_->Branch("Eta",          ev.lm_eta,      "Eta[MuonLoose_size]/F");
-  t_looseMuons_->Branch("Phi",          ev.lm_phi,      "Phi[MuonLoose_size]/F");
-  t_looseMuons_->Branch("Mass",         ev.lm_mass,     "Mass[MuonLoose_size]/F");
-  t_looseMuons_->Branch("IsolationVar", ev.lm_relIso,   "IsolationVar[MuonLoose_size]/F");
-
-  t_tightMuons_->Branch("MuonTight_size", &ev.ntm,      "MuonTight_size/I");
-  t_tightMuons_->Branch("Charge",       ev.tm_ch,       "Charge[MuonTight_size]/I");
-  t_tightMuons_->Branch("Particle",     ev.tm_g,        "Particle[MuonTight_size]/I");
-  t_tightMuons_->Branch("PT",           ev.tm_pt,       "PT[MuonTight_size]/F");
-  t_tightMuons_->Branch("Eta",          ev.tm_eta,      "Eta[MuonTight_size]/F");
-  t_tightMuons_->Branch("Phi",          ev.tm_phi,      "Phi[MuonTight_size]/F");
-  t_tightMuons_->Branch("Mass",         ev.tm_mass,     "Mass[MuonTight_size]/F");
-  t_tightMuons_->Branch("IsolationVar", ev.tm_relIso,   "IsolationVar[MuonTight_size]/F");
-
-  t_puppiJets_->Branch("JetPUPPI_size", &ev.nj,         "JetPUPPI_size/I");
-  t_puppiJets_->Branch("ID",            ev.j_id,        "ID[JetPUPPI_size]/I");
-  t_puppiJets_->Branch("GenJet",        ev.j_g,         "GenJet[JetPUPPI_size]/I");
-  t_puppiJets_->Branch("PT",            ev.j_pt,        "PT[JetPUPPI_size]/F");
-  t_puppiJets_->Branch("Eta",           ev.j_eta,       "Eta[JetPUPPI_size]/F");
-  t_puppiJets_->Branch("Phi",           ev.j_phi,       "Phi[JetPUPPI_size]/F");
-  t_puppiJets_->Branch("Mass",          ev.j_mass,      "Mass[JetPUPPI_size]/F");
-  t_puppiJets_->Branch("MVAv2",         ev.j_mvav2,     "MVAv2[JetPUPPI_size]/I");
-  t_puppiJets_->Branch("DeepCSV",       ev.j_deepcsv,   "DeepCSV[JetPUPPI_size]/I");
-  t_puppiJets_->Branch("PartonFlavor",  ev.j_flav,      "PartonFlavor[JetPUPPI_size]/I");
-  t_puppiJets_->Branch("HadronFlavor",  ev.j_hadflav,   "HadronFlavor[JetPUPPI_size]/I");
-  t_puppiJets_->Branch("GenPartonPID",  ev.j_pid,       "GenPartonPID[JetPUPPI_size]/I");
-
-  t_puppiMET_->Branch("PuppiMissingET_size", &ev.nmet,  "PuppiMissingET_size/I");
-  t_puppiMET_->Branch("MET",            ev.met_pt,      "MET[PuppiMissingET_size]/F");
-  t_puppiMET_->Branch("Phi",            ev.met_phi,     "Phi[PuppiMissingET_size]/F");
-  t_puppiMET_->Branch("Eta",            ev.met_eta,     "Eta[PuppiMissingET_size]/F");
+  bookMiniEvent(t_event_, t_genParts_, t_vertices_, t_genJets_, t_looseElecs_, t_tightElecs_, t_looseMuons_, t_tightMuons_, t_puppiJets_, t_puppiMET_, ev, false, compact);
 }
 
+void createMiniEventTree(TTree *t_event_, MiniEvent_t &ev, MiniEventCompactColumns *compact)
+{
+  bookMiniEvent(t_event_, t_event_, t_event_, t_event_, t_event_, t_event_, t_event_, t_event_, t_event_, t_event_, ev, true, compact);
+}
+
+Char_t * MiniEventCompactColumns::add(const std::vector<Int_t> & from, const Int_t * size)
+{
+  columns_.push_back(Column{&from, size, std::vector<Char_t>(from.size())});
+  return columns_.back().to.data();
+}
+
+void MiniEventCompactColumns::update()
+{
+  for (Column & column : columns_)
+    std::transform(column.from->begin(), column.from->begin() + *column.size, column.to.begin(),
+                   [](Int_t value) { return static_cast<Char_t>(value); });
+}
+
+bool MiniEvent_t::addGenParticle()
+{
+  if (ngl >= kMaxGenParticles) { ntrunc++; return false; }
+  grow(ngl, gl_p, gl_px, gl_py, gl_pz, gl_nrj, gl_pt, gl_eta, gl_phi, gl_mass, gl_relIso, gl_pid, gl_ch, gl_st);
+  return true;
+}
+
+bool MiniEvent_t::addGenJet()
+{
+  if (ngj >= kMaxGenJets) { ntrunc++; return false; }
+  grow(ngj, gj_pt, gj_eta, gj_phi, gj_mass);
+  return true;
+}
+
+bool MiniEvent_t::addVertex()
+{
+  if (nvtx >= kMaxVertices) { ntrunc++; return false; }
+  grow(nvtx, v_pt2);
+  return true;
+}
+
+bool MiniEvent_t::addLooseElectron()
+{
+  if (nle >= kMaxLeptons) { ntrunc++; return false; }
+  grow(nle, le_ch, le_g, le_pt, le_eta, le_phi, le_mass, le_relIso);
+  return true;
+}
+
+bool MiniEvent_t::addTightElectron()
+{
+  if (nte >= kMaxLeptons) { ntrunc++; return false; }
+  grow(nte, te_ch, te_g, te_pt, te_eta, te_phi, te_mass, te_relIso);
+  return true;
+}
+
+bool MiniEvent_t::addLooseMuon()
+{
+  if (nlm >= kMaxLeptons) { ntrunc++; return false; }
+  grow(nlm, lm_ch, lm_g, lm_pt, lm_eta, lm_phi, lm_mass, lm_relIso);
+  return true;
+}
+
+bool MiniEvent_t::addTightMuon()
+{
+  if (ntm >= kMaxLeptons) { ntrunc++; return false; }
+  grow(ntm, tm_ch, tm_g, tm_pt, tm_eta, tm_phi, tm_mass, tm_relIso);
+  return true;
+}
+
+bool MiniEvent_t::addJet()
+{
+  if (nj >= kMaxJets) { ntrunc++; return false; }
+  grow(nj, j_id, j_g, j_mvav2, j_deepcsv, j_flav, j_hadflav, j_pid, j_pt, j_eta, j_phi, j_mass);
+  return true;
+}
+
+bool MiniEvent_t::addMET()
+{
+  if (nmet >= kMaxMET) { ntrunc++; return false; }
+  grow(nmet, met_pt, met_eta, met_phi);
+  return true;
+}
+
+void MiniEvent_t::allocate()
+{
+  grow(kMaxGenParticles-1, gl_p, gl_px, gl_py, gl_pz, gl_nrj, gl_pt, gl_eta, gl_phi, gl_mass, gl_relIso, gl_pid, gl_ch, gl_st);
+  grow(kMaxGenJets-1, gj_pt, gj_eta, gj_phi, gj_mass);
+  grow(kMaxVertices-1, v_pt2);
+  grow(kMaxLeptons-1, le_ch, le_g, le_pt, le_eta, le_phi, le_mass, le_relIso);
+  grow(kMaxLeptons-1, te_ch, te_g, te_pt, te_eta, te_phi, te_mass, te_relIso);
+  grow(kMaxLeptons-1, lm_ch, lm_g, lm_pt, lm_eta, lm_phi, lm_mass, lm_relIso);
+  grow(kMaxLeptons-1, tm_ch, tm_g, tm_pt, tm_eta, tm_phi, tm_mass, tm_relIso);
+  grow(kMaxJets-1, j_id, j_g, j_mvav2, j_deepcsv, j_flav, j_hadflav, j_pid, j_pt, j_eta, j_phi, j_mass);
+  grow(kMaxMET-1, met_pt, met_eta, met_phi);
+}
+
+void MiniEvent_t::copyTo(MiniEvent_t &ev) const
+{
+  ev.run = run; ev.event = event; ev.lumi = lumi;
+  ev.ntrunc = ntrunc;
+
+  ev.ngl = ngl;
+  copyColumn(gl_p, ev.gl_p, ngl);       copyColumn(gl_px, ev.gl_px, ngl);
+  copyColumn(gl_py, ev.gl_py, ngl);     copyColumn(gl_pz, ev.gl_pz, ngl);
+  copyColumn(gl_nrj, ev.gl_nrj, ngl);   copyColumn(gl_pt, ev.gl_pt, ngl);
+  copyColumn(gl_eta, ev.gl_eta, ngl);   copyColumn(gl_phi, ev.gl_phi, ngl);
+  copyColumn(gl_mass, ev.gl_mass, ngl); copyColumn(gl_relIso, ev.gl_relIso, ngl);
+  copyColumn(gl_pid, ev.gl_pid, ngl);   copyColumn(gl_ch, ev.gl_ch, ngl);
+  copyColumn(gl_st, ev.gl_st, ngl);
+
+  ev.ngj = ngj;
+  copyColumn(gj_pt, ev.gj_pt, ngj);     copyColumn(gj_eta, ev.gj_eta, ngj);
+  copyColumn(gj_phi, ev.gj_phi, ngj);   copyColumn(gj_mass, ev.gj_mass, ngj);
+
+  ev.nvtx = nvtx;
+  copyColumn(v_pt2, ev.v_pt2, nvtx);
+
+  ev.nle = nle;
+  copyColumn(le_ch, ev.le_ch, nle);     copyColumn(le_g, ev.le_g, nle);
+  copyColumn(le_pt, ev.le_pt, nle);     copyColumn(le_eta, ev.le_eta, nle);
+  copyColumn(le_phi, ev.le_phi, nle);   copyColumn(le_mass, ev.le_mass, nle);
+  copyColumn(le_relIso, ev.le_relIso, nle);
+
+  ev.nte = nte;
+  copyColumn(te_ch, ev.te_ch, nte);     copyColumn(te_g, ev.te_g, nte);
+  copyColumn(te_pt, ev.te_pt, nte);     copyColumn(te_eta, ev.te_eta, nte);
+  copyColumn(te_phi, ev.te_phi, nte);   copyColumn(te_mass, ev.te_mass, nte);
+  copyColumn(te_relIso, ev.te_relIso, nte);
+
+  ev.nlm = nlm;
+  copyColumn(lm_ch, ev.lm_ch, nlm);     copyColumn(lm_g, ev.lm_g, nlm);
+  copyColumn(lm_pt, ev.lm_pt, nlm);     copyColumn(lm_eta, ev.lm_eta, nlm);
+  copyColumn(lm_phi, ev.lm_phi, nlm);   copyColumn(lm_mass, ev.lm_mass, nlm);
+  copyColumn(lm_relIso, ev.lm_relIso, nlm);
+
+  ev.ntm = ntm;
+  copyColumn(tm_ch, ev.tm_ch, ntm);     copyColumn(tm_g, ev.tm_g, ntm);
+  copyColumn(tm_pt, ev.tm_pt, ntm);     copyColumn(tm_eta, ev.tm_eta, ntm);
+  copyColumn(tm_phi, ev.tm_phi, ntm);   copyColumn(tm_mass, ev.tm_mass, ntm);
+  copyColumn(tm_relIso, ev.tm_relIso, ntm);
+
+  ev.nj = nj;
+  copyColumn(j_id, ev.j_id, nj);           copyColumn(j_g, ev.j_g, nj);
+  copyColumn(j_mvav2, ev.j_mvav2, nj);     copyColumn(j_deepcsv, ev.j_deepcsv, nj);
+  copyColumn(j_flav, ev.j_flav, nj);       copyColumn(j_hadflav, ev.j_hadflav, nj);
+  copyColumn(j_pid, ev.j_pid, nj);         copyColumn(j_pt, ev.j_pt, nj);
+  copyColumn(j_eta, ev.j_eta, nj);         copyColumn(j_phi, ev.j_phi, nj);
+  copyColumn(j_mass, ev.j_mass, nj);
+
+  ev.nmet = nmet;
+  copyColumn(met_pt, ev.met_pt, nmet);  copyColumn(met_eta, ev.met_eta, nmet);
+  copyColumn(met_phi, ev.met_phi, nmet);
+}
@@ -0,0 +1,210 @@
+#include "PhaseTwoAnalysis/NTupler/interface/MiniEventReader.h"
+
+#include "FWCore/Utilities/interface/Exception.h"
+
+#include "RVersion.h"
+#include "TChain.h"
+#include "TFile.h"
+#include "TKey.h"
+#include "TTreeReader.h"
+#include "TTreeReaderArray.h"
+#include "TTreeReaderValue.h"
+
+#if ROOT_VERSION_CODE >= ROOT_VERSION(6,12,0)
+#include "ROOT/TTreeProcessorMT.hxx"
+#include "TROOT.h"
+#endif
+
+#include <algorithm>
+#include <atomic>
+
+namespace {
+
+  template <class T>
+  MiniEventReader::Span<T> span(TTreeReaderArray<T> & array)
+  {
+    const size_t n = array.GetSize();
+    return MiniEventReader::Span<T>(n > 0 ? &array.At(0) : nullptr, n);
+  }
+
+  template <class T>
+  void makeArrays(TTreeReader & reader, const std::vector<std::string> & branches, std::vector<std::unique_ptr<TTreeReaderArray<T>>> & arrays)
+  {
+    for (const std::string & branch : branches)
+      arrays.emplace_back(new TTreeReaderArray<T>(reader, branch.c_str()));
+  }
+
+  template <class T>
+  void checkArrays(const std::vector<std::string> & branches, const std::vector<std::unique_ptr<TTreeReaderArray<T>>> & arrays)
+  {
+    for (size_t i = 0; i < arrays.size(); i++)
+      if (arrays[i]->GetSetupStatus() < 0)
+        throw cms::Exception("MiniEventReader") << "cannot read branch " << branches[i]
+                                                << " (missing, or stored with another type)";
+  }
+
+}
+
+MiniEventReader::MiniEventReader(const std::vector<std::string> & files, const std::string & directory) :
+  files_(files),
+  directory_(directory),
+  singleTree_(false)
+{
+  if (files_.empty()) throw cms::Exception("MiniEventReader") << "no input file";
+
+  std::unique_ptr<TFile> file(TFile::Open(files_.front().c_str()));
+  if (!file || file->IsZombie()) throw cms::Exception("MiniEventReader") << "cannot open " << files_.front();
+  TDirectory * dir = file->GetDirectory(directory_.c_str());
+  if (!dir) throw cms::Exception("MiniEventReader") << "no directory " << directory_ << " in " << files_.front();
+  // backend=RNTuple also writes an "Events" key, which is not a tree
+  if (TKey * key = dir->GetKey("Events")) {
+    const std::string className = key->GetClassName();
+    if (className.find("RNTuple") != std::string::npos)
+      throw cms::Exception("MiniEventReader") << "RNTuple not supported: " << files_.front() << ":" << directory_
+                                              << "/Events is a " << className << ", only the TTree backend can be read";
+    if (className != "TTree")
+      throw cms::Exception("MiniEventReader") << files_.front() << ":" << directory_ << "/Events is a " << className << ", not a TTree";
+    singleTree_ = true;
+  }
+  else if (!dir->GetKey("Event"))
+    throw cms::Exception("MiniEventReader") << "no MiniEvent tree in " << files_.front() << ":" << directory_;
+}
+
+MiniEventReader::~MiniEventReader()
+{
+}
+
+std::string
+MiniEventReader::branch(const std::string & collection, const std::string & name) const
+{
+  return collection + (singleTree_ ? "_" : ".") + name;
+}
+
+template <>
+MiniEventReader::Column<Int_t>
+MiniEventReader::column<Int_t>(const std::string & collection, const std::string & name)
+{
+  if (std::find(collections_.begin(), collections_.end(), collection) == collections_.end()) collections_.push_back(collection);
+  intBranches_.push_back(branch(collection, name));
+  return Column<Int_t>{(unsigned int)intBranches_.size() - 1};
+}
+
+template <>
+MiniEventReader::Column<Float_t>
+MiniEventReader::column<Float_t>(const std::string & collection, const std::string & name)
+{
+  if (std::find(collections_.begin(), collections_.end(), collection) == collections_.end()) collections_.push_back(collection);
+  floatBranches_.push_back(branch(collection, name));
+  return Column<Float_t>{(unsigned int)floatBranches_.size() - 1};
+}
+
+template <>
+MiniEventReader::Column<Char_t>
+MiniEventReader::column<Char_t>(const std::string & collection, const std::string & name)
+{
+  if (std::find(collections_.begin(), collections_.end(), collection) == collections_.end()) collections_.push_back(collection);
+  charBranches_.push_back(branch(collection, name));
+  return Column<Char_t>{(unsigned int)charBranches_.size() - 1};
+}
+
+unsigned long
+MiniEventReader::run(const std::function<void(const Entry &)> & process, unsigned int nThreads) const
+{
+#if ROOT_VERSION_CODE >= ROOT_VERSION(6,12,0)
+  if (nThreads > 1 && singleTree_) {
+    ROOT::EnableImplicitMT(nThreads);
+    std::vector<std::string_view> files(files_.begin(), files_.end());
+    ROOT::TTreeProcessorMT processor(files, directory_ + "/Events");
+    std::atomic<unsigned long> nEvents(0);
+    processor.Process([&](TTreeReader & reader) {
+        Entry entry(reader, *this);
+        unsigned long n = 0;
+        while (entry.next()) {
+          process(entry);
+          n++;
+        }
+        nEvents += n;
+      });
+    return nEvents;
+  }
+#endif
+
+  TChain chain((directory_ + (singleTree_ ? "/Events" : "/Event")).c_str());
+  for (const std::string & file : files_) chain.Add(file.c_str());
+  // the collection trees are filled once per event, joined by entry
+  std::vector<std::unique_ptr<TChain>> friends;
+  if (!singleTree_) {
+    for (const std::string & collection : collections_) {
+      friends.emplace_back(new TChain((directory_ + "/" + collection).c_str()));
+      for (const std::string & file : files_) friends.back()->Add(file.c_str());
+      chain.AddFriend(friends.back().get(), collection.c_str());
+    }
+  }
+
+  TTreeReader reader(&chain);
+  Entry entry(reader, *this);
+  unsigned long nEvents = 0;
+  while (entry.next()) {
+    process(entry);
+    nEvents++;
+  }
+  return nEvents;
+}
+
+MiniEventReader::Entry::Entry(TTreeReader & reader, const MiniEventReader & owner) :
+  reader_(reader),
+  owner_(owner),
+  checked_(false),
+  run_(new TTreeReaderValue<Int_t>(reader, "Run")),
+  event_(new TTreeReaderValue<Int_t>(reader, "Event")),
+  lumi_(new TTreeReaderValue<Int_t>(reader, "Lumi"))
+{
+  makeArrays(reader, owner.intBranches_, ints_);
+  makeArrays(reader, owner.floatBranches_, floats_);
+  makeArrays(reader, owner.charBranches_, chars_);
+}
+
+MiniEventReader::Entry::~Entry()
+{
+}
+
+bool
+MiniEventReader::Entry::next()
+{
+  if (!reader_.Next()) return false;
+  if (!checked_) {
+    checkSetup();
+    checked_ = true;
+  }
+  return true;
+}
+
+void
+MiniEventReader::Entry::checkSetup() const
+{
+  checkArrays(owner_.intBranches_, ints_);
+  checkArrays(owner_.floatBranches_, floats_);
+  checkArrays(owner_.charBranches_, chars_);
+}
+
+Int_t MiniEventReader::Entry::run() const   { return **run_; }
+Int_t MiniEventReader::Entry::event() const { return **event_; }
+Int_t MiniEventReader::Entry::lumi() const  { return **lumi_; }
+
+MiniEventReader::Span<Int_t>
+MiniEventReader::Entry::get(Column<Int_t> column) const
+{
+  return span(*ints_[column.index]);
+}
+
+MiniEventReader::Span<Float_t>
+MiniEventReader::Entry::get(Column<Float_t> column) const
+{
+  return span(*floats_[column.index]);
+}
+
+MiniEventReader::Span<Char_t>
+MiniEventReader::Entry::get(Column<Char_t> column) const
+{
+  return span(*chars_[column.index]);
+}
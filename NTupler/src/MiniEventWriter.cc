@@ -0,0 +1,274 @@
+#include "PhaseTwoAnalysis/NTupler/interface/MiniEventWriter.h"
+
+#include "FWCore/MessageLogger/interface/MessageLogger.h"
+#include "FWCore/ServiceRegistry/interface/Service.h"
+#include "FWCore/Utilities/interface/Exception.h"
+#include "CommonTools/UtilAlgos/interface/TFileService.h"
+
+#include "Compression.h"
+#include "RVersion.h"
+#include "TBranch.h"
+#include "TFile.h"
+#include "TObjArray.h"
+
+#if ROOT_VERSION_CODE >= ROOT_VERSION(6,34,0)
+#include "PhaseTwoAnalysis/NTupler/interface/MiniEventRecords.h"
+
+#include <ROOT/RNTupleModel.hxx>
+#include <ROOT/RNTupleWriter.hxx>
+
+// the RNTuple classes left ROOT::Experimental in 6.36
+#if ROOT_VERSION_CODE >= ROOT_VERSION(6,36,0)
+namespace rntuple = ROOT;
+#else
+namespace rntuple = ROOT::Experimental;
+#endif
+#endif
+
+namespace {
+
+  // 0 if the compression of the output file is kept
+  int compressionSettings(const edm::ParameterSet& outputConfig)
+  {
+    const std::string algorithm = outputConfig.getParameter<std::string>("compressionAlgorithm");
+    if (algorithm.empty()) return 0;
+    int level = outputConfig.getParameter<int>("compressionLevel");
+    if (algorithm == "ZLIB") return ROOT::CompressionSettings(ROOT::kZLIB, level);
+    if (algorithm == "LZMA") return ROOT::CompressionSettings(ROOT::kLZMA, level);
+#if ROOT_VERSION_CODE >= ROOT_VERSION(6,12,0)
+    if (algorithm == "LZ4") return ROOT::CompressionSettings(ROOT::kLZ4, level);
+#endif
+    throw cms::Exception("Configuration") << "MiniEventWriter: unsupported compression algorithm '" << algorithm << "'";
+  }
+
+}
+
+#if ROOT_VERSION_CODE >= ROOT_VERSION(6,34,0)
+struct MiniEventWriter::RNTupleOutput
+{
+  std::shared_ptr<Int_t> run, event, lumi, ntrunc;
+  std::shared_ptr<std::vector<minievent::Particle>> genParts;
+  std::shared_ptr<std::vector<minievent::GenJet>> genJets;
+  std::shared_ptr<std::vector<minievent::Vertex>> vertices;
+  std::shared_ptr<std::vector<minievent::Lepton>> looseElecs, tightElecs, looseMuons, tightMuons;
+  std::shared_ptr<std::vector<minievent::Jet>> puppiJets;
+  std::shared_ptr<std::vector<minievent::MissingET>> puppiMET;
+  std::unique_ptr<rntuple::RNTupleWriter> writer;
+
+  void fill(const MiniEvent_t & ev)
+  {
+    *run = ev.run; *event = ev.event; *lumi = ev.lumi;
+    *ntrunc = ev.ntrunc;
+
+    genParts->resize(ev.ngl);
+    for (int i = 0; i < ev.ngl; i++)
+      (*genParts)[i] = minievent::Particle{ev.gl_pid[i], ev.gl_ch[i], ev.gl_st[i],
+                                           ev.gl_p[i], ev.gl_px[i], ev.gl_py[i], ev.gl_pz[i], ev.gl_nrj[i],
+                                           ev.gl_pt[i], ev.gl_eta[i], ev.gl_phi[i], ev.gl_mass[i], ev.gl_relIso[i]};
+    genJets->resize(ev.ngj);
+    for (int i = 0; i < ev.ngj; i++)
+      (*genJets)[i] = minievent::GenJet{ev.gj_pt[i], ev.gj_eta[i], ev.gj_phi[i], ev.gj_mass[i]};
+    vertices->resize(ev.nvtx);
+    for (int i = 0; i < ev.nvtx; i++)
+      (*vertices)[i] = minievent::Vertex{ev.v_pt2[i]};
+
+    looseElecs->resize(ev.nle);
+    for (int i = 0; i < ev.nle; i++)
+      (*looseElecs)[i] = minievent::Lepton{ev.le_ch[i], ev.le_g[i], ev.le_pt[i], ev.le_eta[i], ev.le_phi[i], ev.le_mass[i], ev.le_relIso[i]};
+    tightElecs->resize(ev.nte);
+    for (int i = 0; i < ev.nte; i++)
+      (*tightElecs)[i] = minievent::Lepton{ev.te_ch[i], ev.te_g[i], ev.te_pt[i], ev.te_eta[i], ev.te_phi[i], ev.te_mass[i], ev.te_relIso[i]};
+    looseMuons->resize(ev.nlm);
+    for (int i = 0; i < ev.nlm; i++)
+      (*looseMuons)[i] = minievent::Lepton{ev.lm_ch[i], ev.lm_g[i], ev.lm_pt[i], ev.lm_eta[i], ev.lm_phi[i], ev.lm_mass[i], ev.lm_relIso[i]};
+    tightMuons->resize(ev.ntm);
+    for (int i = 0; i < ev.ntm; i++)
+      (*tightMuons)[i] = minievent::Lepton{ev.tm_ch[i], ev.tm_g[i], ev.tm_pt[i], ev.tm_eta[i], ev.tm_phi[i], ev.tm_mass[i], ev.tm_relIso[i]};
+
+    puppiJets->resize(ev.nj);
+    for (int i = 0; i < ev.nj; i++)
+      (*puppiJets)[i] = minievent::Jet{ev.j_id[i], ev.j_g[i], ev.j_pt[i], ev.j_eta[i], ev.j_phi[i], ev.j_mass[i],
+                                       ev.j_mvav2[i], ev.j_deepcsv[i], ev.j_flav[i], ev.j_hadflav[i], ev.j_pid[i]};
+    puppiMET->resize(ev.nmet);
+    for (int i = 0; i < ev.nmet; i++)
+      (*puppiMET)[i] = minievent::MissingET{ev.met_pt[i], ev.met_phi[i], ev.met_eta[i]};
+
+    writer->Fill();
+  }
+};
+#else
+struct MiniEventWriter::RNTupleOutput
+{
+  void fill(const MiniEvent_t &) {}
+};
+#endif
+
+MiniEventWriter::MiniEventWriter(const edm::ParameterSet& iConfig) :
+  nTruncatedEvents_(0),
+  nTruncatedObjects_(0),
+  lumis_(nullptr),
+  lumiRun_(0),
+  lumiLumi_(0),
+  lumiEvents_(0),
+  lumisSinceCheckpoint_(0)
+{
+  const edm::ParameterSet& outputConfig = iConfig.getParameter<edm::ParameterSet>("output");
+  const std::string backend = outputConfig.getParameter<std::string>("backend");
+  checkpointLumis_ = outputConfig.getParameter<int>("checkpointLumis");
+
+  edm::Service<TFileService> fs;
+  lumis_ = fs->make<TTree>("Lumis","Lumis");
+  lumis_->Branch("Run",    &lumiRun_,    "Run/I");
+  lumis_->Branch("Lumi",   &lumiLumi_,   "Lumi/I");
+  lumis_->Branch("Events", &lumiEvents_, "Events/I");
+
+  if (backend == "RNTuple") {
+    if (checkpointLumis_ > 0)
+      throw cms::Exception("Configuration") << "MiniEventWriter: the RNTuple backend cannot be checkpointed (checkpointLumis must be 0)";
+    bookRNTuple(outputConfig);
+    return;
+  }
+  if (backend != "TTree")
+    throw cms::Exception("Configuration") << "MiniEventWriter: unknown output backend '" << backend << "' (TTree or RNTuple)";
+
+  ev_.allocate();
+  MiniEventCompactColumns *compact = outputConfig.getParameter<bool>("compact") ? &compact_ : 0;
+  if (outputConfig.getParameter<bool>("singleTree")) {
+    TTree *t_events_ = fs->make<TTree>("Events","Events");
+    createMiniEventTree(t_events_, ev_, compact);
+    trees_.push_back(t_events_);
+  } else {
+    TTree *t_event_      = fs->make<TTree>("Event","Event");
+    TTree *t_genParts_   = fs->make<TTree>("Particle","Particle");
+    TTree *t_vertices_   = fs->make<TTree>("Vertex","Vertex");
+    TTree *t_genJets_    = fs->make<TTree>("GenJet","GenJet");
+    TTree *t_looseElecs_ = fs->make<TTree>("ElectronLoose","ElectronLoose");
+    TTree *t_tightElecs_ = fs->make<TTree>("ElectronTight","ElectronTight");
+    TTree *t_looseMuons_ = fs->make<TTree>("MuonLoose","MuonLoose");
+    TTree *t_tightMuons_ = fs->make<TTree>("MuonTight","MuonTight");
+    TTree *t_puppiJets_  = fs->make<TTree>("JetPUPPI","JetPUPPI");
+    TTree *t_puppiMET_   = fs->make<TTree>("PuppiMissingET","PuppiMissingET");
+    createMiniEventTree(t_event_, t_genParts_, t_vertices_, t_genJets_, t_looseElecs_, t_tightElecs_, t_looseMuons_, t_tightMuons_, t_puppiJets_, t_puppiMET_, ev_, compact);
+    trees_ = {t_event_, t_genParts_, t_vertices_, t_genJets_, t_looseElecs_, t_tightElecs_, t_looseMuons_, t_tightMuons_, t_puppiJets_, t_puppiMET_};
+  }
+
+  for (TTree *tree : trees_) configure(tree, outputConfig);
+}
+
+MiniEventWriter::~MiniEventWriter()
+{
+}
+
+void
+MiniEventWriter::fill(const MiniEvent_t & ev) const
+{
+  std::lock_guard<std::mutex> guard(mutex_);
+  if (ev.ntrunc > 0) {
+    nTruncatedEvents_++;
+    nTruncatedObjects_ += ev.ntrunc;
+  }
+  if (rntuple_) {
+    rntuple_->fill(ev);
+    return;
+  }
+  ev.copyTo(ev_);
+  compact_.update();
+  for (TTree *tree : trees_) tree->Fill();
+}
+
+void
+MiniEventWriter::endLuminosityBlock(int run, int lumi, unsigned long events) const
+{
+  std::lock_guard<std::mutex> guard(mutex_);
+  lumiRun_ = run;
+  lumiLumi_ = lumi;
+  lumiEvents_ = events;
+  lumis_->Fill();
+  if (checkpointLumis_ > 0 && ++lumisSinceCheckpoint_ >= checkpointLumis_) {
+    checkpoint();
+    lumisSinceCheckpoint_ = 0;
+  }
+}
+
+void
+MiniEventWriter::checkpoint() const
+{
+  // the trees are written with their baskets, replacing the previous
+  // checkpoint; TFileService writes them again when it closes the file
+  edm::Service<TFileService> fs;
+  TFile & file = fs->file();
+  file.Write(0, TObject::kOverwrite);
+  file.Flush();
+  edm::LogInfo("MiniEventWriter") << "Checkpoint of " << file.GetName() << " after run " << lumiRun_ << ", lumi " << lumiLumi_;
+}
+
+void
+MiniEventWriter::report() const
+{
+  std::lock_guard<std::mutex> guard(mutex_);
+  if (nTruncatedEvents_ > 0)
+    edm::LogWarning("MiniEventWriter") << nTruncatedObjects_ << " objects in " << nTruncatedEvents_
+                                       << " events were dropped because a collection was full (see the Truncated branch)";
+}
+
+void
+MiniEventWriter::close() const
+{
+  std::lock_guard<std::mutex> guard(mutex_);
+  rntuple_.reset();
+}
+
+void
+MiniEventWriter::configure(TTree *tree, const edm::ParameterSet& outputConfig)
+{
+  int basketSize = outputConfig.getParameter<int>("basketSize");
+  if (basketSize > 0) tree->SetBasketSize("*", basketSize);
+
+  long long autoFlush = outputConfig.getParameter<long long>("autoFlush");
+  if (autoFlush != 0) tree->SetAutoFlush(autoFlush);
+
+  // only the checkpoints write the headers of the trees, which then always
+  // describe the events of the luminosity blocks listed in Lumis
+  if (checkpointLumis_ > 0) tree->SetAutoSave(0);
+
+  int settings = compressionSettings(outputConfig);
+  if (settings == 0) return;
+  TObjArray *branches = tree->GetListOfBranches();
+  for (int i = 0; i < branches->GetEntriesFast(); i++)
+    static_cast<TBranch *>(branches->UncheckedAt(i))->SetCompressionSettings(settings);
+}
+
+void
+MiniEventWriter::bookRNTuple(const edm::ParameterSet& outputConfig)
+{
+#if ROOT_VERSION_CODE >= ROOT_VERSION(6,34,0)
+  rntuple_.reset(new RNTupleOutput());
+  RNTupleOutput & out = *rntuple_;
+
+  auto model = rntuple::RNTupleModel::Create();
+  out.run        = model->MakeField<Int_t>("Run");
+  out.event      = model->MakeField<Int_t>("Event");
+  out.lumi       = model->MakeField<Int_t>("Lumi");
+  out.ntrunc     = model->MakeField<Int_t>("Truncated");
+  out.genParts   = model->MakeField<std::vector<minievent::Particle>>("Particle");
+  out.genJets    = model->MakeField<std::vector<minievent::GenJet>>("GenJet");
+  out.vertices   = model->MakeField<std::vector<minievent::Vertex>>("Vertex");
+  out.looseElecs = model->MakeField<std::vector<minievent::Lepton>>("ElectronLoose");
+  out.tightElecs = model->MakeField<std::vector<minievent::Lepton>>("ElectronTight");
+  out.looseMuons = model->MakeField<std::vector<minievent::Lepton>>("MuonLoose");
+  out.tightMuons = model->MakeField<std::vector<minievent::Lepton>>("MuonTight");
+  out.puppiJets  = model->MakeField<std::vector<minievent::Jet>>("JetPUPPI");
+  out.puppiMET   = model->MakeField<std::vector<minievent::MissingET>>("PuppiMissingET");
+
+  rntuple::RNTupleWriteOptions options;
+  int settings = compressionSettings(outputConfig);
+  if (settings != 0) options.SetCompression(settings);
+  long long autoFlush = outputConfig.getParameter<long long>("autoFlush");
+  if (autoFlush < 0) options.SetApproxZippedClusterSize(-autoFlush);
+
+  edm::Service<TFileService> fs;
+  out.writer = rntuple::RNTupleWriter::Append(std::move(model), "Events", *fs->getBareDirectory(), options);
+#else
+  throw cms::Exception("Configuration") << "MiniEventWriter: the RNTuple backend needs ROOT >= 6.34 (this is ROOT " << ROOT_RELEASE << ")";
+#endif
+}
@@ -0,0 +1 @@
+#include "PhaseTwoAnalysis/NTupler/interface/MiniEventRecords.h"
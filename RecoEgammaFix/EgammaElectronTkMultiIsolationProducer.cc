@@ -0,0 +1,133 @@
+//*****************************************************************************
+// File:      EgammaElectronTkMultiIsolationProducer.cc
+// ----------------------------------------------------------------------------
+// Track isolation of the electrons in several cones at once, see the header.
+//=============================================================================
+//*****************************************************************************
+
+
+// Framework
+#include "FWCore/Framework/interface/Event.h"
+#include "FWCore/Framework/interface/EventSetup.h"
+#include "DataFormats/Common/interface/Handle.h"
+#include "DataFormats/Common/interface/ValueMap.h"
+#include "FWCore/Utilities/interface/Exception.h"
+
+#include "DataFormats/EgammaCandidates/interface/GsfElectronFwd.h"
+#include "DataFormats/GsfTrackReco/interface/GsfTrack.h"
+
+#include "RecoEgamma/EgammaIsolationAlgos/plugins/EgammaElectronTkMultiIsolationProducer.h"
+
+#include "Math/GenVector/VectorUtil.h"
+
+#include <algorithm>
+#include <cmath>
+
+EgammaElectronTkMultiIsolationProducer::EgammaElectronTkMultiIsolationProducer(const edm::ParameterSet& config)
+{
+  electronProducer_  = consumes<reco::GsfElectronCollection>(config.getParameter<edm::InputTag>("electronProducer"));
+  trackProducer_     = consumes<reco::TrackCollection>(config.getParameter<edm::InputTag>("trackProducer"));
+  beamspotProducer_  = consumes<reco::BeamSpot>(config.getParameter<edm::InputTag>("BeamspotProducer"));
+
+  ptMin_       = config.getParameter<double>("ptMin");
+  maxVtxDist_  = config.getParameter<double>("maxVtxDist");
+  drb_         = config.getParameter<double>("maxVtxDistXY");
+
+  maxExtRadius_ = 0.;
+  for (const auto & pset : config.getParameter<std::vector<edm::ParameterSet>>("cones")) {
+    Cone cone;
+    cone.label           = pset.getParameter<std::string>("label");
+    cone.extRadius       = pset.getParameter<double>("extRadius");
+    cone.intRadiusBarrel = pset.getParameter<double>("intRadiusBarrel");
+    cone.intRadiusEndcap = pset.getParameter<double>("intRadiusEndcap");
+    cone.stripBarrel     = pset.getParameter<double>("stripBarrel");
+    cone.stripEndcap     = pset.getParameter<double>("stripEndcap");
+    for (const auto & other : cones_)
+      if (other.label == cone.label)
+        throw cms::Exception("Configuration") << "EgammaElectronTkMultiIsolationProducer: cone label '" << cone.label << "' used twice";
+    maxExtRadius_ = std::max(maxExtRadius_, cone.extRadius);
+    cones_.push_back(cone);
+  }
+  if (cones_.empty())
+    throw cms::Exception("Configuration") << "EgammaElectronTkMultiIsolationProducer: no cone configured";
+
+  // as ElectronTkIsolation::setAlgosToReject()
+  algosToReject_ = {reco::TrackBase::jetCoreRegionalStep};
+  std::sort(algosToReject_.begin(), algosToReject_.end());
+
+  //register your products
+  for (const auto & cone : cones_) produces < edm::ValueMap<double> >(cone.label);
+
+}
+
+EgammaElectronTkMultiIsolationProducer::~EgammaElectronTkMultiIsolationProducer(){}
+
+bool
+EgammaElectronTkMultiIsolationProducer::passAlgo(const reco::TrackBase & track) const
+{
+  return !std::binary_search(algosToReject_.begin(), algosToReject_.end(), int(track.algo()));
+}
+
+void EgammaElectronTkMultiIsolationProducer::produce(edm::Event& iEvent, const edm::EventSetup& iSetup)
+{
+  edm::Handle< reco::GsfElectronCollection> electronHandle;
+  iEvent.getByToken(electronProducer_,electronHandle);
+
+  edm::Handle<reco::TrackCollection> tracks;
+  iEvent.getByToken(trackProducer_,tracks);
+
+  edm::Handle<reco::BeamSpot> beamSpotH;
+  iEvent.getByToken(beamspotProducer_,beamSpotH);
+  reco::TrackBase::Point beamspot = beamSpotH->position();
+
+  // the electron-independent part of the track selection, once per event
+  tracks_.clear();
+  for (const auto & track : *tracks) {
+    if (track.pt() < ptMin_) continue;
+    if (std::abs(track.dxy(beamspot)) > drb_) continue;
+    if (!passAlgo(track)) continue;
+    tracks_.push_back({track.eta(), &track});
+  }
+  std::sort(tracks_.begin(), tracks_.end());
+
+  const size_t nCones = cones_.size();
+  const size_t nElectrons = electronHandle->size();
+  ptSums_.assign(nCones * nElectrons, 0.);
+
+  for (size_t i = 0; i < nElectrons; ++i) {
+    const reco::GsfTrackRef & gsfTrack = electronHandle->at(i).gsfTrack();
+    const math::XYZVector momentumAtVtx = gsfTrack->momentum();
+    const double etaAtVtx = gsfTrack->eta();
+    const double vz = gsfTrack->vz();
+    const bool isBarrel = std::abs(etaAtVtx) < 1.479;
+
+    // |deta| <= dR, so no track outside this window is in any cone
+    auto first = std::lower_bound(tracks_.begin(), tracks_.end(), SelectedTrack{etaAtVtx - maxExtRadius_, nullptr});
+    auto last = std::upper_bound(first, tracks_.end(), SelectedTrack{etaAtVtx + maxExtRadius_, nullptr});
+    for (auto it = first; it != last; ++it) {
+      const reco::Track & track = *it->track;
+      if (std::abs(track.vz() - vz) > maxVtxDist_) continue;
+      double dr = ROOT::Math::VectorUtil::DeltaR(track.momentum(), momentumAtVtx);
+      if (dr >= maxExtRadius_) continue;
+      double deta = track.eta() - etaAtVtx;
+      for (size_t c = 0; c < nCones; ++c) {
+        const Cone & cone = cones_[c];
+        double intRadius = isBarrel ? cone.intRadiusBarrel : cone.intRadiusEndcap;
+        double strip = isBarrel ? cone.stripBarrel : cone.stripEndcap;
+        if (dr < cone.extRadius && dr >= intRadius && std::abs(deta) >= strip)
+          ptSums_[c * nElectrons + i] += track.pt();
+      }
+    }
+  }
+
+  //fill and insert the valuemaps
+  for (size_t c = 0; c < nCones; ++c) {
+    auto isoMap = std::make_unique<edm::ValueMap<double>>();
+    edm::ValueMap<double>::Filler filler(*isoMap);
+    filler.insert(electronHandle, ptSums_.begin() + c * nElectrons, ptSums_.begin() + (c + 1) * nElectrons);
+    filler.fill();
+    iEvent.put(std::move(isoMap), cones_[c].label);
+  }
+}
+
+DEFINE_FWK_MODULE(EgammaElectronTkMultiIsolationProducer);
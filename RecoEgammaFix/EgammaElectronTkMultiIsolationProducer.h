@@ -0,0 +1,74 @@
+#ifndef EgammaIsolationProducers_EgammaElectronTkMultiIsolationProducer_h
+#define EgammaIsolationProducers_EgammaElectronTkMultiIsolationProducer_h
+
+//*****************************************************************************
+// File:      EgammaElectronTkMultiIsolationProducer.h
+// ----------------------------------------------------------------------------
+// Track isolation of the electrons in several cones at once, with the
+// definition of ElectronTkIsolation::getPtTracks (dz option "vz"). The
+// tracks passing ptMin, maxVtxDistXY and the algorithm veto are selected
+// once per event and sorted in eta; each electron only looks at the tracks
+// within the largest external radius in eta and fills all the cones in the
+// same loop. One ValueMap<double> is put per cone, with the cone label as
+// instance name.
+//=============================================================================
+//*****************************************************************************
+
+#include "FWCore/Framework/interface/Frameworkfwd.h"
+#include "FWCore/Framework/interface/stream/EDProducer.h"
+
+#include "FWCore/Framework/interface/Event.h"
+#include "FWCore/Framework/interface/MakerMacros.h"
+
+#include "FWCore/ParameterSet/interface/ParameterSet.h"
+#include "DataFormats/BeamSpot/interface/BeamSpot.h"
+#include "DataFormats/EgammaCandidates/interface/GsfElectron.h"
+#include "DataFormats/TrackReco/interface/Track.h"
+
+#include <string>
+#include <vector>
+
+class EgammaElectronTkMultiIsolationProducer : public edm::stream::EDProducer<> {
+ public:
+  explicit EgammaElectronTkMultiIsolationProducer(const edm::ParameterSet&);
+  ~EgammaElectronTkMultiIsolationProducer();
+
+  virtual void produce(edm::Event&, const edm::EventSetup&);
+
+ private:
+  struct Cone {
+    std::string label;
+    double extRadius;
+    double intRadiusBarrel;
+    double intRadiusEndcap;
+    double stripBarrel;
+    double stripEndcap;
+  };
+
+  struct SelectedTrack {
+    double eta;
+    const reco::Track * track;
+    bool operator<(const SelectedTrack & other) const { return eta < other.eta; }
+  };
+
+  bool passAlgo(const reco::TrackBase & track) const;
+
+  edm::EDGetTokenT< reco::GsfElectronCollection> electronProducer_;
+  edm::EDGetTokenT<reco::TrackCollection> trackProducer_;
+  edm::EDGetTokenT<reco::BeamSpot> beamspotProducer_;
+
+  double ptMin_;
+  double maxVtxDist_;
+  double drb_;
+  std::vector<Cone> cones_;
+  double maxExtRadius_;
+  std::vector<int> algosToReject_;
+
+  // per-event buffers
+  std::vector<SelectedTrack> tracks_;
+  std::vector<double> ptSums_;
+
+};
+
+
+#endif